@@ -0,0 +1,172 @@
+#include "arvore-rn-arquivo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// identificação do arquivo: "ARVRN" seguido da versão do formato
+#define ARV_ARQ_VERSAO 1
+static const char arv_arq_magica[8] = { 'A', 'R', 'V', 'R', 'N', 0, 0, ARV_ARQ_VERSAO };
+
+#define ARV_ARQ_CABECALHO (sizeof(arv_arq_magica) + sizeof(uint64_t))
+#define ARV_ARQ_BUFFER_INICIAL 256
+
+
+//// --- salvamento ---
+
+// função auxiliar que escreve os registros de todos os dados da árvore
+// em `arquivo`, reaproveitando um único buffer para a serialização
+static bool arv_arq_escreve_registros(Arvore *arv, FILE *arquivo, Serializador *serializa) {
+    size_t capacidade = ARV_ARQ_BUFFER_INICIAL;
+    void *buffer = malloc(capacidade);
+    if(buffer == NULL) return false;
+
+    bool ok = true;
+    for(No *no = arv_iter_inicio(arv); no != NULL && ok; no = arv_iter_proximo(no)) {
+        void *dado = arv_busca_valor(no);
+
+        size_t tam = serializa(dado, buffer, capacidade);
+        if(tam > capacidade) {
+            // o dado não coube: aumenta o buffer e serializa de novo
+            void *novo = realloc(buffer, tam);
+            if(novo == NULL) {
+                ok = false;
+                break;
+            }
+            buffer = novo;
+            capacidade = tam;
+            tam = serializa(dado, buffer, capacidade);
+        }
+
+        if(tam > UINT32_MAX || tam > capacidade) {
+            ok = false;
+            break;
+        }
+
+        uint32_t tam_reg = (uint32_t)tam;
+        ok = fwrite(&tam_reg, sizeof(tam_reg), 1, arquivo) == 1 &&
+             fwrite(buffer, 1, tam, arquivo) == tam;
+    }
+
+    free(buffer);
+    return ok;
+}
+
+bool arv_salva(Arvore *arv, const char *caminho, Serializador *serializa) {
+    if(arv == NULL || caminho == NULL || serializa == NULL) return false;
+
+    // escreve em "<caminho>.tmp" e só troca pelo arquivo final no fim
+    size_t tam_caminho = strlen(caminho);
+    char *temporario = (char*)malloc(tam_caminho + sizeof(".tmp"));
+    if(temporario == NULL) return false;
+    memcpy(temporario, caminho, tam_caminho);
+    memcpy(temporario + tam_caminho, ".tmp", sizeof(".tmp"));
+
+    FILE *arquivo = fopen(temporario, "wb");
+    if(arquivo == NULL) {
+        free(temporario);
+        return false;
+    }
+
+    uint64_t num_registros = arv_nnos(arv);
+    bool ok = fwrite(arv_arq_magica, sizeof(arv_arq_magica), 1, arquivo) == 1 &&
+              fwrite(&num_registros, sizeof(num_registros), 1, arquivo) == 1 &&
+              arv_arq_escreve_registros(arv, arquivo, serializa);
+
+    // garante que o conteúdo chegou no disco antes de substituir o antigo
+    ok = fflush(arquivo) == 0 && ok;
+    ok = ok && fsync(fileno(arquivo)) == 0;
+    ok = fclose(arquivo) == 0 && ok;
+    ok = ok && rename(temporario, caminho) == 0;
+
+    if(!ok) remove(temporario);
+    free(temporario);
+    return ok;
+}
+
+
+
+//// --- carregamento ---
+
+// função auxiliar que libera os `n` primeiros dados de `dados` com
+// `libera`, ou com o liberador da árvore se `libera` for NULL
+static void arv_arq_libera_dados(Arvore *arv, void **dados, size_t n, Liberador *libera) {
+    if(libera == NULL) libera = arv_liberador(arv);
+    if(libera == NULL) return;
+
+    for(size_t i = 0; i < n; i++) libera(dados[i]);
+}
+
+// função auxiliar que converte os registros de `conteudo` (o arquivo
+// inteiro, com `tam` bytes) nos `n` dados de `dados`, guardando em
+// `*lidos` quantos foram convertidos.
+// retorna false se o arquivo estiver corrompido ou `desserializa` falhar
+static bool arv_arq_le_registros(const unsigned char *conteudo, size_t tam, void **dados, size_t n,
+                                 Desserializador *desserializa, size_t *lidos) {
+    size_t pos = ARV_ARQ_CABECALHO;
+
+    for(*lidos = 0; *lidos < n; (*lidos)++) {
+        uint32_t tam_reg;
+        if(tam - pos < sizeof(tam_reg)) return false;
+        // os registros não ficam alinhados no arquivo
+        memcpy(&tam_reg, conteudo + pos, sizeof(tam_reg));
+        pos += sizeof(tam_reg);
+
+        if(tam - pos < tam_reg) return false;
+        dados[*lidos] = desserializa(conteudo + pos, tam_reg);
+        if(dados[*lidos] == NULL) return false;
+        pos += tam_reg;
+    }
+
+    // sobras depois do último registro também indicam um arquivo corrompido
+    return pos == tam;
+}
+
+bool arv_carrega(Arvore *arv, const char *caminho, Desserializador *desserializa, Liberador *libera) {
+    if(arv == NULL || caminho == NULL || desserializa == NULL) return false;
+    if(!arv_vazia(arv)) return false;
+
+    int fd = open(caminho, O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (uint64_t)info.st_size < ARV_ARQ_CABECALHO) {
+        close(fd);
+        return false;
+    }
+    size_t tam = (size_t)info.st_size;
+
+    const unsigned char *conteudo = (const unsigned char*)mmap(NULL, tam, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(conteudo == MAP_FAILED) return false;
+    // o arquivo é lido uma única vez, do início ao fim
+    madvise((void*)conteudo, tam, MADV_SEQUENTIAL);
+
+    bool ok = false;
+    uint64_t num_registros;
+    memcpy(&num_registros, conteudo + sizeof(arv_arq_magica), sizeof(num_registros));
+
+    // cada registro ocupa pelo menos o seu tamanho, o que também limita a
+    // alocação abaixo em arquivos corrompidos
+    if(memcmp(conteudo, arv_arq_magica, sizeof(arv_arq_magica)) == 0 &&
+       num_registros <= (tam - ARV_ARQ_CABECALHO) / sizeof(uint32_t)) {
+        size_t n = (size_t)num_registros;
+        void **dados = (void**)malloc((n > 0 ? n : 1) * sizeof(void*));
+
+        if(dados != NULL) {
+            size_t lidos;
+            ok = arv_arq_le_registros(conteudo, tam, dados, n, desserializa, &lidos) &&
+                 arv_constroi_ordenado(arv, dados, n);
+            // se falhou, a árvore continua vazia e os dados não são dela
+            if(!ok) arv_arq_libera_dados(arv, dados, lidos, libera);
+            free(dados);
+        }
+    }
+
+    munmap((void*)conteudo, tam);
+    return ok;
+}
@@ -0,0 +1,65 @@
+#ifndef _ARVORE_RN_ARQUIVO_
+#define _ARVORE_RN_ARQUIVO_
+
+// Árvore Rubro-Negra em Arquivo
+//
+// funções para salvar os dados de uma árvore rubro-negra (arvore-rn.h)
+// em um arquivo binário e carregá-los de volta.
+//
+// o arquivo guarda os dados em ordem, cada um convertido em bytes por uma
+// função do usuário, então carregar não precisa inserir dado a dado: o
+// arquivo é mapeado na memória (mmap), cada registro é convertido de volta
+// em dado, e a árvore é montada de uma vez por arv_constroi_ordenado, em
+// tempo linear.
+//
+// formato do arquivo (inteiros na ordem de bytes da máquina que salvou):
+//   - cabeçalho: 8 bytes de identificação ("ARVRN" e a versão do
+//     formato) e o número de registros, em 8 bytes
+//   - cada registro: o tamanho do dado serializado, em 4 bytes, seguido
+//     dos bytes do dado
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "arvore-rn.h"
+
+//// --- tipos exportados ---
+
+// a função recebe um dado e um buffer de `tam` bytes, e retorna quantos
+// bytes o dado ocupa serializado. se couber no buffer, o dado é escrito
+// nele, senão nada é escrito e a função é chamada de novo com um buffer
+// do tamanho retornado.
+typedef size_t Serializador(void *dado, void *buffer, size_t tam);
+
+// a função recebe os `tam` bytes de um dado serializado e retorna um novo
+// dado alocado com eles (que passa a ser da árvore, ou é liberado por
+// arv_carrega se a carga falhar), ou NULL em caso de falha. o buffer só é
+// válido durante a chamada.
+typedef void* Desserializador(const void *buffer, size_t tam);
+
+
+
+//// --- arquivo ---
+
+// salva os dados da árvore `arv` no arquivo `caminho`, em ordem, usando
+// `serializa`. o arquivo é escrito com outro nome e só substitui `caminho`
+// depois de completo, então uma falha no meio não estraga um arquivo
+// salvo anteriormente.
+// retorna true se for bem sucedido ou false caso não.
+bool arv_salva(Arvore *arv, const char *caminho, Serializador *serializa);
+
+// carrega na árvore vazia `arv` os dados salvos no arquivo `caminho` por
+// arv_salva, usando `desserializa`. a árvore é construída como em
+// arv_constroi_ordenado, em tempo linear, sem nenhuma inserção.
+// retorna false se a árvore não estiver vazia, se o arquivo não existir
+// ou estiver corrompido, se os dados não estiverem ordenados pelo
+// comparador da árvore ou em caso de falha de alocação. nesses casos a
+// árvore continua vazia, e os dados já convertidos são liberados com
+// `libera`, ou com o liberador da árvore se `libera` for NULL. se os dois
+// forem NULL, os dados convertidos não são liberados (só use isso se
+// `desserializa` não alocar os dados que retorna).
+bool arv_carrega(Arvore *arv, const char *caminho, Desserializador *desserializa, Liberador *libera);
+
+
+
+#endif
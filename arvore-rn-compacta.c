@@ -0,0 +1,417 @@
+#include "arvore-rn-compacta.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+// índice que representa os nós NIL (a posição 0 do vetor não é usada)
+#define ARV_COMP_NIL 0u
+
+// bit do índice do filho direito que guarda a cor (ligado = vermelho)
+#define ARV_COMP_BIT_COR 0x80000000u
+#define ARV_COMP_MAX_NOS 0x7fffffffu
+
+// tamanho da pilha de caminho. a altura de uma árvore rubro-negra com n
+// nós é no máximo 2 log2(n + 1), ou seja 62 com 2^31 - 1 nós, mais uma
+// posição que a correção da remoção pode acrescentar ao caminho
+#define ARV_COMP_MAX_CAMINHO 64
+
+#define ARV_COMP_CAPACIDADE_INICIAL 64
+
+// lados de um filho, usados como índice de `filhos`
+#define ESQ 0
+#define DIR 1
+
+// estrutura de um nó compacto
+typedef struct {
+    void *dado;
+    // índices dos filhos esquerdo e direito no vetor de nós. o bit
+    // ARV_COMP_BIT_COR de filhos[DIR] é a cor do nó.
+    // nos nós livres, filhos[ESQ] é o próximo nó livre
+    uint32_t filhos[2];
+} NoCompacto;
+
+// estrutura de uma árvore compacta
+struct arvore_compacta {
+    NoCompacto *nos;
+    // posições alocadas de `nos`, e quantas já foram usadas alguma vez
+    uint32_t capacidade;
+    uint32_t usados;
+    // lista de nós removidos que podem ser reaproveitados
+    uint32_t livres;
+
+    uint32_t raiz;
+    size_t num_nos;
+    Comparador *comp;
+    Liberador *libera;
+};
+
+
+//// --- acesso aos nós ---
+
+static inline uint32_t arv_comp_filho(ArvoreCompacta *arvc, uint32_t no, int lado) {
+    return arvc->nos[no].filhos[lado] & ~ARV_COMP_BIT_COR;
+}
+
+// troca o filho do lado `lado` de `no` por `filho`, mantendo a cor de `no`
+static inline void arv_comp_define_filho(ArvoreCompacta *arvc, uint32_t no, int lado, uint32_t filho) {
+    uint32_t *campo = &arvc->nos[no].filhos[lado];
+    *campo = (*campo & ARV_COMP_BIT_COR) | filho;
+}
+
+// todo nó NIL é preto
+static inline Cor arv_comp_cor(ArvoreCompacta *arvc, uint32_t no) {
+    if(no == ARV_COMP_NIL) return PRETO;
+    return (arvc->nos[no].filhos[DIR] & ARV_COMP_BIT_COR) ? VERMELHO : PRETO;
+}
+
+static inline void arv_comp_pinta(ArvoreCompacta *arvc, uint32_t no, Cor cor) {
+    if(cor == VERMELHO) {
+        arvc->nos[no].filhos[DIR] |= ARV_COMP_BIT_COR;
+    }
+    else {
+        arvc->nos[no].filhos[DIR] &= ~ARV_COMP_BIT_COR;
+    }
+}
+
+// função auxiliar que rotaciona a sub-árvore com raiz `no`, cujo pai é
+// `pai` (NIL se `no` é a raiz): o filho do lado oposto a `lado` sobe, e
+// `no` passa a ser o filho do lado `lado` dele. com `lado` = ESQ é a
+// rotação a esquerda, e com `lado` = DIR a rotação a direita
+static void arv_comp_rotaciona(ArvoreCompacta *arvc, uint32_t no, uint32_t pai, int lado) {
+    uint32_t sobe = arv_comp_filho(arvc, no, !lado);
+
+    arv_comp_define_filho(arvc, no, !lado, arv_comp_filho(arvc, sobe, lado));
+    arv_comp_define_filho(arvc, sobe, lado, no);
+
+    if(pai == ARV_COMP_NIL) {
+        arvc->raiz = sobe;
+    }
+    else {
+        arv_comp_define_filho(arvc, pai, arv_comp_filho(arvc, pai, ESQ) == no ? ESQ : DIR, sobe);
+    }
+}
+
+
+
+//// --- criação / destruição ---
+
+ArvoreCompacta* arv_comp_cria(Comparador *comp, Liberador *libera) {
+    if(comp == NULL) return NULL;
+
+    ArvoreCompacta *arvc = (ArvoreCompacta*)malloc(sizeof(ArvoreCompacta));
+    if(arvc == NULL) return NULL;
+
+    // o vetor só é alocado na primeira inserção
+    arvc->nos = NULL;
+    arvc->capacidade = 0;
+    // a posição 0 é o NIL
+    arvc->usados = 1;
+    arvc->livres = ARV_COMP_NIL;
+
+    arvc->raiz = ARV_COMP_NIL;
+    arvc->num_nos = 0;
+    arvc->comp = comp;
+    arvc->libera = libera;
+
+    return arvc;
+}
+
+void arv_comp_libera(ArvoreCompacta *arvc) {
+    if(arvc == NULL) return;
+
+    // libera os dados percorrendo a árvore com uma pilha, já que os nós
+    // livres do vetor não são marcados
+    if(arvc->libera != NULL && arvc->raiz != ARV_COMP_NIL) {
+        uint32_t pilha[ARV_COMP_MAX_CAMINHO + 1];
+        int topo = 0;
+        pilha[topo++] = arvc->raiz;
+        while(topo > 0) {
+            uint32_t no = pilha[--topo];
+            arvc->libera(arvc->nos[no].dado);
+
+            // empilhar os dois filhos de um nó ocupa uma posição a mais que
+            // ele, então a pilha nunca passa da altura da árvore mais um
+            for(int lado = ESQ; lado <= DIR; lado++) {
+                uint32_t filho = arv_comp_filho(arvc, no, lado);
+                if(filho != ARV_COMP_NIL) pilha[topo++] = filho;
+            }
+        }
+    }
+
+    free(arvc->nos);
+    free(arvc);
+}
+
+
+
+//// --- inserção/remoção ---
+
+// função auxiliar que entrega a posição de um nó livre, crescendo o vetor
+// se precisar, ou NIL em caso de falha de alocação ou se a árvore está cheia
+static uint32_t arv_comp_aloca(ArvoreCompacta *arvc) {
+    if(arvc->livres != ARV_COMP_NIL) {
+        uint32_t no = arvc->livres;
+        arvc->livres = arvc->nos[no].filhos[ESQ];
+        return no;
+    }
+
+    if(arvc->usados >= arvc->capacidade) {
+        if(arvc->capacidade > ARV_COMP_MAX_NOS) return ARV_COMP_NIL;
+
+        uint64_t nova_capacidade = arvc->capacidade == 0 ? ARV_COMP_CAPACIDADE_INICIAL : 2 * (uint64_t)arvc->capacidade;
+        if(nova_capacidade > (uint64_t)ARV_COMP_MAX_NOS + 1) nova_capacidade = (uint64_t)ARV_COMP_MAX_NOS + 1;
+
+        NoCompacto *nos = (NoCompacto*)realloc(arvc->nos, nova_capacidade * sizeof(NoCompacto));
+        if(nos == NULL) return ARV_COMP_NIL;
+        arvc->nos = nos;
+        arvc->capacidade = (uint32_t)nova_capacidade;
+    }
+
+    return arvc->usados++;
+}
+
+bool arv_comp_insere_no(ArvoreCompacta *arvc, void *v) {
+    if(arvc == NULL || v == NULL) return false;
+
+    // caminho da raiz até o novo nó
+    uint32_t caminho[ARV_COMP_MAX_CAMINHO];
+    int prof = 0;
+
+    uint32_t atual = arvc->raiz;
+    int lado = ESQ;
+    while(atual != ARV_COMP_NIL) {
+        caminho[prof++] = atual;
+        lado = arvc->comp(v, arvc->nos[atual].dado) < 0 ? ESQ : DIR;
+        atual = arv_comp_filho(arvc, atual, lado);
+    }
+
+    // a alocação pode mover o vetor, então só pega o nó depois da descida
+    uint32_t novo_no = arv_comp_aloca(arvc);
+    if(novo_no == ARV_COMP_NIL) return false;
+
+    // todo nó a ser inserido é pintado de vermelho
+    arvc->nos[novo_no].dado = v;
+    arvc->nos[novo_no].filhos[ESQ] = ARV_COMP_NIL;
+    arvc->nos[novo_no].filhos[DIR] = ARV_COMP_NIL | ARV_COMP_BIT_COR;
+
+    if(prof == 0) {
+        arvc->raiz = novo_no;
+    }
+    else {
+        arv_comp_define_filho(arvc, caminho[prof - 1], lado, novo_no);
+    }
+    caminho[prof] = novo_no;
+
+    // mesmos casos de arv_insere_fixup, com os lados espelhados pela
+    // variável `lado_pai` ao invés de duplicados. `i` é a profundidade do
+    // nó que pode ter quebrado a propriedade 4
+    int i = prof;
+    while(i >= 2 && arv_comp_cor(arvc, caminho[i - 1]) == VERMELHO) {
+        uint32_t pai = caminho[i - 1];
+        uint32_t avo = caminho[i - 2];
+        int lado_pai = arv_comp_filho(arvc, avo, DIR) == pai ? DIR : ESQ;
+        uint32_t tio = arv_comp_filho(arvc, avo, !lado_pai);
+
+        // caso 3: pai e tio vermelhos, repinta e continua pelo avô
+        if(arv_comp_cor(arvc, tio) == VERMELHO) {
+            arv_comp_pinta(arvc, pai, PRETO);
+            arv_comp_pinta(arvc, tio, PRETO);
+            arv_comp_pinta(arvc, avo, VERMELHO);
+            i -= 2;
+            continue;
+        }
+
+        // caso 4: o nó está do lado oposto do pai em relação ao avô,
+        // rotaciona o pai para o nó ficar do mesmo lado
+        if(caminho[i] == arv_comp_filho(arvc, pai, !lado_pai)) {
+            arv_comp_rotaciona(arvc, pai, avo, lado_pai);
+            pai = caminho[i];
+        }
+
+        // caso 5: rotaciona o avô e troca as cores do pai e do avô
+        arv_comp_pinta(arvc, pai, PRETO);
+        arv_comp_pinta(arvc, avo, VERMELHO);
+        arv_comp_rotaciona(arvc, avo, i >= 3 ? caminho[i - 3] : ARV_COMP_NIL, !lado_pai);
+        break;
+    }
+
+    arv_comp_pinta(arvc, arvc->raiz, PRETO);
+    arvc->num_nos++;
+    return true;
+}
+
+// função auxiliar que corrige a árvore depois de um nó preto ter sido
+// desligado. `caminho[0..prof]` vai da raiz até o nó `x` que ocupou a
+// posição dele (que pode ser NIL), e `lados[i]` é o lado de `caminho[i]`
+// em relação a `caminho[i - 1]`. mesmos casos de arv_remove_fixup
+static void arv_comp_remove_fixup(ArvoreCompacta *arvc, uint32_t *caminho, int *lados, int prof) {
+    uint32_t x = caminho[prof];
+
+    while(prof > 0 && arv_comp_cor(arvc, x) == PRETO) {
+        int lado = lados[prof];
+        uint32_t pai = caminho[prof - 1];
+        uint32_t avo = prof >= 2 ? caminho[prof - 2] : ARV_COMP_NIL;
+        uint32_t irmao = arv_comp_filho(arvc, pai, !lado);
+
+        // caso 1: irmão vermelho, rotaciona o pai para o irmão ficar preto.
+        // o antigo irmão entra no caminho entre o avô e o pai
+        if(arv_comp_cor(arvc, irmao) == VERMELHO) {
+            arv_comp_pinta(arvc, irmao, PRETO);
+            arv_comp_pinta(arvc, pai, VERMELHO);
+            arv_comp_rotaciona(arvc, pai, avo, lado);
+
+            caminho[prof - 1] = irmao;
+            caminho[prof] = pai;
+            lados[prof] = lado;
+            prof++;
+            caminho[prof] = x;
+            lados[prof] = lado;
+
+            avo = irmao;
+            irmao = arv_comp_filho(arvc, pai, !lado);
+        }
+
+        // caso 2: irmão preto com os dois filhos pretos, o "preto extra" sobe
+        if(arv_comp_cor(arvc, arv_comp_filho(arvc, irmao, ESQ)) == PRETO &&
+           arv_comp_cor(arvc, arv_comp_filho(arvc, irmao, DIR)) == PRETO) {
+            arv_comp_pinta(arvc, irmao, VERMELHO);
+            x = pai;
+            prof--;
+            continue;
+        }
+
+        // caso 3: só o filho do irmão do mesmo lado de `x` é vermelho,
+        // rotaciona o irmão para cair no caso 4
+        if(arv_comp_cor(arvc, arv_comp_filho(arvc, irmao, !lado)) == PRETO) {
+            arv_comp_pinta(arvc, arv_comp_filho(arvc, irmao, lado), PRETO);
+            arv_comp_pinta(arvc, irmao, VERMELHO);
+            arv_comp_rotaciona(arvc, irmao, pai, !lado);
+            irmao = arv_comp_filho(arvc, pai, !lado);
+        }
+
+        // caso 4: o filho do irmão do lado oposto a `x` é vermelho,
+        // rotaciona o pai e resolve o "preto extra"
+        arv_comp_pinta(arvc, irmao, arv_comp_cor(arvc, pai));
+        arv_comp_pinta(arvc, pai, PRETO);
+        arv_comp_pinta(arvc, arv_comp_filho(arvc, irmao, !lado), PRETO);
+        arv_comp_rotaciona(arvc, pai, avo, lado);
+        x = arvc->raiz;
+        break;
+    }
+
+    if(x != ARV_COMP_NIL) arv_comp_pinta(arvc, x, PRETO);
+}
+
+bool arv_comp_remove_no(ArvoreCompacta *arvc, void *v) {
+    if(arvc == NULL) return false;
+
+    uint32_t caminho[ARV_COMP_MAX_CAMINHO + 1];
+    int lados[ARV_COMP_MAX_CAMINHO + 1];
+    int prof = 0;
+    lados[0] = ESQ;
+
+    // busca o nó a remover, guardando o caminho
+    uint32_t atual = arvc->raiz;
+    while(atual != ARV_COMP_NIL) {
+        caminho[prof] = atual;
+        int resultado_comp = arvc->comp(v, arvc->nos[atual].dado);
+        if(resultado_comp == 0) break;
+
+        int lado = resultado_comp < 0 ? ESQ : DIR;
+        atual = arv_comp_filho(arvc, atual, lado);
+        lados[++prof] = lado;
+    }
+    if(atual == ARV_COMP_NIL) return false;
+
+    // com 2 filhos, o dado do sucessor passa para o nó e o sucessor é que
+    // sai da árvore. como os nós não são expostos, trocar os dados não
+    // invalida nada
+    uint32_t no = atual;
+    if(arv_comp_filho(arvc, no, ESQ) != ARV_COMP_NIL && arv_comp_filho(arvc, no, DIR) != ARV_COMP_NIL) {
+        uint32_t sucessor = arv_comp_filho(arvc, no, DIR);
+        caminho[++prof] = sucessor;
+        lados[prof] = DIR;
+        while(arv_comp_filho(arvc, sucessor, ESQ) != ARV_COMP_NIL) {
+            sucessor = arv_comp_filho(arvc, sucessor, ESQ);
+            caminho[++prof] = sucessor;
+            lados[prof] = ESQ;
+        }
+
+        void *dado = arvc->nos[no].dado;
+        arvc->nos[no].dado = arvc->nos[sucessor].dado;
+        arvc->nos[sucessor].dado = dado;
+        no = sucessor;
+    }
+
+    // `no` tem no máximo um filho, que ocupa o lugar dele
+    uint32_t filho = arv_comp_filho(arvc, no, ESQ);
+    if(filho == ARV_COMP_NIL) filho = arv_comp_filho(arvc, no, DIR);
+
+    if(prof == 0) {
+        arvc->raiz = filho;
+    }
+    else {
+        arv_comp_define_filho(arvc, caminho[prof - 1], lados[prof], filho);
+    }
+    caminho[prof] = filho;
+
+    // se o nó desligado era preto, a altura-preta do caminho diminuiu
+    if(arv_comp_cor(arvc, no) == PRETO) {
+        arv_comp_remove_fixup(arvc, caminho, lados, prof);
+    }
+
+    if(arvc->libera != NULL) arvc->libera(arvc->nos[no].dado);
+    arvc->nos[no].filhos[ESQ] = arvc->livres;
+    arvc->livres = no;
+    arvc->num_nos--;
+    return true;
+}
+
+
+
+//// --- consultas ---
+
+size_t arv_comp_nnos(ArvoreCompacta *arvc) {
+    if(arvc == NULL) return 0;
+    return arvc->num_nos;
+}
+
+void* arv_comp_busca(ArvoreCompacta *arvc, void *v) {
+    if(arvc == NULL) return NULL;
+
+    uint32_t atual = arvc->raiz;
+    while(atual != ARV_COMP_NIL) {
+        int resultado_comp = arvc->comp(v, arvc->nos[atual].dado);
+
+        if(resultado_comp == 0) {
+            return arvc->nos[atual].dado;
+        }
+        atual = arv_comp_filho(arvc, atual, resultado_comp < 0 ? ESQ : DIR);
+    }
+
+    return NULL;
+}
+
+bool arv_comp_contem(ArvoreCompacta *arvc, void *v) {
+    return arv_comp_busca(arvc, v) != NULL;
+}
+
+void arv_comp_percorre(ArvoreCompacta *arvc, Visitante *visita, void *contexto) {
+    if(arvc == NULL || visita == NULL) return;
+
+    // percurso em ordem com uma pilha dos ancestrais cujo dado ainda
+    // não foi visitado
+    uint32_t pilha[ARV_COMP_MAX_CAMINHO];
+    int topo = 0;
+    uint32_t atual = arvc->raiz;
+
+    while(atual != ARV_COMP_NIL || topo > 0) {
+        while(atual != ARV_COMP_NIL) {
+            pilha[topo++] = atual;
+            atual = arv_comp_filho(arvc, atual, ESQ);
+        }
+
+        atual = pilha[--topo];
+        visita(arvc->nos[atual].dado, contexto);
+        atual = arv_comp_filho(arvc, atual, DIR);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef _ARVORE_RN_COMPACTA_
+#define _ARVORE_RN_COMPACTA_
+
+// Árvore Rubro-Negra Compacta
+//
+// TAD que implementa uma árvore rubro-negra genérica, como a de
+// arvore-rn.h, com nós de 16 bytes ao invés dos nós da árvore comum.
+//
+// os nós ficam todos em um único vetor, e se referenciam pela posição
+// nele com inteiros de 32 bits ao invés de ponteiros. o nó não guarda o
+// pai (as operações guardam o caminho desde a raiz em uma pilha) e a
+// cor ocupa o bit mais alto do índice do filho direito, então cada nó
+// tem só o ponteiro para o dado e os dois índices dos filhos.
+// com nós menores, cabem mais nós nas caches.
+//
+// como os nós mudam de endereço quando o vetor cresce, a árvore compacta
+// não expõe os nós: as consultas retornam os próprios dados.
+// a árvore comporta até 2^31 - 1 nós.
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "arvore-rn.h"
+
+//// --- tipos exportados ---
+typedef struct arvore_compacta ArvoreCompacta;
+
+
+
+//// --- criação / destruição ---
+
+// cria e retorna uma árvore compacta vazia, com as mesmas regras de
+// `comp` e `libera` de arv_cria.
+// retorna NULL em caso de falha de alocação.
+ArvoreCompacta* arv_comp_cria(Comparador *comp, Liberador *libera);
+
+// libera toda a árvore. se a árvore possuir uma função de liberação,
+// libera toda a memória ocupada pelos dados também.
+void arv_comp_libera(ArvoreCompacta *arvc);
+
+
+
+//// --- inserção/remoção ---
+
+// insere o valor apontado por `v`.
+// retorna true se for bem sucedido ou false caso não (falha de alocação
+// ou a árvore já tem o número máximo de nós).
+bool arv_comp_insere_no(ArvoreCompacta *arvc, void *v);
+
+// remove o nó com o valor apontado por `v`, liberando o dado se a árvore
+// possuir uma função de liberação.
+// retorna true se for bem sucedido ou false caso não.
+bool arv_comp_remove_no(ArvoreCompacta *arvc, void *v);
+
+
+
+//// --- consultas ---
+
+// retorna o número de nós da árvore.
+size_t arv_comp_nnos(ArvoreCompacta *arvc);
+
+// retorna o dado igual a `v`, ou NULL se não houver.
+void* arv_comp_busca(ArvoreCompacta *arvc, void *v);
+
+// retorna true se a árvore conter o valor `v` ou false senão conter.
+bool arv_comp_contem(ArvoreCompacta *arvc, void *v);
+
+// chama `visita` com cada dado da árvore, em ordem, e `contexto`.
+// a árvore não deve ser alterada durante o percurso.
+void arv_comp_percorre(ArvoreCompacta *arvc, Visitante *visita, void *contexto);
+
+
+
+#endif
@@ -0,0 +1,192 @@
+#include "arvore-rn-concorrente.h"
+#include <stdlib.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+// número de contadores de leitores de cada árvore. cada thread usa sempre
+// o mesmo contador, então threads leitoras diferentes (até esse número)
+// nunca escrevem na mesma linha de cache
+#define ARV_CONC_FATIAS 64
+#define ARV_CONC_LINHA_CACHE 64
+
+// contador de leitores ativos de uma fatia, ocupando uma linha de cache inteira
+typedef struct {
+    alignas(ARV_CONC_LINHA_CACHE) atomic_int leitores;
+} FatiaLeitura;
+
+// estrutura de uma árvore concorrente
+struct arvore_concorrente {
+    // leitores ativos, distribuídos por fatia
+    FatiaLeitura fatias[ARV_CONC_FATIAS];
+
+    // só um escritor por vez, e enquanto `escrevendo` for true
+    // nenhum leitor novo entra
+    pthread_mutex_t trava_escrita;
+    alignas(ARV_CONC_LINHA_CACHE) atomic_bool escrevendo;
+
+    Arvore *arv;
+};
+
+// próxima fatia a ser entregue para uma thread que ainda não tem fatia
+static atomic_uint proxima_fatia;
+
+// função auxiliar que retorna a fatia da thread atual
+static unsigned arv_conc_fatia() {
+    static _Thread_local unsigned fatia = 0;
+    static _Thread_local bool tem_fatia = false;
+
+    if(!tem_fatia) {
+        fatia = atomic_fetch_add(&proxima_fatia, 1) % ARV_CONC_FATIAS;
+        tem_fatia = true;
+    }
+    return fatia;
+}
+
+
+//// --- travas ---
+
+// função auxiliar que entra na árvore como leitor e retorna a fatia usada.
+// o leitor se anuncia na sua fatia e depois confere se tem algum escritor,
+// se tiver, desiste e espera o escritor terminar. o escritor faz o contrário
+// (se anuncia e depois espera as fatias zerarem), e como as duas operações são
+// sequencialmente consistentes, pelo menos um dos dois vê o outro
+static FatiaLeitura* arv_conc_trava_leitura(ArvoreConcorrente *arvc) {
+    FatiaLeitura *fatia = &arvc->fatias[arv_conc_fatia()];
+
+    while(true) {
+        atomic_fetch_add(&fatia->leitores, 1);
+        if(!atomic_load(&arvc->escrevendo)) return fatia;
+
+        atomic_fetch_sub(&fatia->leitores, 1);
+        while(atomic_load_explicit(&arvc->escrevendo, memory_order_relaxed)) {
+            sched_yield();
+        }
+    }
+}
+
+static void arv_conc_destrava_leitura(FatiaLeitura *fatia) {
+    atomic_fetch_sub_explicit(&fatia->leitores, 1, memory_order_release);
+}
+
+// função auxiliar que entra na árvore como escritor, esperando todos os
+// leitores que já tinham entrado saírem
+static void arv_conc_trava_escrita(ArvoreConcorrente *arvc) {
+    pthread_mutex_lock(&arvc->trava_escrita);
+    atomic_store(&arvc->escrevendo, true);
+
+    for(int i = 0; i < ARV_CONC_FATIAS; i++) {
+        while(atomic_load(&arvc->fatias[i].leitores) != 0) {
+            sched_yield();
+        }
+    }
+}
+
+static void arv_conc_destrava_escrita(ArvoreConcorrente *arvc) {
+    atomic_store_explicit(&arvc->escrevendo, false, memory_order_release);
+    pthread_mutex_unlock(&arvc->trava_escrita);
+}
+
+
+
+//// --- criação / destruição ---
+
+ArvoreConcorrente* arv_conc_cria(Arvore *arv) {
+    if(arv == NULL) return NULL;
+
+    // as fatias precisam estar alinhadas à linha de cache
+    size_t tamanho = sizeof(ArvoreConcorrente);
+    tamanho += (ARV_CONC_LINHA_CACHE - tamanho % ARV_CONC_LINHA_CACHE) % ARV_CONC_LINHA_CACHE;
+    ArvoreConcorrente *nova = (ArvoreConcorrente*)aligned_alloc(ARV_CONC_LINHA_CACHE, tamanho);
+    if(nova == NULL) return NULL;
+
+    if(pthread_mutex_init(&nova->trava_escrita, NULL) != 0) {
+        free(nova);
+        return NULL;
+    }
+    for(int i = 0; i < ARV_CONC_FATIAS; i++) {
+        atomic_init(&nova->fatias[i].leitores, 0);
+    }
+    atomic_init(&nova->escrevendo, false);
+    nova->arv = arv;
+
+    return nova;
+}
+
+void arv_conc_libera(ArvoreConcorrente *arvc) {
+    if(arvc == NULL) return;
+
+    arv_libera_arvore(arvc->arv);
+    pthread_mutex_destroy(&arvc->trava_escrita);
+    free(arvc);
+}
+
+
+
+//// --- inserção/remoção ---
+
+bool arv_conc_insere_no(ArvoreConcorrente *arvc, void *v) {
+    if(arvc == NULL) return false;
+
+    arv_conc_trava_escrita(arvc);
+    bool inseriu = arv_insere_no(arvc->arv, v);
+    arv_conc_destrava_escrita(arvc);
+
+    return inseriu;
+}
+
+bool arv_conc_remove_no(ArvoreConcorrente *arvc, void *v) {
+    if(arvc == NULL) return false;
+
+    arv_conc_trava_escrita(arvc);
+    bool removeu = arv_remove_no(arvc->arv, v);
+    arv_conc_destrava_escrita(arvc);
+
+    return removeu;
+}
+
+
+
+//// --- consultas ---
+
+// as consultas da árvore não escrevem nos nós (nem mesmo nos NIL, que são
+// NULL), então podem rodar em paralelo com a trava de leitura.
+// a exceção é a biblioteca compilada com ARV_ESTATISTICAS: as consultas
+// contam comparações e latências nos contadores da árvore, e leitores
+// simultâneos que caem na mesma fatia de contadores (ver arv_estatisticas)
+// somam sem sincronização, então parte dessas contagens pode se perder.
+
+bool arv_conc_contem(ArvoreConcorrente *arvc, void *v) {
+    if(arvc == NULL) return false;
+
+    FatiaLeitura *fatia = arv_conc_trava_leitura(arvc);
+    bool contem = arv_contem(arvc->arv, v);
+    arv_conc_destrava_leitura(fatia);
+
+    return contem;
+}
+
+bool arv_conc_busca(ArvoreConcorrente *arvc, void *v, Visitante *visita, void *contexto) {
+    if(arvc == NULL) return false;
+
+    FatiaLeitura *fatia = arv_conc_trava_leitura(arvc);
+    No *no = arv_busca(arvc->arv, v);
+    bool achou = !arv_no_vazio(no);
+    if(achou && visita != NULL) {
+        visita(arv_busca_valor(no), contexto);
+    }
+    arv_conc_destrava_leitura(fatia);
+
+    return achou;
+}
+
+size_t arv_conc_nnos(ArvoreConcorrente *arvc) {
+    if(arvc == NULL) return 0;
+
+    FatiaLeitura *fatia = arv_conc_trava_leitura(arvc);
+    size_t nnos = arv_nnos(arvc->arv);
+    arv_conc_destrava_leitura(fatia);
+
+    return nnos;
+}
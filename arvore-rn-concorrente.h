@@ -0,0 +1,81 @@
+#ifndef _ARVORE_RN_CONCORRENTE_
+#define _ARVORE_RN_CONCORRENTE_
+
+// Árvore Rubro-Negra Concorrente
+//
+// TAD que envolve uma árvore rubro-negra (arvore-rn.h) com uma trava
+// de leitura/escrita, para ela poder ser usada por várias threads ao
+// mesmo tempo.
+//
+// as consultas (arv_conc_contem, arv_conc_busca) só pegam a trava de
+// leitura, então qualquer número de threads pode consultar a árvore em
+// paralelo. inserções e remoções pegam a trava de escrita e são feitas
+// uma de cada vez, esperando as consultas em andamento terminarem.
+//
+// a trava de leitura é distribuída: cada thread leitora se anuncia em
+// um contador próprio (em sua própria linha de cache), ao invés de todas
+// disputarem o mesmo contador como em um pthread_rwlock, o que faz as
+// consultas escalarem com o número de núcleos. em troca, a escrita é
+// mais cara, já que o escritor precisa conferir todos os contadores.
+// escritores têm preferência: enquanto um escritor espera, nenhum leitor
+// novo entra.
+//
+// nenhum ponteiro para nó é devolvido, já que o nó pode ser removido
+// por outra thread assim que a trava é liberada. para usar o dado
+// encontrado, passe uma função de visita para arv_conc_busca, que é
+// chamada ainda com a trava de leitura.
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "arvore-rn.h"
+
+//// --- tipos exportados ---
+typedef struct arvore_concorrente ArvoreConcorrente;
+
+
+
+//// --- criação / destruição ---
+
+// cria e retorna uma árvore concorrente que passa a ser dona de `arv`
+// (que pode ter sido criada com qualquer um dos construtores de arvore-rn.h).
+// `arv` não deve mais ser acessada diretamente depois disso.
+// retorna NULL se `arv` for NULL ou em caso de falha de alocação.
+ArvoreConcorrente* arv_conc_cria(Arvore *arv);
+
+// libera a árvore concorrente e a árvore envolvida por ela.
+// nenhuma outra thread pode estar usando a árvore nesse momento.
+void arv_conc_libera(ArvoreConcorrente *arvc);
+
+
+
+//// --- inserção/remoção ---
+
+// insere o valor apontado por `v`, com a trava de escrita.
+// retorna true se for bem sucedido ou false caso não.
+bool arv_conc_insere_no(ArvoreConcorrente *arvc, void *v);
+
+// remove o nó com o valor apontado por `v`, com a trava de escrita.
+// retorna true se for bem sucedido ou false caso não.
+bool arv_conc_remove_no(ArvoreConcorrente *arvc, void *v);
+
+
+
+//// --- consultas ---
+
+// retorna true se a árvore conter o valor `v` ou false senão conter.
+bool arv_conc_contem(ArvoreConcorrente *arvc, void *v);
+
+// busca o valor `v` e, se encontrar, chama `visita` com o dado
+// armazenado e `contexto`, ainda com a trava de leitura. `visita` não
+// deve modificar a parte do dado usada pelo comparador, nem chamar
+// funções de escrita da mesma árvore.
+// retorna true se encontrou ou false senão encontrou.
+bool arv_conc_busca(ArvoreConcorrente *arvc, void *v, Visitante *visita, void *contexto);
+
+// retorna o número de nós da árvore.
+size_t arv_conc_nnos(ArvoreConcorrente *arvc);
+
+
+
+#endif
@@ -0,0 +1,158 @@
+#include "arvore-rn-congelada.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+#define ARV_CONG_LINHA_CACHE 64
+
+// quantas posições cabem em uma linha de cache. os descendentes da posição
+// k que estão 3 níveis abaixo ocupam as posições 8k..8k + 7, que são uma
+// linha de cache inteira, então carregar a posição k * ARV_CONG_POR_LINHA
+// traz todos eles de uma vez
+#define ARV_CONG_POR_LINHA (ARV_CONG_LINHA_CACHE / sizeof(void*))
+// o mesmo para o vetor de prefixos, cujas posições têm o tamanho de um
+// uint64_t e não de um ponteiro
+#define ARV_CONG_PREFIXOS_POR_LINHA (ARV_CONG_LINHA_CACHE / sizeof(uint64_t))
+
+// estrutura de uma árvore congelada
+struct arvore_congelada {
+    size_t num_nos;
+    Comparador *comp;
+    ExtratorPrefixo *extrator;
+
+    // dados no layout de Eytzinger, a partir da posição 1 (a posição 0
+    // não é usada, assim os filhos de k ficam em 2k e 2k + 1)
+    void **dados;
+
+    // prefixo de cada dado, nas mesmas posições, ou NULL se a árvore
+    // original não usa prefixo
+    uint64_t *prefixos;
+};
+
+
+//// --- criação / destruição ---
+
+// função auxiliar que aloca um vetor de `n` itens de `tam` bytes
+// alinhado a uma linha de cache
+static void* arv_cong_aloca(size_t n, size_t tam) {
+    // aligned_alloc exige um tamanho múltiplo do alinhamento
+    size_t bytes = n * tam;
+    bytes = (bytes + ARV_CONG_LINHA_CACHE - 1) / ARV_CONG_LINHA_CACHE * ARV_CONG_LINHA_CACHE;
+    return aligned_alloc(ARV_CONG_LINHA_CACHE, bytes);
+}
+
+// função auxiliar que preenche a sub-árvore do layout com raiz na posição
+// `k` percorrendo a árvore original em ordem a partir de `*atual`. a
+// travessia em ordem do layout visita as posições na mesma ordem dos dados
+static void arv_cong_preenche(ArvoreCongelada *arvc, No **atual, size_t k) {
+    if(k > arvc->num_nos) return;
+
+    arv_cong_preenche(arvc, atual, 2 * k);
+
+    arvc->dados[k] = arv_busca_valor(*atual);
+    if(arvc->prefixos != NULL) arvc->prefixos[k] = arvc->extrator(arvc->dados[k]);
+    *atual = arv_iter_proximo(*atual);
+
+    arv_cong_preenche(arvc, atual, 2 * k + 1);
+}
+
+ArvoreCongelada* arv_congela(Arvore *arv) {
+    if(arv == NULL) return NULL;
+
+    ArvoreCongelada *arvc = (ArvoreCongelada*)malloc(sizeof(ArvoreCongelada));
+    if(arvc == NULL) return NULL;
+
+    arvc->num_nos = arv_nnos(arv);
+    arvc->comp = arv_comparador(arv);
+    arvc->extrator = arv_extrator_prefixo(arv);
+    arvc->prefixos = NULL;
+
+    arvc->dados = (void**)arv_cong_aloca(arvc->num_nos + 1, sizeof(void*));
+    if(arvc->dados == NULL) {
+        free(arvc);
+        return NULL;
+    }
+    if(arvc->extrator != NULL) {
+        arvc->prefixos = (uint64_t*)arv_cong_aloca(arvc->num_nos + 1, sizeof(uint64_t));
+        if(arvc->prefixos == NULL) {
+            free(arvc->dados);
+            free(arvc);
+            return NULL;
+        }
+    }
+
+    No *atual = arv_iter_inicio(arv);
+    arv_cong_preenche(arvc, &atual, 1);
+
+    return arvc;
+}
+
+void arv_cong_libera(ArvoreCongelada *arvc) {
+    if(arvc == NULL) return;
+
+    free(arvc->prefixos);
+    free(arvc->dados);
+    free(arvc);
+}
+
+
+
+//// --- consultas ---
+
+size_t arv_cong_nnos(ArvoreCongelada *arvc) {
+    if(arvc == NULL) return 0;
+    return arvc->num_nos;
+}
+
+// função auxiliar que retorna a posição do primeiro dado maior ou igual a
+// `v`, ou 0 se não houver.
+// a descida vai sempre até o fim, indo para a direita (2k + 1) quando o
+// dado da posição é menor que `v` e para a esquerda (2k) senão. a resposta
+// é o último nó em que a descida foi para a esquerda: cada ida para a
+// direita deixou um bit 1 no final de `k`, então basta tirar esses bits
+// e mais o bit 0 da última ida para a esquerda
+static size_t arv_cong_posicao_inferior(ArvoreCongelada *arvc, void *v) {
+    size_t n = arvc->num_nos;
+    size_t k = 1;
+
+    if(arvc->prefixos != NULL) {
+        uint64_t *prefixos = arvc->prefixos;
+        uint64_t prefixo_v = arvc->extrator(v);
+        while(k <= n) {
+            __builtin_prefetch(prefixos + k * ARV_CONG_PREFIXOS_POR_LINHA);
+            uint64_t prefixo = prefixos[k];
+            // o comparador só é chamado nos empates de prefixo
+            size_t menor = prefixo < prefixo_v ||
+                           (prefixo == prefixo_v && arvc->comp(v, arvc->dados[k]) > 0);
+            k = 2 * k + menor;
+        }
+    }
+    else {
+        void **dados = arvc->dados;
+        while(k <= n) {
+            __builtin_prefetch(dados + k * ARV_CONG_POR_LINHA);
+            k = 2 * k + (arvc->comp(v, dados[k]) > 0);
+        }
+    }
+
+    return k >> __builtin_ffsll((long long)~k);
+}
+
+void* arv_cong_limite_inferior(ArvoreCongelada *arvc, void *v) {
+    if(arvc == NULL) return NULL;
+
+    size_t k = arv_cong_posicao_inferior(arvc, v);
+    if(k == 0) return NULL;
+    return arvc->dados[k];
+}
+
+void* arv_cong_busca(ArvoreCongelada *arvc, void *v) {
+    void *dado = arv_cong_limite_inferior(arvc, v);
+
+    // o primeiro dado maior ou igual a `v` só é o buscado se for igual
+    if(dado == NULL || arvc->comp(v, dado) != 0) return NULL;
+    return dado;
+}
+
+bool arv_cong_contem(ArvoreCongelada *arvc, void *v) {
+    return arv_cong_busca(arvc, v) != NULL;
+}
@@ -0,0 +1,69 @@
+#ifndef _ARVORE_RN_CONGELADA_
+#define _ARVORE_RN_CONGELADA_
+
+// Árvore Rubro-Negra Congelada
+//
+// TAD com uma cópia imutável de uma árvore rubro-negra (arvore-rn.h),
+// otimizada para consultas. os dados são guardados em um único vetor
+// contíguo no layout de Eytzinger (o layout de um heap binário: os
+// filhos da posição k ficam nas posições 2k e 2k + 1), então a descida
+// não segue ponteiros esq/dir e os próximos níveis podem ser trazidos
+// para a cache antes de serem usados.
+//
+// a busca não tem desvios que dependam do resultado da comparação (o
+// índice do próximo nível é calculado direto a partir dela), só o laço
+// que desce até o fim, e carrega antecipadamente os nós alguns níveis
+// abaixo da posição atual.
+//
+// se a árvore original usa prefixo (arv_define_prefixo), os prefixos
+// são copiados para um vetor próprio no mesmo layout, e o comparador só
+// é chamado nos empates de prefixo, como na árvore original.
+//
+// a cópia guarda apenas os ponteiros para os dados, que continuam sendo
+// da árvore original: eles não podem ser liberados (nem alterados na parte
+// usada pelo comparador) enquanto a cópia for usada. mudanças na árvore
+// original depois de congelada não aparecem na cópia.
+// como a cópia nunca muda, qualquer número de threads pode consultá-la ao
+// mesmo tempo sem sincronização.
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "arvore-rn.h"
+
+//// --- tipos exportados ---
+typedef struct arvore_congelada ArvoreCongelada;
+
+
+
+//// --- criação / destruição ---
+
+// cria e retorna uma cópia congelada da árvore `arv`, com os mesmos dados
+// e o mesmo comparador. a árvore original não é alterada.
+// retorna NULL se `arv` for NULL ou em caso de falha de alocação.
+ArvoreCongelada* arv_congela(Arvore *arv);
+
+// libera a cópia congelada. os dados não são liberados, já que continuam
+// sendo da árvore original.
+void arv_cong_libera(ArvoreCongelada *arvc);
+
+
+
+//// --- consultas ---
+
+// retorna o número de dados da cópia.
+size_t arv_cong_nnos(ArvoreCongelada *arvc);
+
+// retorna o dado igual a `v`, ou NULL se não houver.
+void* arv_cong_busca(ArvoreCongelada *arvc, void *v);
+
+// retorna true se a cópia conter o valor `v` ou false senão conter.
+bool arv_cong_contem(ArvoreCongelada *arvc, void *v);
+
+// retorna o primeiro dado (em ordem) maior ou igual a `v`, ou NULL se
+// todos forem menores.
+void* arv_cong_limite_inferior(ArvoreCongelada *arvc, void *v);
+
+
+
+#endif
@@ -0,0 +1,169 @@
+#include "arvore-rn-intervalos.h"
+#include <stdlib.h>
+
+// estrutura de uma árvore de intervalos
+struct arvore_intervalos {
+    // árvore ordenada pelo início (e depois pelo fim) dos intervalos, com
+    // o maior fim de cada sub-árvore como agregado
+    Arvore *arv;
+};
+
+// maior fim de uma sub-árvore vazia: nenhum intervalo termina antes dele
+static const int64_t arv_int_sem_fim = INT64_MIN;
+
+
+//// --- criação / destruição ---
+
+// função auxiliar que compara dois dados pelos seus intervalos
+static int arv_int_compara(void *dado1, void *dado2) {
+    const Intervalo *a = (const Intervalo*)dado1;
+    const Intervalo *b = (const Intervalo*)dado2;
+
+    if(a->inicio != b->inicio) return a->inicio < b->inicio ? -1 : 1;
+    if(a->fim != b->fim) return a->fim < b->fim ? -1 : 1;
+    return 0;
+}
+
+// função auxiliar do agregado: junta o fim do intervalo de `dado` ao
+// maior fim `acumulado`
+static void arv_int_acumula(void *acumulado, void *dado, void *contexto) {
+    (void)contexto;
+    int64_t *maior = (int64_t*)acumulado;
+    int64_t fim = ((const Intervalo*)dado)->fim;
+    if(fim > *maior) *maior = fim;
+}
+
+// função auxiliar do agregado: junta o maior fim `outro` de uma
+// sub-árvore ao maior fim `acumulado`
+static void arv_int_combina(void *acumulado, void *outro, void *contexto) {
+    (void)contexto;
+    int64_t *maior = (int64_t*)acumulado;
+    int64_t fim = *(const int64_t*)outro;
+    if(fim > *maior) *maior = fim;
+}
+
+ArvoreIntervalos* arv_int_cria(Liberador *libera) {
+    ArvoreIntervalos *arvi = (ArvoreIntervalos*)malloc(sizeof(ArvoreIntervalos));
+    if(arvi == NULL) return NULL;
+
+    arvi->arv = arv_cria(arv_int_compara, libera);
+    if(arvi->arv == NULL) {
+        free(arvi);
+        return NULL;
+    }
+    if(!arv_define_agregado(arvi->arv, sizeof(int64_t), &arv_int_sem_fim,
+                            arv_int_acumula, arv_int_combina, NULL)) {
+        arv_libera_arvore(arvi->arv);
+        free(arvi);
+        return NULL;
+    }
+
+    return arvi;
+}
+
+void arv_int_libera(ArvoreIntervalos *arvi) {
+    if(arvi == NULL) return;
+
+    arv_libera_arvore(arvi->arv);
+    free(arvi);
+}
+
+
+
+//// --- inserção/remoção ---
+
+bool arv_int_insere(ArvoreIntervalos *arvi, void *dado) {
+    if(arvi == NULL || dado == NULL) return false;
+
+    const Intervalo *iv = (const Intervalo*)dado;
+    if(iv->inicio > iv->fim) return false;
+
+    return arv_insere_no(arvi->arv, dado);
+}
+
+bool arv_int_remove(ArvoreIntervalos *arvi, void *dado) {
+    if(arvi == NULL || dado == NULL) return false;
+
+    // entre os dados com o mesmo intervalo, procura o próprio `dado`
+    for(No *no = arv_limite_inferior(arvi->arv, dado);
+        no != NULL && arv_int_compara(dado, arv_busca_valor(no)) == 0;
+        no = arv_iter_proximo(no)) {
+        if(arv_busca_valor(no) == dado) return arv_remove_no_handle(arvi->arv, no);
+    }
+
+    return false;
+}
+
+
+
+//// --- consultas ---
+
+// função auxiliar que retorna o maior fim da sub-árvore com raiz `no`
+static int64_t arv_int_fim_maximo(No *no) {
+    if(arv_no_vazio(no)) return arv_int_sem_fim;
+
+    return *(const int64_t*)arv_busca_agregado(no);
+}
+
+// função auxiliar que retorna true se o intervalo `iv` se sobrepõe a
+// [inicio, fim]
+static bool arv_int_sobrepoe(const Intervalo *iv, int64_t inicio, int64_t fim) {
+    return iv->inicio <= fim && iv->fim >= inicio;
+}
+
+size_t arv_int_nnos(ArvoreIntervalos *arvi) {
+    if(arvi == NULL) return 0;
+
+    return arv_nnos(arvi->arv);
+}
+
+void* arv_int_busca_sobreposto(ArvoreIntervalos *arvi, int64_t inicio, int64_t fim) {
+    if(arvi == NULL || inicio > fim) return NULL;
+
+    No *no = arv_busca_raiz(arvi->arv);
+    while(!arv_no_vazio(no)) {
+        const Intervalo *iv = (const Intervalo*)arv_busca_valor(no);
+        if(arv_int_sobrepoe(iv, inicio, fim)) return arv_busca_valor(no);
+
+        // se algum intervalo da esquerda termina a partir de `inicio`, ou
+        // ele se sobrepõe, ou começa depois de `fim` e então todos os da
+        // direita também começam
+        No *esq = arv_busca_filho(no, false);
+        no = arv_int_fim_maximo(esq) >= inicio ? esq : arv_busca_filho(no, true);
+    }
+
+    return NULL;
+}
+
+// função auxiliar que visita, em ordem, os dados da sub-árvore com raiz
+// `no` que se sobrepõem a [inicio, fim], e retorna quantos foram visitados
+static size_t arv_int_sobreposicoes_rec(No *no, int64_t inicio, int64_t fim,
+                                        Visitante *visita, void *contexto) {
+    if(arv_no_vazio(no)) return 0;
+    // nenhum intervalo da sub-árvore chega até `inicio`
+    if(arv_int_fim_maximo(no) < inicio) return 0;
+
+    size_t visitados = arv_int_sobreposicoes_rec(arv_busca_filho(no, false), inicio, fim, visita, contexto);
+
+    // este e todos os da direita começam depois de `fim`
+    const Intervalo *iv = (const Intervalo*)arv_busca_valor(no);
+    if(iv->inicio > fim) return visitados;
+
+    if(iv->fim >= inicio) {
+        visita(arv_busca_valor(no), contexto);
+        visitados++;
+    }
+
+    return visitados + arv_int_sobreposicoes_rec(arv_busca_filho(no, true), inicio, fim, visita, contexto);
+}
+
+size_t arv_int_sobreposicoes(ArvoreIntervalos *arvi, int64_t inicio, int64_t fim,
+                             Visitante *visita, void *contexto) {
+    if(arvi == NULL || visita == NULL || inicio > fim) return 0;
+
+    return arv_int_sobreposicoes_rec(arv_busca_raiz(arvi->arv), inicio, fim, visita, contexto);
+}
+
+size_t arv_int_perfura(ArvoreIntervalos *arvi, int64_t ponto, Visitante *visita, void *contexto) {
+    return arv_int_sobreposicoes(arvi, ponto, ponto, visita, contexto);
+}
@@ -0,0 +1,94 @@
+#ifndef _ARVORE_RN_INTERVALOS_
+#define _ARVORE_RN_INTERVALOS_
+
+// Árvore Rubro-Negra de Intervalos
+//
+// TAD que guarda intervalos fechados [inicio, fim] em uma árvore
+// rubro-negra (arvore-rn.h) ordenada pelo início, e responde quais
+// intervalos se sobrepõem a um intervalo ou contêm um ponto sem percorrer
+// todos os que começam antes dele.
+//
+// cada nó guarda, com o agregado da árvore (arv_define_agregado), o maior
+// fim da sua sub-árvore, que a árvore mantém nas inserções, remoções e
+// rotações. as consultas descem só pelas sub-árvores cujo maior fim
+// alcança o intervalo procurado.
+//
+// os dados são do usuário e devem começar com um campo `Intervalo`, por
+// exemplo:
+//   typedef struct { Intervalo iv; char *descricao; } Reserva;
+// o intervalo de um dado não pode ser alterado enquanto ele estiver na
+// árvore.
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "arvore-rn.h"
+
+//// --- tipos exportados ---
+typedef struct arvore_intervalos ArvoreIntervalos;
+
+// intervalo fechado, com `inicio` <= `fim`. deve ser o primeiro campo
+// dos dados inseridos na árvore.
+typedef struct {
+    int64_t inicio;
+    int64_t fim;
+} Intervalo;
+
+
+
+//// --- criação / destruição ---
+
+// cria e retorna uma árvore de intervalos vazia, com as mesmas regras de
+// `libera` de arv_cria.
+// retorna NULL em caso de falha de alocação.
+ArvoreIntervalos* arv_int_cria(Liberador *libera);
+
+// libera a árvore e, se ela possuir uma função de liberação, os dados.
+void arv_int_libera(ArvoreIntervalos *arvi);
+
+
+
+//// --- inserção/remoção ---
+
+// insere o dado `dado`, que começa com o seu `Intervalo`. intervalos
+// iguais podem ser inseridos mais de uma vez.
+// retorna true se for bem sucedido ou false caso não (inclusive se o
+// início do intervalo for maior que o fim).
+bool arv_int_insere(ArvoreIntervalos *arvi, void *dado);
+
+// remove o dado `dado` (o próprio ponteiro, não só um intervalo igual),
+// liberando-o se a árvore possuir uma função de liberação.
+// retorna true se for bem sucedido ou false se `dado` não estiver na árvore.
+bool arv_int_remove(ArvoreIntervalos *arvi, void *dado);
+
+
+
+//// --- consultas ---
+
+// retorna o número de intervalos da árvore.
+size_t arv_int_nnos(ArvoreIntervalos *arvi);
+
+// retorna um dado cujo intervalo se sobrepõe a [inicio, fim] (tem algum
+// ponto em comum com ele), ou NULL se não houver, em O(log n).
+void* arv_int_busca_sobreposto(ArvoreIntervalos *arvi, int64_t inicio, int64_t fim);
+
+// chama `visita` com cada dado cujo intervalo se sobrepõe a
+// [inicio, fim], em ordem de início, e `contexto`.
+// retorna o número de dados visitados. a descida só entra nas
+// sub-árvores com algum intervalo que começa até `fim` e termina a
+// partir de `inicio`, então custa O(log n) mais o caminho até cada um
+// dos k dados encontrados, que os dados vizinhos compartilham
+// (O((k + 1) log n) no pior caso).
+// a árvore não deve ser alterada durante a chamada.
+size_t arv_int_sobreposicoes(ArvoreIntervalos *arvi, int64_t inicio, int64_t fim,
+                             Visitante *visita, void *contexto);
+
+// chama `visita` com cada dado cujo intervalo contém o ponto `ponto`,
+// como arv_int_sobreposicoes com o intervalo [ponto, ponto].
+// retorna o número de dados visitados.
+size_t arv_int_perfura(ArvoreIntervalos *arvi, int64_t ponto, Visitante *visita, void *contexto);
+
+
+
+#endif
@@ -0,0 +1,601 @@
+#include "arvore-rn-persistente.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// número de contadores de leitores de cada árvore, como em
+// arvore-rn-concorrente.c
+#define ARV_PERS_FATIAS 64
+#define ARV_PERS_LINHA_CACHE 64
+
+// tamanho da pilha de caminho. a altura de uma árvore rubro-negra com n
+// nós é no máximo 2 log2(n + 1), ou seja 128 com 2^64 - 1 nós, mais uma
+// posição para o nó novo da inserção e uma que a correção da remoção pode
+// acrescentar ao caminho
+#define ARV_PERS_MAX_CAMINHO 130
+
+// lados de um filho, usados como índice de `filhos`
+#define ESQ 0
+#define DIR 1
+
+typedef struct no_persistente NoPersistente;
+
+// estrutura de um nó persistente. não há ponteiro para o pai, já que o
+// mesmo nó pode estar em várias versões, com pais diferentes
+struct no_persistente {
+    void *dado;
+    // referências ao dado, compartilhadas por todas as cópias do nó
+    atomic_size_t *refs_dado;
+    NoPersistente *filhos[2];
+    // número de nós e versões que apontam para este nó
+    atomic_size_t refs;
+    // escrita que criou o nó. só os nós criados pela escrita em andamento
+    // ainda não foram publicados e podem ser alterados
+    uint64_t geracao;
+    Cor cor;
+};
+
+// estrutura de uma versão. o comparador e o liberador ficam na versão
+// para ela poder ser consultada e liberada depois da árvore
+struct versao_persistente {
+    atomic_size_t refs;
+    NoPersistente *raiz;
+    size_t num_nos;
+    Comparador *comp;
+    Liberador *libera;
+    // próxima versão na lista de versões aposentadas da árvore
+    VersaoPersistente *prox;
+};
+
+// leitores pegando a versão atual em uma fatia, ocupando uma linha de
+// cache inteira
+typedef struct {
+    alignas(ARV_PERS_LINHA_CACHE) atomic_int leitores;
+} FatiaVersao;
+
+// estrutura de uma árvore persistente
+struct arvore_persistente {
+    FatiaVersao fatias[ARV_PERS_FATIAS];
+
+    alignas(ARV_PERS_LINHA_CACHE) _Atomic(VersaoPersistente*) atual;
+
+    // só um escritor por vez. os campos abaixo só são usados com a trava
+    pthread_mutex_t trava_escrita;
+    // versões trocadas que a árvore ainda não soltou
+    VersaoPersistente *aposentadas;
+    uint64_t geracao;
+
+    Comparador *comp;
+    Liberador *libera;
+};
+
+// próxima fatia a ser entregue para uma thread que ainda não tem fatia
+static atomic_uint proxima_fatia;
+
+// função auxiliar que retorna a fatia da thread atual
+static unsigned arv_pers_fatia() {
+    static _Thread_local unsigned fatia = 0;
+    static _Thread_local bool tem_fatia = false;
+
+    if(!tem_fatia) {
+        fatia = atomic_fetch_add(&proxima_fatia, 1) % ARV_PERS_FATIAS;
+        tem_fatia = true;
+    }
+    return fatia;
+}
+
+
+//// --- acesso aos nós ---
+
+// todo nó NULL é preto
+static inline Cor arv_pers_cor(NoPersistente *no) {
+    if(no == NULL) return PRETO;
+    return no->cor;
+}
+
+// função auxiliar que solta uma referência a `no`, liberando o nó (e
+// soltando os filhos e o dado dele) se era a última
+static void arv_pers_solta_no(NoPersistente *no, Liberador *libera) {
+    // o filho direito é solto no próprio laço, então a recursão só
+    // acompanha a altura da árvore
+    while(no != NULL) {
+        if(atomic_fetch_sub_explicit(&no->refs, 1, memory_order_acq_rel) != 1) return;
+
+        if(atomic_fetch_sub_explicit(no->refs_dado, 1, memory_order_acq_rel) == 1) {
+            // o dado NULL é o de uma inserção que falhou, que ainda é do usuário
+            if(libera != NULL && no->dado != NULL) libera(no->dado);
+            free(no->refs_dado);
+        }
+
+        arv_pers_solta_no(no->filhos[ESQ], libera);
+        NoPersistente *dir = no->filhos[DIR];
+        free(no);
+        no = dir;
+    }
+}
+
+// função auxiliar que garante que o nó apontado por `campo` (um campo de
+// um nó já copiado nesta escrita, ou a raiz da nova versão) possa ser
+// alterado, trocando-o por uma cópia se ele foi criado por uma escrita
+// anterior. a cópia aponta para os mesmos filhos e o mesmo dado.
+// retorna false em caso de falha de alocação
+static bool arv_pers_privatiza(ArvorePersistente *arvp, NoPersistente **campo) {
+    NoPersistente *no = *campo;
+    if(no == NULL || no->geracao == arvp->geracao) return true;
+
+    NoPersistente *copia = (NoPersistente*)malloc(sizeof(NoPersistente));
+    if(copia == NULL) return false;
+
+    copia->dado = no->dado;
+    copia->refs_dado = no->refs_dado;
+    atomic_fetch_add_explicit(copia->refs_dado, 1, memory_order_relaxed);
+    for(int lado = ESQ; lado <= DIR; lado++) {
+        copia->filhos[lado] = no->filhos[lado];
+        if(copia->filhos[lado] != NULL) {
+            atomic_fetch_add_explicit(&copia->filhos[lado]->refs, 1, memory_order_relaxed);
+        }
+    }
+    atomic_init(&copia->refs, 1);
+    copia->geracao = arvp->geracao;
+    copia->cor = no->cor;
+
+    // o campo deixa de apontar para o original, que continua na versão
+    // publicada
+    *campo = copia;
+    arv_pers_solta_no(no, arvp->libera);
+    return true;
+}
+
+// função auxiliar que rotaciona a sub-árvore com raiz `no`, cujo pai é
+// `pai` (NULL se `no` é a raiz), como arv_comp_rotaciona. `no`, `pai` e o
+// filho que sobe precisam ter sido copiados nesta escrita
+static void arv_pers_rotaciona(VersaoPersistente *versao, NoPersistente *no, NoPersistente *pai, int lado) {
+    NoPersistente *sobe = no->filhos[!lado];
+
+    no->filhos[!lado] = sobe->filhos[lado];
+    sobe->filhos[lado] = no;
+
+    if(pai == NULL) {
+        versao->raiz = sobe;
+    }
+    else {
+        pai->filhos[pai->filhos[ESQ] == no ? ESQ : DIR] = sobe;
+    }
+}
+
+
+
+//// --- criação / destruição ---
+
+ArvorePersistente* arv_pers_cria(Comparador *comp, Liberador *libera) {
+    if(comp == NULL) return NULL;
+
+    // as fatias precisam estar alinhadas à linha de cache
+    size_t tamanho = sizeof(ArvorePersistente);
+    tamanho += (ARV_PERS_LINHA_CACHE - tamanho % ARV_PERS_LINHA_CACHE) % ARV_PERS_LINHA_CACHE;
+    ArvorePersistente *nova = (ArvorePersistente*)aligned_alloc(ARV_PERS_LINHA_CACHE, tamanho);
+    if(nova == NULL) return NULL;
+
+    VersaoPersistente *vazia = (VersaoPersistente*)malloc(sizeof(VersaoPersistente));
+    if(vazia == NULL) {
+        free(nova);
+        return NULL;
+    }
+    if(pthread_mutex_init(&nova->trava_escrita, NULL) != 0) {
+        free(vazia);
+        free(nova);
+        return NULL;
+    }
+
+    atomic_init(&vazia->refs, 1);
+    vazia->raiz = NULL;
+    vazia->num_nos = 0;
+    vazia->comp = comp;
+    vazia->libera = libera;
+    vazia->prox = NULL;
+
+    for(int i = 0; i < ARV_PERS_FATIAS; i++) {
+        atomic_init(&nova->fatias[i].leitores, 0);
+    }
+    atomic_init(&nova->atual, vazia);
+    nova->aposentadas = NULL;
+    nova->geracao = 0;
+    nova->comp = comp;
+    nova->libera = libera;
+
+    return nova;
+}
+
+// função auxiliar que solta todas as versões aposentadas da árvore
+static void arv_pers_solta_aposentadas(ArvorePersistente *arvp) {
+    while(arvp->aposentadas != NULL) {
+        VersaoPersistente *versao = arvp->aposentadas;
+        arvp->aposentadas = versao->prox;
+        arv_pers_solta(versao);
+    }
+}
+
+void arv_pers_libera(ArvorePersistente *arvp) {
+    if(arvp == NULL) return;
+
+    arv_pers_solta_aposentadas(arvp);
+    arv_pers_solta(atomic_load_explicit(&arvp->atual, memory_order_relaxed));
+    pthread_mutex_destroy(&arvp->trava_escrita);
+    free(arvp);
+}
+
+
+
+//// --- versões ---
+
+VersaoPersistente* arv_pers_versao(ArvorePersistente *arvp) {
+    if(arvp == NULL) return NULL;
+
+    // enquanto a fatia estiver marcada, a árvore não solta a versão que
+    // foi trocada, então ela não pode ser liberada entre a leitura de
+    // `atual` e o incremento do contador
+    FatiaVersao *fatia = &arvp->fatias[arv_pers_fatia()];
+    atomic_fetch_add(&fatia->leitores, 1);
+    VersaoPersistente *versao = atomic_load(&arvp->atual);
+    atomic_fetch_add_explicit(&versao->refs, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&fatia->leitores, 1, memory_order_release);
+
+    return versao;
+}
+
+void arv_pers_solta(VersaoPersistente *versao) {
+    if(versao == NULL) return;
+    if(atomic_fetch_sub_explicit(&versao->refs, 1, memory_order_acq_rel) != 1) return;
+
+    arv_pers_solta_no(versao->raiz, versao->libera);
+    free(versao);
+}
+
+// função auxiliar que começa uma escrita, criando uma nova versão igual à
+// atual, mas ainda não publicada.
+// retorna NULL em caso de falha de alocação
+static VersaoPersistente* arv_pers_nova_versao(ArvorePersistente *arvp) {
+    // só o escritor troca a versão atual, e ele está com a trava
+    VersaoPersistente *atual = atomic_load_explicit(&arvp->atual, memory_order_relaxed);
+
+    VersaoPersistente *nova = (VersaoPersistente*)malloc(sizeof(VersaoPersistente));
+    if(nova == NULL) return NULL;
+
+    atomic_init(&nova->refs, 1);
+    nova->raiz = atual->raiz;
+    if(nova->raiz != NULL) atomic_fetch_add_explicit(&nova->raiz->refs, 1, memory_order_relaxed);
+    nova->num_nos = atual->num_nos;
+    nova->comp = arvp->comp;
+    nova->libera = arvp->libera;
+    nova->prox = NULL;
+
+    // nenhum nó existente é desta escrita
+    arvp->geracao++;
+    return nova;
+}
+
+// função auxiliar que publica a versão `nova` no lugar da atual, e solta
+// as versões aposentadas se nenhum leitor estiver pegando uma versão.
+// um leitor que leu a versão antiga ainda estava com a fatia marcada
+// quando a troca foi feita, então se todas as fatias estão zeradas
+// depois da troca, todos esses leitores já contaram sua referência
+static void arv_pers_publica(ArvorePersistente *arvp, VersaoPersistente *nova) {
+    VersaoPersistente *antiga = atomic_exchange(&arvp->atual, nova);
+    antiga->prox = arvp->aposentadas;
+    arvp->aposentadas = antiga;
+
+    for(int i = 0; i < ARV_PERS_FATIAS; i++) {
+        if(atomic_load(&arvp->fatias[i].leitores) != 0) return;
+    }
+    arv_pers_solta_aposentadas(arvp);
+}
+
+
+
+//// --- inserção/remoção ---
+
+// função auxiliar que insere `v` na versão `versao`, ainda não publicada.
+// retorna false em caso de falha de alocação
+static bool arv_pers_insere(ArvorePersistente *arvp, VersaoPersistente *versao, void *v) {
+    // caminho da raiz até o novo nó, todo copiado
+    NoPersistente *caminho[ARV_PERS_MAX_CAMINHO];
+    int prof = 0;
+
+    NoPersistente **campo = &versao->raiz;
+    while(*campo != NULL) {
+        if(!arv_pers_privatiza(arvp, campo)) return false;
+
+        NoPersistente *atual = *campo;
+        caminho[prof++] = atual;
+        campo = &atual->filhos[arvp->comp(v, atual->dado) < 0 ? ESQ : DIR];
+    }
+
+    NoPersistente *novo_no = (NoPersistente*)malloc(sizeof(NoPersistente));
+    if(novo_no == NULL) return false;
+    novo_no->refs_dado = (atomic_size_t*)malloc(sizeof(atomic_size_t));
+    if(novo_no->refs_dado == NULL) {
+        free(novo_no);
+        return false;
+    }
+
+    // todo nó a ser inserido é pintado de vermelho
+    novo_no->dado = v;
+    atomic_init(novo_no->refs_dado, 1);
+    novo_no->filhos[ESQ] = NULL;
+    novo_no->filhos[DIR] = NULL;
+    atomic_init(&novo_no->refs, 1);
+    novo_no->geracao = arvp->geracao;
+    novo_no->cor = VERMELHO;
+
+    *campo = novo_no;
+    caminho[prof] = novo_no;
+
+    // mesmos casos de arv_comp_insere_no. o pai e o avô estão no caminho,
+    // só o tio pode precisar ser copiado
+    int i = prof;
+    while(i >= 2 && arv_pers_cor(caminho[i - 1]) == VERMELHO) {
+        NoPersistente *pai = caminho[i - 1];
+        NoPersistente *avo = caminho[i - 2];
+        int lado_pai = avo->filhos[DIR] == pai ? DIR : ESQ;
+
+        // caso 3: pai e tio vermelhos, repinta e continua pelo avô
+        if(arv_pers_cor(avo->filhos[!lado_pai]) == VERMELHO) {
+            if(!arv_pers_privatiza(arvp, &avo->filhos[!lado_pai])) {
+                // o dado volta a ser do usuário
+                novo_no->dado = NULL;
+                return false;
+            }
+            pai->cor = PRETO;
+            avo->filhos[!lado_pai]->cor = PRETO;
+            avo->cor = VERMELHO;
+            i -= 2;
+            continue;
+        }
+
+        // caso 4: o nó está do lado oposto do pai em relação ao avô,
+        // rotaciona o pai para o nó ficar do mesmo lado
+        if(caminho[i] == pai->filhos[!lado_pai]) {
+            arv_pers_rotaciona(versao, pai, avo, lado_pai);
+            pai = caminho[i];
+        }
+
+        // caso 5: rotaciona o avô e troca as cores do pai e do avô
+        pai->cor = PRETO;
+        avo->cor = VERMELHO;
+        arv_pers_rotaciona(versao, avo, i >= 3 ? caminho[i - 3] : NULL, !lado_pai);
+        break;
+    }
+
+    versao->raiz->cor = PRETO;
+    versao->num_nos++;
+    return true;
+}
+
+bool arv_pers_insere_no(ArvorePersistente *arvp, void *v) {
+    if(arvp == NULL || v == NULL) return false;
+
+    pthread_mutex_lock(&arvp->trava_escrita);
+    VersaoPersistente *nova = arv_pers_nova_versao(arvp);
+    bool inseriu = nova != NULL && arv_pers_insere(arvp, nova, v);
+    if(inseriu) {
+        arv_pers_publica(arvp, nova);
+    }
+    else {
+        // descarta as cópias feitas
+        arv_pers_solta(nova);
+    }
+    pthread_mutex_unlock(&arvp->trava_escrita);
+
+    return inseriu;
+}
+
+// função auxiliar que corrige a versão depois de um nó preto ter sido
+// desligado, com o caminho e os lados como em arv_comp_remove_fixup.
+// todo o caminho já foi copiado, e os irmãos são copiados antes de serem
+// alterados.
+// retorna false em caso de falha de alocação
+static bool arv_pers_remove_fixup(ArvorePersistente *arvp, VersaoPersistente *versao, NoPersistente **caminho, int *lados, int prof) {
+    NoPersistente *x = caminho[prof];
+
+    while(prof > 0 && arv_pers_cor(x) == PRETO) {
+        int lado = lados[prof];
+        NoPersistente *pai = caminho[prof - 1];
+        NoPersistente *avo = prof >= 2 ? caminho[prof - 2] : NULL;
+
+        if(!arv_pers_privatiza(arvp, &pai->filhos[!lado])) return false;
+        NoPersistente *irmao = pai->filhos[!lado];
+
+        // caso 1: irmão vermelho, rotaciona o pai para o irmão ficar preto.
+        // o antigo irmão entra no caminho entre o avô e o pai
+        if(arv_pers_cor(irmao) == VERMELHO) {
+            irmao->cor = PRETO;
+            pai->cor = VERMELHO;
+            arv_pers_rotaciona(versao, pai, avo, lado);
+
+            caminho[prof - 1] = irmao;
+            caminho[prof] = pai;
+            lados[prof] = lado;
+            prof++;
+            caminho[prof] = x;
+            lados[prof] = lado;
+
+            avo = irmao;
+            if(!arv_pers_privatiza(arvp, &pai->filhos[!lado])) return false;
+            irmao = pai->filhos[!lado];
+        }
+
+        // caso 2: irmão preto com os dois filhos pretos, o "preto extra" sobe
+        if(arv_pers_cor(irmao->filhos[ESQ]) == PRETO && arv_pers_cor(irmao->filhos[DIR]) == PRETO) {
+            irmao->cor = VERMELHO;
+            x = pai;
+            prof--;
+            continue;
+        }
+
+        // caso 3: só o filho do irmão do mesmo lado de `x` é vermelho,
+        // rotaciona o irmão para cair no caso 4
+        if(arv_pers_cor(irmao->filhos[!lado]) == PRETO) {
+            if(!arv_pers_privatiza(arvp, &irmao->filhos[lado])) return false;
+            irmao->filhos[lado]->cor = PRETO;
+            irmao->cor = VERMELHO;
+            arv_pers_rotaciona(versao, irmao, pai, !lado);
+            irmao = pai->filhos[!lado];
+        }
+
+        // caso 4: o filho do irmão do lado oposto a `x` é vermelho,
+        // rotaciona o pai e resolve o "preto extra"
+        if(!arv_pers_privatiza(arvp, &irmao->filhos[!lado])) return false;
+        irmao->cor = pai->cor;
+        pai->cor = PRETO;
+        irmao->filhos[!lado]->cor = PRETO;
+        arv_pers_rotaciona(versao, pai, avo, lado);
+        x = versao->raiz;
+        break;
+    }
+
+    // um `x` vermelho sempre é uma cópia desta escrita, e um preto não
+    // precisa ser repintado
+    if(x != NULL && x->cor == VERMELHO) x->cor = PRETO;
+    return true;
+}
+
+// função auxiliar que remove `v` da versão `versao`, ainda não publicada.
+// retorna false se `v` não estiver na versão ou em caso de falha de alocação
+static bool arv_pers_remove(ArvorePersistente *arvp, VersaoPersistente *versao, void *v) {
+    NoPersistente *caminho[ARV_PERS_MAX_CAMINHO];
+    int lados[ARV_PERS_MAX_CAMINHO];
+    int prof = 0;
+    lados[0] = ESQ;
+
+    // busca o nó a remover, copiando o caminho
+    NoPersistente **campo = &versao->raiz;
+    NoPersistente *no = NULL;
+    while(*campo != NULL) {
+        if(!arv_pers_privatiza(arvp, campo)) return false;
+
+        NoPersistente *atual = *campo;
+        caminho[prof] = atual;
+        int resultado_comp = arvp->comp(v, atual->dado);
+        if(resultado_comp == 0) {
+            no = atual;
+            break;
+        }
+
+        int lado = resultado_comp < 0 ? ESQ : DIR;
+        campo = &atual->filhos[lado];
+        lados[++prof] = lado;
+    }
+    if(no == NULL) return false;
+
+    // com 2 filhos, o sucessor é que sai da árvore. o nó e o sucessor são
+    // cópias desta escrita, então trocar os dados entre eles não altera
+    // nenhum nó publicado
+    if(no->filhos[ESQ] != NULL && no->filhos[DIR] != NULL) {
+        campo = &no->filhos[DIR];
+        int lado = DIR;
+        while(true) {
+            if(!arv_pers_privatiza(arvp, campo)) return false;
+            caminho[++prof] = *campo;
+            lados[prof] = lado;
+            if((*campo)->filhos[ESQ] == NULL) break;
+            campo = &(*campo)->filhos[ESQ];
+            lado = ESQ;
+        }
+        NoPersistente *sucessor = *campo;
+
+        void *dado = no->dado;
+        atomic_size_t *refs_dado = no->refs_dado;
+        no->dado = sucessor->dado;
+        no->refs_dado = sucessor->refs_dado;
+        sucessor->dado = dado;
+        sucessor->refs_dado = refs_dado;
+        no = sucessor;
+    }
+
+    // `no` tem no máximo um filho, que ocupa o lugar dele
+    NoPersistente **campo_no = prof == 0 ? &versao->raiz : &caminho[prof - 1]->filhos[lados[prof]];
+    *campo_no = no->filhos[ESQ] != NULL ? no->filhos[ESQ] : no->filhos[DIR];
+    // o nó desligado não é mais dono do filho
+    no->filhos[ESQ] = NULL;
+    no->filhos[DIR] = NULL;
+
+    // solta o nó desligado, e o dado junto se nenhuma versão o tiver
+    Cor cor_no = no->cor;
+    arv_pers_solta_no(no, arvp->libera);
+
+    if(cor_no == PRETO) {
+        // um filho vermelho só é repintado de preto, e precisa ser copiado
+        if(arv_pers_cor(*campo_no) == VERMELHO && !arv_pers_privatiza(arvp, campo_no)) return false;
+        caminho[prof] = *campo_no;
+        if(!arv_pers_remove_fixup(arvp, versao, caminho, lados, prof)) return false;
+    }
+
+    versao->num_nos--;
+    return true;
+}
+
+bool arv_pers_remove_no(ArvorePersistente *arvp, void *v) {
+    if(arvp == NULL) return false;
+
+    pthread_mutex_lock(&arvp->trava_escrita);
+    VersaoPersistente *nova = arv_pers_nova_versao(arvp);
+    bool removeu = nova != NULL && arv_pers_remove(arvp, nova, v);
+    if(removeu) {
+        arv_pers_publica(arvp, nova);
+    }
+    else {
+        arv_pers_solta(nova);
+    }
+    pthread_mutex_unlock(&arvp->trava_escrita);
+
+    return removeu;
+}
+
+
+
+//// --- consultas ---
+
+size_t arv_pers_nnos(VersaoPersistente *versao) {
+    if(versao == NULL) return 0;
+    return versao->num_nos;
+}
+
+void* arv_pers_busca(VersaoPersistente *versao, void *v) {
+    if(versao == NULL) return NULL;
+
+    NoPersistente *atual = versao->raiz;
+    while(atual != NULL) {
+        int resultado_comp = versao->comp(v, atual->dado);
+
+        if(resultado_comp == 0) {
+            return atual->dado;
+        }
+        atual = atual->filhos[resultado_comp < 0 ? ESQ : DIR];
+    }
+
+    return NULL;
+}
+
+bool arv_pers_contem(VersaoPersistente *versao, void *v) {
+    return arv_pers_busca(versao, v) != NULL;
+}
+
+void arv_pers_percorre(VersaoPersistente *versao, Visitante *visita, void *contexto) {
+    if(versao == NULL || visita == NULL) return;
+
+    // percurso em ordem com uma pilha, que nunca passa da altura da árvore
+    NoPersistente *pilha[ARV_PERS_MAX_CAMINHO];
+    int topo = 0;
+    NoPersistente *atual = versao->raiz;
+    while(atual != NULL || topo > 0) {
+        while(atual != NULL) {
+            pilha[topo++] = atual;
+            atual = atual->filhos[ESQ];
+        }
+        atual = pilha[--topo];
+        visita(atual->dado, contexto);
+        atual = atual->filhos[DIR];
+    }
+}
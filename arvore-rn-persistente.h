@@ -0,0 +1,97 @@
+#ifndef _ARVORE_RN_PERSISTENTE_
+#define _ARVORE_RN_PERSISTENTE_
+
+// Árvore Rubro-Negra Persistente
+//
+// TAD que implementa uma árvore rubro-negra genérica, como a de
+// arvore-rn.h, em que nenhuma inserção ou remoção altera os nós existentes:
+// cada escrita copia só os nós do caminho que ela modifica (e os irmãos
+// que as correções repintam ou rotacionam) e cria uma nova versão da
+// árvore, com uma nova raiz que compartilha todas as outras sub-árvores
+// com a versão anterior.
+//
+// com isso, uma versão nunca muda depois de publicada. arv_pers_versao
+// entrega a versão atual em O(1), e ela pode ser consultada por quanto
+// tempo for preciso, por qualquer thread e sem travas, enquanto as
+// escritas continuam criando versões novas. escritores são feitos um de
+// cada vez, mas nunca esperam os leitores, e os leitores nunca esperam
+// ninguém.
+//
+// os nós, os dados e as versões têm contadores de referência atômicos:
+// uma versão é liberada quando a árvore e todos os leitores a soltam, e
+// um dado só é liberado (pelo liberador da árvore) quando não está em
+// nenhuma versão viva.
+// a troca de versão é publicada sem esperar os leitores que estão
+// pegando a versão anterior naquele instante, então a árvore só solta
+// as versões antigas na próxima escrita em que nenhum leitor estiver
+// no meio de arv_pers_versao.
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "arvore-rn.h"
+
+//// --- tipos exportados ---
+typedef struct arvore_persistente ArvorePersistente;
+typedef struct versao_persistente VersaoPersistente;
+
+
+
+//// --- criação / destruição ---
+
+// cria e retorna uma árvore persistente vazia, com as mesmas regras de
+// `comp` e `libera` de arv_cria.
+// retorna NULL em caso de falha de alocação.
+ArvorePersistente* arv_pers_cria(Comparador *comp, Liberador *libera);
+
+// libera a árvore e solta a versão atual. as versões pegas com
+// arv_pers_versao continuam válidas até serem soltas.
+// nenhuma outra thread pode estar usando a árvore nesse momento.
+void arv_pers_libera(ArvorePersistente *arvp);
+
+
+
+//// --- inserção/remoção ---
+
+// insere o valor apontado por `v`, publicando uma nova versão.
+// retorna true se for bem sucedido ou false caso não (a versão atual
+// não muda em caso de falha de alocação).
+bool arv_pers_insere_no(ArvorePersistente *arvp, void *v);
+
+// remove o valor apontado por `v`, publicando uma nova versão. o dado só
+// é liberado quando nenhuma versão anterior que o contenha estiver viva.
+// retorna true se for bem sucedido ou false caso não.
+bool arv_pers_remove_no(ArvorePersistente *arvp, void *v);
+
+
+
+//// --- versões ---
+
+// retorna a versão atual da árvore, em O(1). a versão nunca muda e deve
+// ser solta com arv_pers_solta.
+// retorna NULL se `arvp` for NULL.
+VersaoPersistente* arv_pers_versao(ArvorePersistente *arvp);
+
+// solta a versão `versao`, que é liberada (junto com os nós e dados que
+// só ela usava) se ninguém mais a estiver usando.
+void arv_pers_solta(VersaoPersistente *versao);
+
+
+
+//// --- consultas ---
+
+// retorna o número de nós da versão.
+size_t arv_pers_nnos(VersaoPersistente *versao);
+
+// retorna o dado da versão igual a `v`, ou NULL se não houver.
+void* arv_pers_busca(VersaoPersistente *versao, void *v);
+
+// retorna true se a versão conter o valor `v` ou false senão conter.
+bool arv_pers_contem(VersaoPersistente *versao, void *v);
+
+// chama `visita` com cada dado da versão, em ordem, e `contexto`.
+void arv_pers_percorre(VersaoPersistente *versao, Visitante *visita, void *contexto);
+
+
+
+#endif
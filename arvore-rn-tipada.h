@@ -0,0 +1,332 @@
+#ifndef _ARVORE_RN_TIPADA_
+#define _ARVORE_RN_TIPADA_
+
+// Árvore Rubro-Negra Tipada
+//
+// gera, a partir de uma macro, uma árvore rubro-negra especializada para
+// um tipo de chave. ao contrário da árvore genérica de arvore-rn.h, a
+// chave fica guardada dentro do próprio nó (não há ponteiro void para o
+// dado) e a comparação é uma expressão que o compilador pode expandir em
+// linha, sem a chamada indireta ao comparador a cada nível da descida.
+//
+// uso:
+//   #define COMPARA_INT(a, b) ARV_COMPARA_NUM(a, b)
+//   ARV_DEFINE(ArvInt, int, COMPARA_INT)
+//
+// gera os tipos `ArvInt` e `ArvInt_no` e as funções:
+//   ArvInt*     ArvInt_cria(void);
+//   void        ArvInt_libera_arvore(ArvInt *arv);
+//   bool        ArvInt_insere_no(ArvInt *arv, int chave);
+//   bool        ArvInt_remove_no(ArvInt *arv, int chave);
+//   ArvInt_no*  ArvInt_busca_no(ArvInt *arv, int chave);
+//   bool        ArvInt_contem(ArvInt *arv, int chave);
+//   size_t      ArvInt_nnos(ArvInt *arv);
+//   bool        ArvInt_vazia(ArvInt *arv);
+//   int*        ArvInt_busca_valor(ArvInt_no *no);
+//   ArvInt_no*  ArvInt_iter_inicio(ArvInt *arv);
+//   ArvInt_no*  ArvInt_iter_proximo(ArvInt_no *no);
+//
+// que se comportam como as funções de mesmo nome da árvore genérica.
+// `cmp(a, b)` recebe duas chaves (valores do tipo `tipo`, não ponteiros)
+// e deve resultar em um inteiro negativo, zero ou positivo, como o
+// Comparador. como a chave é copiada para o nó, `tipo` deve ser um tipo
+// de tamanho fixo que pode ser copiado por atribuição.
+//
+// todas as funções são `static inline`, então a macro pode ser usada em
+// um cabeçalho incluído por várias unidades de compilação.
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "arvore-rn.h"
+
+// comparação de tipos numéricos, para ser usada como `cmp`
+#define ARV_COMPARA_NUM(a, b) (((a) > (b)) - ((a) < (b)))
+
+#define ARV_DEFINE(nome, tipo, cmp)                                                    \
+                                                                                       \
+typedef struct nome##_no nome##_no;                                                    \
+struct nome##_no {                                                                     \
+    tipo chave;                                                                        \
+    Cor cor;                                                                           \
+    nome##_no *dir;                                                                    \
+    nome##_no *esq;                                                                    \
+    nome##_no *pai;                                                                    \
+};                                                                                     \
+                                                                                       \
+typedef struct nome {                                                                  \
+    nome##_no *raiz;                                                                   \
+    size_t num_nos;                                                                    \
+} nome;                                                                                \
+                                                                                       \
+static inline nome* nome##_cria(void) {                                                \
+    nome *arv = (nome*)malloc(sizeof(nome));                                           \
+    if(arv == NULL) return NULL;                                                       \
+    arv->raiz = NULL;                                                                  \
+    arv->num_nos = 0;                                                                  \
+    return arv;                                                                        \
+}                                                                                      \
+                                                                                       \
+/* libera os nós em pós-ordem subindo pelos pais, sem recursão */                     \
+static inline void nome##_libera_arvore(nome *arv) {                                   \
+    if(arv == NULL) return;                                                            \
+    nome##_no *no = arv->raiz;                                                         \
+    while(no != NULL) {                                                                \
+        if(no->esq != NULL) { no = no->esq; continue; }                                \
+        if(no->dir != NULL) { no = no->dir; continue; }                                \
+        nome##_no *pai = no->pai;                                                      \
+        if(pai != NULL) {                                                              \
+            if(pai->esq == no) pai->esq = NULL;                                        \
+            else pai->dir = NULL;                                                      \
+        }                                                                              \
+        free(no);                                                                      \
+        no = pai;                                                                      \
+    }                                                                                  \
+    free(arv);                                                                         \
+}                                                                                      \
+                                                                                       \
+static inline size_t nome##_nnos(nome *arv) {                                          \
+    return arv->num_nos;                                                               \
+}                                                                                      \
+                                                                                       \
+static inline bool nome##_vazia(nome *arv) {                                           \
+    return arv->raiz == NULL;                                                          \
+}                                                                                      \
+                                                                                       \
+static inline tipo* nome##_busca_valor(nome##_no *no) {                                \
+    return no == NULL ? NULL : &no->chave;                                             \
+}                                                                                      \
+                                                                                       \
+static inline Cor nome##_busca_cor(nome##_no *no) {                                    \
+    return no == NULL ? PRETO : no->cor;                                               \
+}                                                                                      \
+                                                                                       \
+static inline nome##_no* nome##_busca_no(nome *arv, tipo chave) {                      \
+    nome##_no *atual = arv->raiz;                                                      \
+    while(atual != NULL) {                                                             \
+        int c = cmp(chave, atual->chave);                                              \
+        if(c == 0) return atual;                                                       \
+        atual = c < 0 ? atual->esq : atual->dir;                                       \
+    }                                                                                  \
+    return NULL;                                                                       \
+}                                                                                      \
+                                                                                       \
+static inline bool nome##_contem(nome *arv, tipo chave) {                              \
+    return nome##_busca_no(arv, chave) != NULL;                                        \
+}                                                                                      \
+                                                                                       \
+static inline nome##_no* nome##_iter_inicio(nome *arv) {                               \
+    nome##_no *no = arv->raiz;                                                         \
+    if(no == NULL) return NULL;                                                        \
+    while(no->esq != NULL) no = no->esq;                                               \
+    return no;                                                                         \
+}                                                                                      \
+                                                                                       \
+static inline nome##_no* nome##_iter_proximo(nome##_no *no) {                          \
+    if(no->dir != NULL) {                                                              \
+        no = no->dir;                                                                  \
+        while(no->esq != NULL) no = no->esq;                                           \
+        return no;                                                                     \
+    }                                                                                  \
+    while(no->pai != NULL && no == no->pai->dir) no = no->pai;                         \
+    return no->pai;                                                                    \
+}                                                                                      \
+                                                                                       \
+/* troca `sub1` por `sub2` no pai de `sub1` */                                         \
+static inline void nome##_subtitui_subarv(nome *arv, nome##_no *sub1, nome##_no *sub2) { \
+    if(sub1->pai == NULL) arv->raiz = sub2;                                            \
+    else if(sub1 == sub1->pai->esq) sub1->pai->esq = sub2;                             \
+    else sub1->pai->dir = sub2;                                                        \
+    if(sub2 != NULL) sub2->pai = sub1->pai;                                            \
+}                                                                                      \
+                                                                                       \
+static inline void nome##_rotacao_esquerda(nome *arv, nome##_no *no) {                 \
+    nome##_no *filho = no->dir;                                                        \
+    no->dir = filho->esq;                                                              \
+    if(filho->esq != NULL) filho->esq->pai = no;                                       \
+    nome##_subtitui_subarv(arv, no, filho);                                            \
+    filho->esq = no;                                                                   \
+    no->pai = filho;                                                                   \
+}                                                                                      \
+                                                                                       \
+static inline void nome##_rotacao_direita(nome *arv, nome##_no *no) {                  \
+    nome##_no *filho = no->esq;                                                        \
+    no->esq = filho->dir;                                                              \
+    if(filho->dir != NULL) filho->dir->pai = no;                                       \
+    nome##_subtitui_subarv(arv, no, filho);                                            \
+    filho->dir = no;                                                                   \
+    no->pai = filho;                                                                   \
+}                                                                                      \
+                                                                                       \
+/* mesmos casos de arv_insere_fixup */                                                 \
+static inline void nome##_insere_fixup(nome *arv, nome##_no *no) {                     \
+    while(nome##_busca_cor(no->pai) == VERMELHO) {                                     \
+        nome##_no *pai = no->pai;                                                      \
+        nome##_no *avo = pai->pai;                                                     \
+        if(pai == avo->esq) {                                                          \
+            nome##_no *tio = avo->dir;                                                 \
+            if(nome##_busca_cor(tio) == VERMELHO) {                                    \
+                pai->cor = PRETO;                                                      \
+                tio->cor = PRETO;                                                      \
+                avo->cor = VERMELHO;                                                   \
+                no = avo;                                                              \
+                continue;                                                              \
+            }                                                                          \
+            if(no == pai->dir) {                                                       \
+                no = pai;                                                              \
+                nome##_rotacao_esquerda(arv, no);                                      \
+            }                                                                          \
+            no->pai->cor = PRETO;                                                      \
+            avo->cor = VERMELHO;                                                       \
+            nome##_rotacao_direita(arv, avo);                                          \
+        }                                                                              \
+        else {                                                                         \
+            nome##_no *tio = avo->esq;                                                 \
+            if(nome##_busca_cor(tio) == VERMELHO) {                                    \
+                pai->cor = PRETO;                                                      \
+                tio->cor = PRETO;                                                      \
+                avo->cor = VERMELHO;                                                   \
+                no = avo;                                                              \
+                continue;                                                              \
+            }                                                                          \
+            if(no == pai->esq) {                                                       \
+                no = pai;                                                              \
+                nome##_rotacao_direita(arv, no);                                       \
+            }                                                                          \
+            no->pai->cor = PRETO;                                                      \
+            avo->cor = VERMELHO;                                                       \
+            nome##_rotacao_esquerda(arv, avo);                                         \
+        }                                                                              \
+    }                                                                                  \
+    arv->raiz->cor = PRETO;                                                            \
+}                                                                                      \
+                                                                                       \
+static inline bool nome##_insere_no(nome *arv, tipo chave) {                           \
+    nome##_no *novo_no = (nome##_no*)malloc(sizeof(nome##_no));                        \
+    if(novo_no == NULL) return false;                                                  \
+    novo_no->chave = chave;                                                            \
+    novo_no->cor = VERMELHO;                                                           \
+    novo_no->esq = NULL;                                                               \
+    novo_no->dir = NULL;                                                               \
+                                                                                       \
+    nome##_no *pai = NULL;                                                             \
+    nome##_no *atual = arv->raiz;                                                      \
+    bool esquerda = false;                                                             \
+    while(atual != NULL) {                                                             \
+        pai = atual;                                                                   \
+        esquerda = cmp(chave, atual->chave) < 0;                                       \
+        atual = esquerda ? atual->esq : atual->dir;                                    \
+    }                                                                                  \
+                                                                                       \
+    novo_no->pai = pai;                                                                \
+    if(pai == NULL) arv->raiz = novo_no;                                               \
+    else if(esquerda) pai->esq = novo_no;                                              \
+    else pai->dir = novo_no;                                                           \
+                                                                                       \
+    nome##_insere_fixup(arv, novo_no);                                                 \
+    arv->num_nos++;                                                                    \
+    return true;                                                                       \
+}                                                                                      \
+                                                                                       \
+/* mesmos casos de arv_remove_fixup, `pai` é o pai de `no` (que pode ser NIL) */       \
+static inline void nome##_remove_fixup(nome *arv, nome##_no *no, nome##_no *pai) {     \
+    while(no != arv->raiz && nome##_busca_cor(no) == PRETO) {                          \
+        if(no == pai->esq) {                                                           \
+            nome##_no *irmao = pai->dir;                                               \
+            if(nome##_busca_cor(irmao) == VERMELHO) {                                  \
+                irmao->cor = PRETO;                                                    \
+                pai->cor = VERMELHO;                                                   \
+                nome##_rotacao_esquerda(arv, pai);                                     \
+                irmao = pai->dir;                                                      \
+            }                                                                          \
+            if(nome##_busca_cor(irmao->esq) == PRETO && nome##_busca_cor(irmao->dir) == PRETO) { \
+                irmao->cor = VERMELHO;                                                 \
+                no = pai;                                                              \
+                pai = no->pai;                                                         \
+                continue;                                                              \
+            }                                                                          \
+            if(nome##_busca_cor(irmao->dir) == PRETO) {                                \
+                irmao->esq->cor = PRETO;                                               \
+                irmao->cor = VERMELHO;                                                 \
+                nome##_rotacao_direita(arv, irmao);                                    \
+                irmao = pai->dir;                                                      \
+            }                                                                          \
+            irmao->cor = pai->cor;                                                     \
+            pai->cor = PRETO;                                                          \
+            irmao->dir->cor = PRETO;                                                   \
+            nome##_rotacao_esquerda(arv, pai);                                         \
+        }                                                                              \
+        else {                                                                         \
+            nome##_no *irmao = pai->esq;                                               \
+            if(nome##_busca_cor(irmao) == VERMELHO) {                                  \
+                irmao->cor = PRETO;                                                    \
+                pai->cor = VERMELHO;                                                   \
+                nome##_rotacao_direita(arv, pai);                                      \
+                irmao = pai->esq;                                                      \
+            }                                                                          \
+            if(nome##_busca_cor(irmao->esq) == PRETO && nome##_busca_cor(irmao->dir) == PRETO) { \
+                irmao->cor = VERMELHO;                                                 \
+                no = pai;                                                              \
+                pai = no->pai;                                                         \
+                continue;                                                              \
+            }                                                                          \
+            if(nome##_busca_cor(irmao->esq) == PRETO) {                                \
+                irmao->dir->cor = PRETO;                                               \
+                irmao->cor = VERMELHO;                                                 \
+                nome##_rotacao_esquerda(arv, irmao);                                   \
+                irmao = pai->esq;                                                      \
+            }                                                                          \
+            irmao->cor = pai->cor;                                                     \
+            pai->cor = PRETO;                                                          \
+            irmao->esq->cor = PRETO;                                                   \
+            nome##_rotacao_direita(arv, pai);                                          \
+        }                                                                              \
+        no = arv->raiz;                                                                \
+    }                                                                                  \
+    if(no != NULL) no->cor = PRETO;                                                    \
+}                                                                                      \
+                                                                                       \
+/* remoção estrutural, como arv_desliga_no */                                          \
+static inline bool nome##_remove_no(nome *arv, tipo chave) {                           \
+    nome##_no *no = nome##_busca_no(arv, chave);                                       \
+    if(no == NULL) return false;                                                       \
+                                                                                       \
+    Cor cor_movido = no->cor;                                                          \
+    nome##_no *no_substituto;                                                          \
+    nome##_no *pai_substituto = no->pai;                                               \
+    if(no->esq == NULL) {                                                              \
+        no_substituto = no->dir;                                                       \
+        nome##_subtitui_subarv(arv, no, no->dir);                                      \
+    }                                                                                  \
+    else if(no->dir == NULL) {                                                         \
+        no_substituto = no->esq;                                                       \
+        nome##_subtitui_subarv(arv, no, no->esq);                                      \
+    }                                                                                  \
+    else {                                                                             \
+        nome##_no *no_movido = no->dir;                                                \
+        while(no_movido->esq != NULL) no_movido = no_movido->esq;                      \
+        cor_movido = no_movido->cor;                                                   \
+        no_substituto = no_movido->dir;                                                \
+        if(no_movido->pai == no) {                                                     \
+            pai_substituto = no_movido;                                                \
+        }                                                                              \
+        else {                                                                         \
+            pai_substituto = no_movido->pai;                                           \
+            nome##_subtitui_subarv(arv, no_movido, no_movido->dir);                    \
+            no_movido->dir = no->dir;                                                  \
+            no_movido->dir->pai = no_movido;                                           \
+        }                                                                              \
+        nome##_subtitui_subarv(arv, no, no_movido);                                    \
+        no_movido->esq = no->esq;                                                      \
+        no_movido->esq->pai = no_movido;                                               \
+        no_movido->cor = no->cor;                                                      \
+    }                                                                                  \
+                                                                                       \
+    if(cor_movido == PRETO) nome##_remove_fixup(arv, no_substituto, pai_substituto);   \
+    free(no);                                                                          \
+    arv->num_nos--;                                                                    \
+    return true;                                                                       \
+}
+
+#endif
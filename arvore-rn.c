@@ -2,49 +2,196 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
-
-// estrutura de um nó da árvore rubro-negra
-struct no {
-    void *dado;
-    Cor cor;
-    No *dir;
-    No *esq;
-    No *pai;
-};
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef ARV_ESTATISTICAS
+#include <time.h>
+
+// número de conjuntos de contadores de cada árvore. cada thread usa sempre
+// o mesmo conjunto, então threads diferentes (até esse número) nunca
+// escrevem na mesma linha de cache
+#define ARV_EST_FATIAS 16
+#define ARV_EST_LINHA_CACHE 64
+#define ARV_EST_NUM_CONTADORES (sizeof(ArvEstatisticas) / sizeof(uint64_t))
+
+// contadores de uma thread, na mesma ordem dos campos de ArvEstatisticas
+typedef struct {
+    alignas(ARV_EST_LINHA_CACHE) _Atomic uint64_t contadores[ARV_EST_NUM_CONTADORES];
+} FatiaEstatisticas;
+#endif
+
+// arredonda `x` para cima até um múltiplo de `a`
+#define ARV_ARREDONDA(x, a) (((x) + (a) - 1) / (a) * (a))
+
+// posição do tamanho da sub-árvore (ver arv_define_tamanhos) dentro de
+// um nó: logo depois do nó
+#define ARV_DESLOCAMENTO_TAMANHO sizeof(No)
+
+// posição do agregado (ver arv_define_agregado) dentro de um nó: depois
+// do lugar do tamanho, alinhado para qualquer tipo. o lugar do tamanho
+// fica reservado mesmo sem ele, o que não custa nada quando o alinhamento
+// já arredondaria sizeof(No) para cima (40 bytes viram 48 em 64 bits)
+#define ARV_ALINHAMENTO_AGREGADO alignof(max_align_t)
+#define ARV_DESLOCAMENTO_AGREGADO \
+    ARV_ARREDONDA(ARV_DESLOCAMENTO_TAMANHO + sizeof(size_t), ARV_ALINHAMENTO_AGREGADO)
+
+// abaixo desse número de nós, criar as threads do percurso paralelo (e da
+// liberação, ver arv_define_threads_liberacao) custa mais do que dividir
+// o trabalho economiza
+#define ARV_PARALELO_MIN_NOS 16384
+
+// bloco de nós do pool de uma árvore.
+// os blocos formam uma lista encadeada, e os nós ficam logo após o
+// cabeçalho, cada um ocupando `tam_no` bytes do pool
+typedef struct bloco_pool {
+    struct bloco_pool *prox;
+    alignas(max_align_t) unsigned char nos[];
+} BlocoPool;
+
+// pool de nós. normalmente pertence a uma única árvore, mas as árvores
+// criadas por arv_divide continuam usando o pool da árvore dividida
+// (já que seus nós estão nos blocos dele), então o pool conta quantas
+// árvores o usam e só é liberado junto com a última
+typedef struct pool {
+    size_t referencias;
+    size_t nos_por_bloco;
+    // bytes de cada nó, que pode ter o tamanho e um agregado depois do `No`
+    size_t tam_no;
+    // lista de blocos alocados, o primeiro é o bloco atual
+    BlocoPool *blocos;
+    // quantos nós do bloco atual já foram entregues
+    size_t usados_bloco;
+    // lista de nós removidos que podem ser reaproveitados,
+    // encadeados pelo campo `dir`
+    No *livres;
+} Pool;
 
 // estrutura de uma árvore rubro-negra
 struct arvore {
     No *raiz;
-    int num_nos;
+    size_t num_nos;
+    // altura-preta da árvore (número de nós pretos da raiz até um NIL),
+    // atualizada pelas correções da inserção e da remoção
+    int altura_preta;
     Comparador *comp;
     Liberador *libera;
+
+    // na árvore intrusiva, é a posição do nó dentro do dado do
+    // usuário (o nó não é alocado pela árvore), senão é -1
+    ptrdiff_t deslocamento_intrusivo;
+
+    // pool de nós, NULL se cada nó é alocado individualmente
+    // (a árvore foi criada com arv_cria e não construída em lote)
+    Pool *pool;
+
+    // extrator do prefixo guardado em cada nó, NULL se não usa prefixo,
+    // e a posição do prefixo dentro do nó (0 sem prefixo)
+    ExtratorPrefixo *prefixo;
+    size_t deslocamento_prefixo;
+
+    // se true, as inserções recusam valores iguais a um que já está na
+    // árvore (ver arv_define_unicos)
+    bool unicos;
+
+    // se true, cada nó guarda o tamanho da sua sub-árvore
+    // (ver arv_define_tamanhos)
+    bool tamanhos;
+
+    // threads usadas por arv_libera_arvore nas árvores grandes
+    // (ver arv_define_threads_liberacao)
+    int threads_liberacao;
+
+    // bytes de cada nó alocado pela árvore: sizeof(No), ou mais o espaço
+    // do tamanho, do agregado e do prefixo se a árvore tiver
+    // (ver arv_calcula_tam_no)
+    size_t tam_no;
+    // agregado das sub-árvores (ver arv_define_agregado). sem agregado,
+    // `acumula` é NULL
+    size_t tam_agregado;
+    void *agregado_inicial;
+    Acumulador *acumula;
+    Combinador *combina;
+    void *contexto_agregado;
+
+#ifdef ARV_ESTATISTICAS
+    // um conjunto de contadores por fatia (ARV_EST_FATIAS)
+    FatiaEstatisticas *estatisticas;
+#endif
 };
 
-// nó sentinela para representar os nós NIL's da árvore
-// todo nó NIL é preto por propriedade da árvore
-static struct no NIL_SENTINELA;
-static No *NIL = &NIL_SENTINELA;
-static bool nil_inicializado = false;
+// contagem das estatísticas. sem ARV_ESTATISTICAS as macros não geram
+// nenhum código
+#ifdef ARV_ESTATISTICAS
+#define ARV_EST_INDICE(campo) (offsetof(ArvEstatisticas, campo) / sizeof(uint64_t))
+#define ARV_EST_CONTA(arv, campo) arv_est_soma((arv), ARV_EST_INDICE(campo), 1)
+#define ARV_EST_CONTA_N(arv, campo, n) arv_est_soma((arv), ARV_EST_INDICE(campo), (n))
+#define ARV_EST_INICIO(t) uint64_t t = arv_est_agora()
+#define ARV_EST_FIM(arv, op, t) arv_est_latencia((arv), (op), (t))
+
+// próxima fatia a ser entregue para uma thread que ainda não tem fatia
+static atomic_uint arv_est_proxima_fatia;
+
+// função auxiliar que retorna a fatia da thread atual
+static unsigned arv_est_fatia() {
+    static _Thread_local unsigned fatia = 0;
+    static _Thread_local bool tem_fatia = false;
+
+    if(!tem_fatia) {
+        fatia = atomic_fetch_add(&arv_est_proxima_fatia, 1) % ARV_EST_FATIAS;
+        tem_fatia = true;
+    }
+    return fatia;
+}
 
+// função auxiliar que soma `n` ao contador `indice` da fatia da thread.
+// normalmente só a própria thread escreve na sua fatia, então basta ler e
+// escrever o contador (com acessos relaxados, que não geram nenhuma
+// instrução atômica), sem um incremento atômico. com mais threads que
+// fatias, incrementos simultâneos na mesma fatia podem se perder
+static inline void arv_est_soma(Arvore *arv, size_t indice, uint64_t n) {
+    _Atomic uint64_t *contador = &arv->estatisticas[arv_est_fatia()].contadores[indice];
+    atomic_store_explicit(contador, atomic_load_explicit(contador, memory_order_relaxed) + n,
+                          memory_order_relaxed);
+}
 
-//// --- criação / destruição ---
+static inline uint64_t arv_est_agora() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
 
-// função auxiliar para inicializar o nó
-// sentinela NIL
-static void arv_inicializa_nil() {
-    if(!nil_inicializado) {
-        NIL->cor = PRETO;
-        NIL->dado = NULL;
-        NIL->pai = NIL;
-        NIL->esq = NIL;
-        NIL->dir = NIL;
-        nil_inicializado = true;
-    }
+// função auxiliar que conta uma operação `op` que começou em `inicio`
+// e termina agora, no histograma de latências
+static inline void arv_est_latencia(Arvore *arv, ArvOperacao op, uint64_t inicio) {
+    uint64_t ns = arv_est_agora() - inicio;
+
+    // faixa = log2(ns), limitada à última faixa
+    int faixa = 63 - __builtin_clzll(ns | 1);
+    if(faixa >= ARV_FAIXAS_LATENCIA) faixa = ARV_FAIXAS_LATENCIA - 1;
+
+    arv_est_soma(arv, ARV_EST_INDICE(operacoes) + op, 1);
+    arv_est_soma(arv, ARV_EST_INDICE(latencias) + (size_t)op * ARV_FAIXAS_LATENCIA + faixa, 1);
 }
+#else
+#define ARV_EST_CONTA(arv, campo) ((void)0)
+#define ARV_EST_CONTA_N(arv, campo, n) ((void)0)
+#define ARV_EST_INICIO(t) ((void)0)
+#define ARV_EST_FIM(arv, op, t) ((void)0)
+#endif
 
-Arvore* arv_cria(Comparador *comp, Liberador *libera) {
-    arv_inicializa_nil();
+// os nós NIL's da árvore são representados por ponteiros NULL, e não
+// por um nó sentinela compartilhado. assim nenhuma operação escreve em
+// memória global, e árvores independentes podem ser usadas em threads
+// diferentes sem nenhuma sincronização.
+// todo nó NIL é preto por propriedade da árvore (ver arv_busca_cor).
 
+
+//// --- criação / destruição ---
+
+Arvore* arv_cria(Comparador *comp, Liberador *libera) {
     // sem função de comparação não tem como a árvore se organizar
     if(comp == NULL) return NULL;
 
@@ -54,14 +201,83 @@ Arvore* arv_cria(Comparador *comp, Liberador *libera) {
     }
     
     // raiz de uma árvore recém criada aponta para NIL
-    nova_arvore->raiz = NIL; 
+    nova_arvore->raiz = NULL;
     nova_arvore->num_nos = 0;
+    nova_arvore->altura_preta = 0;
     nova_arvore->comp = comp;
     nova_arvore->libera = libera;
+    nova_arvore->deslocamento_intrusivo = -1;
+
+    // por padrão cada nó é alocado individualmente
+    nova_arvore->pool = NULL;
+    nova_arvore->prefixo = NULL;
+    nova_arvore->deslocamento_prefixo = 0;
+    nova_arvore->unicos = false;
+    nova_arvore->tamanhos = false;
+    nova_arvore->threads_liberacao = 1;
+
+    nova_arvore->tam_no = sizeof(No);
+    nova_arvore->tam_agregado = 0;
+    nova_arvore->agregado_inicial = NULL;
+    nova_arvore->acumula = NULL;
+    nova_arvore->combina = NULL;
+    nova_arvore->contexto_agregado = NULL;
+
+#ifdef ARV_ESTATISTICAS
+    nova_arvore->estatisticas = (FatiaEstatisticas*)aligned_alloc(ARV_EST_LINHA_CACHE,
+                                    ARV_EST_FATIAS * sizeof(FatiaEstatisticas));
+    if(nova_arvore->estatisticas == NULL) {
+        free(nova_arvore);
+        return NULL;
+    }
+    memset(nova_arvore->estatisticas, 0, ARV_EST_FATIAS * sizeof(FatiaEstatisticas));
+#endif
     
     return nova_arvore;
 }
 
+// função auxiliar que cria um pool vazio, usado por uma árvore
+static Pool* arv_pool_cria(size_t nos_por_bloco, size_t tam_no) {
+    Pool *pool = (Pool*)malloc(sizeof(Pool));
+    if(pool == NULL) return NULL;
+
+    // o primeiro bloco só é alocado na primeira inserção
+    pool->referencias = 1;
+    pool->nos_por_bloco = nos_por_bloco;
+    pool->tam_no = tam_no;
+    pool->blocos = NULL;
+    pool->usados_bloco = 0;
+    pool->livres = NULL;
+
+    return pool;
+}
+
+Arvore* arv_cria_com_pool(Comparador *comp, Liberador *libera, size_t nos_por_bloco) {
+    // um bloco precisa ter pelo menos um nó
+    if(nos_por_bloco == 0) return NULL;
+
+    Arvore *nova_arvore = arv_cria(comp, libera);
+    if(nova_arvore == NULL) return NULL;
+
+    nova_arvore->pool = arv_pool_cria(nos_por_bloco, nova_arvore->tam_no);
+    if(nova_arvore->pool == NULL) {
+        arv_libera_arvore(nova_arvore);
+        return NULL;
+    }
+
+    return nova_arvore;
+}
+
+Arvore* arv_cria_intrusiva(Comparador *comp, Liberador *libera, size_t deslocamento) {
+    Arvore *nova_arvore = arv_cria(comp, libera);
+    if(nova_arvore == NULL) return NULL;
+
+    // os nós já vêm dentro dos dados inseridos, a árvore nunca aloca nós
+    nova_arvore->deslocamento_intrusivo = (ptrdiff_t)deslocamento;
+
+    return nova_arvore;
+}
+
 // função auxiliar para liberar os nós a partir de `no`
 // recursivamente
 static void arv_libera_no(No *no, Liberador *libera) {
@@ -75,15 +291,233 @@ static void arv_libera_no(No *no, Liberador *libera) {
     free(no);
 }
 
-void arv_libera_arvore(Arvore *arv) {
-    if(arv == NULL) return;
+// função auxiliar para liberar apenas os dados dos nós a partir
+// de `no` recursivamente, os nós pertencem ao pool e são liberados
+// junto com os blocos
+static void arv_libera_dados(No *no, Liberador *libera) {
+    if(arv_no_vazio(no)) return;
+
+    arv_libera_dados(no->esq, libera);
+    arv_libera_dados(no->dir, libera);
+
+    libera(no->dado);
+}
+
+// função auxiliar para devolver os nós a partir de `no` para a lista de
+// livres do pool recursivamente, liberando os dados se tiver liberador.
+// usada quando o pool continua sendo usado por outra árvore
+static void arv_devolve_nos(No *no, Pool *pool, Liberador *libera) {
+    if(arv_no_vazio(no)) return;
+
+    arv_devolve_nos(no->esq, pool, libera);
+    arv_devolve_nos(no->dir, pool, libera);
+
+    if(libera != NULL) libera(no->dado);
+    no->dir = pool->livres;
+    pool->livres = no;
+}
+
+// função auxiliar que libera todos os blocos de um pool e o próprio pool
+static void arv_pool_libera(Pool *pool) {
+    BlocoPool *bloco = pool->blocos;
+    while(bloco != NULL) {
+        BlocoPool *prox = bloco->prox;
+        free(bloco);
+        bloco = prox;
+    }
+    free(pool);
+}
 
-    // libera todos os nós partindo da raiz da árvore
-    arv_libera_no(arv->raiz, arv->libera);
+// função auxiliar que libera toda a árvore só pela thread que chamou
+static void arv_libera_sequencial(Arvore *arv) {
+    if(arv->deslocamento_intrusivo >= 0) {
+        // os nós fazem parte dos dados, basta liberar os dados
+        if(arv->libera != NULL) arv_libera_dados(arv->raiz, arv->libera);
+    }
+    else if(arv->pool != NULL && arv->pool->referencias > 1) {
+        // outra árvore ainda usa o pool, os nós só voltam para a lista de livres
+        arv_devolve_nos(arv->raiz, arv->pool, arv->libera);
+        arv->pool->referencias--;
+    }
+    else if(arv->pool != NULL) {
+        // os nós não precisam ser liberados um a um, só os dados
+        // (se a árvore tiver liberador) e depois cada bloco do pool
+        if(arv->libera != NULL) arv_libera_dados(arv->raiz, arv->libera);
+        arv_pool_libera(arv->pool);
+    }
+    else {
+        // libera todos os nós partindo da raiz da árvore
+        arv_libera_no(arv->raiz, arv->libera);
+    }
     // libera o descritor da árvore
+#ifdef ARV_ESTATISTICAS
+    free(arv->estatisticas);
+#endif
+    free(arv->agregado_inicial);
     free(arv);
 }
 
+void arv_libera_arvore(Arvore *arv) {
+    if(arv == NULL) return;
+
+    // árvores pequenas não compensam a criação das threads
+    if(arv->threads_liberacao != 1 && arv->num_nos >= ARV_PARALELO_MIN_NOS) {
+        arv_libera_arvore_paralelo(arv, arv->threads_liberacao);
+        return;
+    }
+    arv_libera_sequencial(arv);
+}
+
+// função auxiliar que recalcula a posição do prefixo dentro de um nó e o
+// tamanho dos nós da árvore, a partir da sua configuração. o tamanho da
+// sub-árvore fica logo depois do nó (ARV_DESLOCAMENTO_TAMANHO), o agregado
+// depois dele (ARV_DESLOCAMENTO_AGREGADO) e o prefixo depois do agregado,
+// então uma árvore sem os três usa nós de sizeof(No) bytes
+static void arv_calcula_tam_no(Arvore *arv) {
+    size_t fim = sizeof(No);
+    if(arv->tamanhos) fim = ARV_DESLOCAMENTO_TAMANHO + sizeof(size_t);
+    if(arv->acumula != NULL) fim = ARV_DESLOCAMENTO_AGREGADO + arv->tam_agregado;
+
+    arv->deslocamento_prefixo = 0;
+    if(arv->prefixo != NULL) {
+        arv->deslocamento_prefixo = ARV_ARREDONDA(fim, alignof(uint64_t));
+        fim = arv->deslocamento_prefixo + sizeof(uint64_t);
+    }
+
+    // com agregado, o tamanho mantém alinhado o agregado de todos os nós
+    // de um bloco do pool
+    arv->tam_no = ARV_ARREDONDA(fim, arv->acumula != NULL ? ARV_ALINHAMENTO_AGREGADO : alignof(No));
+    if(arv->pool != NULL) arv->pool->tam_no = arv->tam_no;
+}
+
+// função auxiliar que retorna true se o tamanho dos nós da árvore ainda
+// pode mudar: ela não é intrusiva (o nó está dentro do dado, sem espaço
+// depois dele) e o seu pool, se tiver, ainda não tem nenhum nó
+static bool arv_pode_mudar_tam_no(Arvore *arv) {
+    if(arv->deslocamento_intrusivo >= 0) return false;
+
+    Pool *pool = arv->pool;
+    return pool == NULL || (pool->blocos == NULL && pool->livres == NULL && pool->referencias == 1);
+}
+
+bool arv_define_prefixo(Arvore *arv, ExtratorPrefixo *extrator) {
+    if(arv == NULL) return false;
+    // os nós já inseridos não têm o prefixo calculado
+    if(!arv_vazia(arv)) return false;
+    // ligar ou desligar o prefixo muda o tamanho dos nós
+    if((extrator != NULL) != (arv->prefixo != NULL) && !arv_pode_mudar_tam_no(arv)) return false;
+
+    arv->prefixo = extrator;
+    arv_calcula_tam_no(arv);
+    return true;
+}
+
+bool arv_define_unicos(Arvore *arv, bool unicos) {
+    if(arv == NULL) return false;
+    // a árvore pode já ter valores repetidos
+    if(!arv_vazia(arv)) return false;
+
+    arv->unicos = unicos;
+    return true;
+}
+
+bool arv_define_tamanhos(Arvore *arv, bool tamanhos) {
+    if(arv == NULL) return false;
+    // os nós já inseridos não têm o tamanho calculado
+    if(!arv_vazia(arv)) return false;
+    // o tamanho fica dentro dos nós, que não podem mudar de tamanho
+    if(tamanhos != arv->tamanhos && !arv_pode_mudar_tam_no(arv)) return false;
+
+    arv->tamanhos = tamanhos;
+    arv_calcula_tam_no(arv);
+    return true;
+}
+
+bool arv_define_agregado(Arvore *arv, size_t tam_agregado, const void *inicial,
+                         Acumulador *acumula, Combinador *combina, void *contexto) {
+    if(arv == NULL) return false;
+    // os nós já inseridos não têm o agregado calculado
+    if(!arv_vazia(arv)) return false;
+    // o agregado fica dentro dos nós, que não podem mudar de tamanho
+    if(!arv_pode_mudar_tam_no(arv)) return false;
+
+    void *novo_inicial = NULL;
+    if(acumula != NULL) {
+        if(combina == NULL || inicial == NULL || tam_agregado == 0) return false;
+
+        novo_inicial = malloc(tam_agregado);
+        if(novo_inicial == NULL) return false;
+        memcpy(novo_inicial, inicial, tam_agregado);
+    }
+    else {
+        // `acumula` NULL desliga o agregado
+        tam_agregado = 0;
+        combina = NULL;
+        contexto = NULL;
+    }
+
+    free(arv->agregado_inicial);
+    arv->agregado_inicial = novo_inicial;
+    arv->tam_agregado = tam_agregado;
+    arv->acumula = acumula;
+    arv->combina = combina;
+    arv->contexto_agregado = contexto;
+    arv_calcula_tam_no(arv);
+
+    return true;
+}
+
+uint64_t arv_prefixo_str(void *dado) {
+    const unsigned char *str = (const unsigned char*)dado;
+    uint64_t prefixo = 0;
+
+    // strcmp compara os bytes como unsigned char, então a ordem dos
+    // inteiros big-endian é a mesma. a string termina no '\0', que já
+    // é o menor byte, então o resto é completado com zeros
+    int i = 0;
+    for(; i < 8 && str[i] != '\0'; i++) {
+        prefixo = (prefixo << 8) | str[i];
+    }
+    for(; i < 8; i++) {
+        prefixo <<= 8;
+    }
+
+    return prefixo;
+}
+
+// função auxiliar que retorna o prefixo de `v` pelo extrator da árvore
+static inline uint64_t arv_prefixo_de(Arvore *arv, void *v) {
+    if(arv->prefixo == NULL) return 0;
+    return arv->prefixo(v);
+}
+
+// função auxiliar que retorna o prefixo guardado no nó `no` de uma árvore
+// com prefixo
+static inline uint64_t* arv_prefixo_no(Arvore *arv, No *no) {
+    return (uint64_t*)((char*)no + arv->deslocamento_prefixo);
+}
+
+// função auxiliar que guarda no nó `no` o prefixo do seu dado, se a
+// árvore usar prefixo
+static inline void arv_guarda_prefixo(Arvore *arv, No *no) {
+    if(arv->prefixo != NULL) *arv_prefixo_no(arv, no) = arv->prefixo(no->dado);
+}
+
+// função auxiliar que compara o valor `v`, de prefixo `prefixo_v`, com o
+// dado do nó `no`, como o comparador da árvore. se os prefixos forem
+// diferentes, o resultado sai deles sem acessar o dado do nó
+static inline int arv_compara(Arvore *arv, void *v, uint64_t prefixo_v, No *no) {
+    if(arv->prefixo != NULL) {
+        uint64_t prefixo_no = *arv_prefixo_no(arv, no);
+        if(prefixo_v != prefixo_no) {
+            ARV_EST_CONTA(arv, comparacoes_prefixo);
+            return prefixo_v < prefixo_no ? -1 : 1;
+        }
+    }
+    ARV_EST_CONTA(arv, comparacoes);
+    return arv->comp(v, no->dado);
+}
+
 
 
 //// --- inserção/remoção ---
@@ -98,7 +532,7 @@ static No* arv_busca_avo(No *no) {
     }
 
     // se chegou aqui, ou `no` é NIL ou não tem pai
-    return NIL;
+    return NULL;
 }
 
 // função auxiliar que busca o tio do nó `no`
@@ -109,7 +543,7 @@ static No* arv_busca_tio(No *no) {
 
     // se não tem avô, é impossível ter tio
     if(arv_no_vazio(avo)) {
-        return NIL;
+        return NULL;
     }
     // se o pai for o filho esquerdo de seu avô,
     // seu tio só pode ser o filho direito
@@ -122,6 +556,64 @@ static No* arv_busca_tio(No *no) {
     }
 }
 
+// função auxiliar que retorna o tamanho da sub-árvore guardado depois do
+// nó `no`
+static inline size_t* arv_tamanho_de(No *no) {
+    return (size_t*)((char*)no + ARV_DESLOCAMENTO_TAMANHO);
+}
+
+// função auxiliar que retorna o agregado guardado depois do nó `no`
+static inline void* arv_agregado_de(No *no) {
+    return (char*)no + ARV_DESLOCAMENTO_AGREGADO;
+}
+
+// função auxiliar que recalcula o agregado da sub-árvore de `no`, se a
+// árvore tiver agregado: o agregado do filho esquerdo (ou o inicial),
+// acumulado com o dado de `no` e depois combinado com o do filho direito
+static void arv_atualiza_agregado(Arvore *arv, No *no) {
+    if(arv->acumula == NULL) return;
+
+    void *agregado = arv_agregado_de(no);
+    const void *origem = arv_no_vazio(no->esq) ? arv->agregado_inicial : arv_agregado_de(no->esq);
+    memcpy(agregado, origem, arv->tam_agregado);
+
+    arv->acumula(agregado, no->dado, arv->contexto_agregado);
+    if(!arv_no_vazio(no->dir)) {
+        arv->combina(agregado, arv_agregado_de(no->dir), arv->contexto_agregado);
+    }
+}
+
+// função auxiliar que recalcula o tamanho da sub-árvore de `no` a partir
+// dos tamanhos das sub-árvores de seus filhos, e o agregado, se a árvore
+// os tiver
+static void arv_atualiza_tamanho(Arvore *arv, No *no) {
+    if(arv->tamanhos) {
+        *arv_tamanho_de(no) = 1 + arv_busca_tamanho(no->esq) + arv_busca_tamanho(no->dir);
+    }
+    arv_atualiza_agregado(arv, no);
+}
+
+// função auxiliar que recalcula o tamanho da sub-árvore de `no` e de
+// todos os seus ancestrais, até a raiz. sem tamanhos e sem agregado não
+// há nada a recalcular, e a subida não é feita
+static void arv_atualiza_tamanho_ate_raiz(Arvore *arv, No *no) {
+    if(!arv->tamanhos && arv->acumula == NULL) return;
+
+    while(!arv_no_vazio(no)) {
+        arv_atualiza_tamanho(arv, no);
+        no = no->pai;
+    }
+}
+
+// função auxiliar para a rotação: `destino` passa a ter a sub-árvore
+// inteira que era de `origem`, então fica com o tamanho e o agregado dela
+static void arv_herda_subarvore(Arvore *arv, No *destino, No *origem) {
+    if(arv->tamanhos) *arv_tamanho_de(destino) = *arv_tamanho_de(origem);
+    if(arv->acumula != NULL) {
+        memcpy(arv_agregado_de(destino), arv_agregado_de(origem), arv->tam_agregado);
+    }
+}
+
 // função auxiliar para fazer a rotação à esquerda do
 // nó `no`
 static void arv_rotacao_esquerda(Arvore *arv, No *no) {
@@ -131,6 +623,7 @@ static void arv_rotacao_esquerda(Arvore *arv, No *no) {
     // se o filho a direita de `no` for NIL, é impossível
     // rotacionar à esquerda
     if(arv_no_vazio(dir)) return;
+    ARV_EST_CONTA(arv, rotacoes);
 
     // a subárvore esquerda do filho a direita de `no` é a nova
     // subárvore a direita de `no`
@@ -168,6 +661,11 @@ static void arv_rotacao_esquerda(Arvore *arv, No *no) {
     dir->esq = no;
     // e atualiza o pai de `no` para `dir`.
     no->pai = dir;
+
+    // `dir` fica com a sub-árvore inteira que era de `no`, e `no`
+    // perde o filho direito e a sub-árvore direita dele
+    arv_herda_subarvore(arv, dir, no);
+    arv_atualiza_tamanho(arv, no);
 }
 
 // função auxiliar para fazer a rotação à direita do
@@ -179,6 +677,7 @@ static void arv_rotacao_direita(Arvore *arv, No *no) {
     // se o filho a esquerda de `no` for NIL, é impossível
     // rotacionar à direita
     if(arv_no_vazio(esq)) return;
+    ARV_EST_CONTA(arv, rotacoes);
 
     // a sub-árvore à direita de `esq` é o novo filho esquerdo de `no`
     no->esq = esq->dir;
@@ -212,17 +711,25 @@ static void arv_rotacao_direita(Arvore *arv, No *no) {
     esq->dir = no;
     // atualiza o ponteiro pai de `no` para ser o `esq`
     no->pai = esq;
+
+    // `esq` fica com a sub-árvore inteira que era de `no`, e `no`
+    // perde o filho esquerdo e a sub-árvore esquerda dele
+    arv_herda_subarvore(arv, esq, no);
+    arv_atualiza_tamanho(arv, no);
 }
 
 
 // função auxiliar para corrigir a árvore,
 // subindo a partir do novo nó inserido,
 // rotacionando e repintando nós para não 
-// quebrar nenhuma propriedade
-static void arv_insere_fixup(Arvore *arv, No *no) {
+// quebrar nenhuma propriedade.
+// retorna true se a raiz terminou vermelha e precisou ser repintada de
+// preto, ou seja, se a altura-preta da árvore aumentou
+static bool arv_insere_fixup(Arvore *arv, No *no) {
     // é necessário corrigir apenas se o pai do novo nó for vermelho.
     // se for preto (incluindo NIL), a árvore não quebra nenhuma propriedade.
-    while(no->pai->cor == VERMELHO) {
+    while(arv_busca_cor(no->pai) == VERMELHO) {
+        ARV_EST_CONTA(arv, iteracoes_fixup_insercao);
         No* avo = arv_busca_avo(no);
         No* tio = arv_busca_tio(no);
 
@@ -233,7 +740,7 @@ static void arv_insere_fixup(Arvore *arv, No *no) {
             // vermelho. porém o avô vermelho pode ser a raíz ou quebrar
             // a propriedade de seus filhos serem pretos, deve-se continuar
             // o fixup com agora `no` sendo o avô.
-            if(tio->cor == VERMELHO) {
+            if(arv_busca_cor(tio) == VERMELHO) {
                 // repinta o pai, o tio e o avô.
                 no->pai->cor = PRETO;
                 tio->cor = PRETO;
@@ -274,7 +781,7 @@ static void arv_insere_fixup(Arvore *arv, No *no) {
             // vermelho. porém o avô vermelho pode ser a raíz ou quebrar
             // a propriedade de seus filhos serem pretos, deve-se continuar
             // o fixup com agora `no` sendo o avô.
-            if(tio->cor == VERMELHO) {
+            if(arv_busca_cor(tio) == VERMELHO) {
                 // repinta o pai, o tio e o avô.
                 no->pai->cor = PRETO;
                 tio->cor = PRETO;
@@ -318,46 +825,121 @@ static void arv_insere_fixup(Arvore *arv, No *no) {
     // repintado de preto já que é a nova raíz da árvore
 
     // (nesses casos só pinta a raiz de preto para garantir a propriedade)
+    bool repintou = arv->raiz->cor == VERMELHO;
     arv->raiz->cor = PRETO;
+    return repintou;
+}
+
+// função auxiliar que retorna o `i`-ésimo nó do bloco `bloco` do pool
+static inline No* arv_pool_no(Pool *pool, BlocoPool *bloco, size_t i) {
+    return (No*)(bloco->nos + i * pool->tam_no);
+}
+
+// função auxiliar que entrega um nó do pool da árvore.
+// reaproveita os nós removidos antes de usar o resto do bloco atual,
+// e só aloca um bloco novo quando o atual estiver cheio
+static No* arv_pool_aloca(Pool *pool) {
+    if(pool->livres != NULL) {
+        No *no = pool->livres;
+        pool->livres = no->dir;
+        return no;
+    }
+
+    if(pool->blocos == NULL || pool->usados_bloco == pool->nos_por_bloco) {
+        BlocoPool *bloco = (BlocoPool*)malloc(sizeof(BlocoPool) + pool->nos_por_bloco * pool->tam_no);
+        if(bloco == NULL) return NULL;
+
+        bloco->prox = pool->blocos;
+        pool->blocos = bloco;
+        pool->usados_bloco = 0;
+    }
+
+    return arv_pool_no(pool, pool->blocos, pool->usados_bloco++);
+}
+
+// função auxiliar para liberar um nó da árvore, se a árvore
+// tem pool o nó volta para a lista de livres
+static void arv_libera_no_unico(Arvore *arv, No *no) {
+    if(arv->deslocamento_intrusivo >= 0) {
+        // o nó faz parte do dado, não tem o que liberar
+        return;
+    }
+    ARV_EST_CONTA(arv, nos_liberados);
+    if(arv->pool != NULL) {
+        no->dir = arv->pool->livres;
+        arv->pool->livres = no;
+    }
+    else {
+        free(no);
+    }
 }
 
-// função auxiliar para alocar o novo nó
-static No* arv_cria_no(void *valor, Cor cor) {
-    No *novo_no = (No*)malloc(sizeof(No));
+// função auxiliar para alocar o novo nó.
+// na árvore intrusiva o nó é o que está embutido no próprio dado
+static No* arv_cria_no(Arvore *arv, void *valor, Cor cor) {
+    No *novo_no;
+    if(arv->deslocamento_intrusivo >= 0) {
+        novo_no = (No*)((char*)valor + arv->deslocamento_intrusivo);
+    }
+    else if(arv->pool != NULL) {
+        novo_no = arv_pool_aloca(arv->pool);
+    }
+    else {
+        novo_no = (No*)malloc(arv->tam_no);
+    }
     if(novo_no == NULL) return NULL;
+    if(arv->deslocamento_intrusivo < 0) ARV_EST_CONTA(arv, nos_alocados);
 
     novo_no->dado = valor;
     novo_no->cor = cor;
-    novo_no->pai = NIL;
-    novo_no->dir = NIL;
-    novo_no->esq = NIL;
+    novo_no->pai = NULL;
+    novo_no->dir = NULL;
+    novo_no->esq = NULL;
+    if(arv->tamanhos) *arv_tamanho_de(novo_no) = 1;
+    arv_guarda_prefixo(arv, novo_no);
+    arv_atualiza_agregado(arv, novo_no);
 
     return novo_no;
 }
 
-bool arv_insere_no(Arvore *arv, void *v) {
-    if(arv == NULL) return false;
-    if(v == NULL) return false;
-
-    // aloca o novo nó com o ponteiro para `v`
-    // todo nó a ser inserido é pintado de vermelho
-    // inicialmente, com possibilidade de ser repintado
-    // de preto para não quebrar nenhuma propriedade
-    No *novo_no = arv_cria_no(v, VERMELHO);
-    if(novo_no == NULL) return false;
-
-    No *pai = NIL;
-    No *atual = arv->raiz;
+// função auxiliar que insere o valor `v` descendo a partir do nó `inicio`
+// (que deve ser a raiz, ou um nó cuja sub-árvore seja o lugar certo de `v`)
+// e retorna o novo nó, ou NULL em caso de falha de alocação.
+// se `igual` não for NULL, um nó igual a `v` encontrado na descida é
+// guardado nele e nada é inserido (a função também retorna NULL)
+static No* arv_insere_a_partir(Arvore *arv, No *inicio, void *v, No **igual) {
+    uint64_t prefixo_v = arv_prefixo_de(arv, v);
+    if(igual != NULL) *igual = NULL;
+
+    No *pai = NULL;
+    No *atual = inicio;
+    bool esquerda = false;
     // procura pela posição de inserção do novo nó
     while(!arv_no_vazio(atual)) {
         pai = atual;
-        if(arv->comp(novo_no->dado, atual->dado) < 0) {
+        int resultado_comp = arv_compara(arv, v, prefixo_v, atual);
+        // a descida para no primeiro nó igual, se o chamador quiser
+        if(resultado_comp == 0 && igual != NULL) {
+            *igual = atual;
+            return NULL;
+        }
+
+        esquerda = resultado_comp < 0;
+        if(esquerda) {
             atual = atual->esq;
         } 
         else {
             atual = atual->dir;
         }
     }
+
+    // aloca o novo nó com o ponteiro para `v` só depois da descida, já que
+    // ela pode terminar em um nó igual
+    // todo nó a ser inserido é pintado de vermelho
+    // inicialmente, com possibilidade de ser repintado
+    // de preto para não quebrar nenhuma propriedade
+    No *novo_no = arv_cria_no(arv, v, VERMELHO);
+    if(novo_no == NULL) return NULL;
     
     // correção dos ponteiros para inserção do novo nó
     novo_no->pai = pai;
@@ -366,19 +948,216 @@ bool arv_insere_no(Arvore *arv, void *v) {
     if(arv_no_vazio(pai)) {
         arv->raiz = novo_no;
     }
-    else if(arv->comp(novo_no->dado, pai->dado) < 0) {
+    // o lado já foi decidido pela última comparação da descida
+    else if(esquerda) {
         pai->esq = novo_no;
     } 
     else {
         pai->dir = novo_no;
     }
 
+    // todos os ancestrais do novo nó ganharam um nó na sub-árvore
+    arv_atualiza_tamanho_ate_raiz(arv, pai);
+
     // chama a função auxiliar para corrigir a árvore
     // para não quebrar nenhuma propriedade
-    arv_insere_fixup(arv, novo_no);
+    // se a raiz foi repintada de preto, todos os caminhos ganharam um nó preto
+    if(arv_insere_fixup(arv, novo_no)) arv->altura_preta++;
 
     arv->num_nos++;
-    return true;
+    return novo_no;
+}
+
+bool arv_insere_no(Arvore *arv, void *v) {
+    if(arv == NULL) return false;
+    if(v == NULL) return false;
+
+    ARV_EST_INICIO(inicio);
+    No *igual;
+    bool inseriu = arv_insere_a_partir(arv, arv->raiz, v, arv->unicos ? &igual : NULL) != NULL;
+    ARV_EST_FIM(arv, ARV_OP_INSERE, inicio);
+    return inseriu;
+}
+
+No* arv_insere_ou_busca(Arvore *arv, void *v) {
+    if(arv == NULL) return NULL;
+    if(v == NULL) return NULL;
+
+    ARV_EST_INICIO(inicio);
+    No *igual;
+    No *no = arv_insere_a_partir(arv, arv->raiz, v, &igual);
+    ARV_EST_FIM(arv, ARV_OP_INSERE, inicio);
+
+    // em caso de falha de alocação os dois são NULL
+    return no != NULL ? no : igual;
+}
+
+// função auxiliar que troca o dado do nó `no` por `v`, igual a ele pelo
+// comparador, liberando o dado antigo se a árvore tiver liberador.
+// na árvore intrusiva o nó faz parte do dado, então o nó embutido em `v`
+// é que ocupa o lugar de `no` na árvore
+static void arv_troca_dado(Arvore *arv, No *no, void *v) {
+    void *antigo = no->dado;
+    if(antigo == v) return;
+
+    if(arv->deslocamento_intrusivo >= 0) {
+        No *novo_no = (No*)((char*)v + arv->deslocamento_intrusivo);
+        *novo_no = *no;
+
+        if(arv_no_vazio(no->pai)) {
+            arv->raiz = novo_no;
+        }
+        else if(no == no->pai->esq) {
+            no->pai->esq = novo_no;
+        }
+        else {
+            no->pai->dir = novo_no;
+        }
+        if(!arv_no_vazio(no->esq)) no->esq->pai = novo_no;
+        if(!arv_no_vazio(no->dir)) no->dir->pai = novo_no;
+        no = novo_no;
+    }
+
+    no->dado = v;
+    arv_guarda_prefixo(arv, no);
+    // o novo dado pode mudar o agregado de todos os ancestrais
+    if(arv->acumula != NULL) arv_atualiza_tamanho_ate_raiz(arv, no);
+
+    if(arv->libera != NULL) arv->libera(antigo);
+}
+
+bool arv_atualiza(Arvore *arv, void *v) {
+    if(arv == NULL) return false;
+    if(v == NULL) return false;
+
+    ARV_EST_INICIO(inicio);
+    No *igual;
+    bool ok = arv_insere_a_partir(arv, arv->raiz, v, &igual) != NULL;
+    if(igual != NULL) {
+        arv_troca_dado(arv, igual, v);
+        ok = true;
+    }
+    ARV_EST_FIM(arv, ARV_OP_INSERE, inicio);
+
+    return ok;
+}
+
+// função auxiliar para ordenar `dados[ini..fim)` com o comparador
+// da árvore (merge sort estável), usando `temp` como espaço auxiliar
+static void arv_ordena_dados(Arvore *arv, void **dados, void **temp, size_t ini, size_t fim) {
+    if(fim - ini < 2) return;
+
+    size_t meio = ini + (fim - ini) / 2;
+    arv_ordena_dados(arv, dados, temp, ini, meio);
+    arv_ordena_dados(arv, dados, temp, meio, fim);
+
+    // as duas metades já estão em ordem entre si
+    ARV_EST_CONTA(arv, comparacoes);
+    if(arv->comp(dados[meio - 1], dados[meio]) <= 0) return;
+
+    size_t i = ini, j = meio, k = ini;
+    while(i < meio && j < fim) {
+        ARV_EST_CONTA(arv, comparacoes);
+        if(arv->comp(dados[j], dados[i]) < 0) {
+            temp[k++] = dados[j++];
+        }
+        else {
+            temp[k++] = dados[i++];
+        }
+    }
+    while(i < meio) temp[k++] = dados[i++];
+    while(j < fim) temp[k++] = dados[j++];
+
+    memcpy(&dados[ini], &temp[ini], (fim - ini) * sizeof(void*));
+}
+
+// função auxiliar que, a partir do último nó inserido `ultimo`, sobe até
+// o primeiro ancestral cuja sub-árvore é o lugar certo de `v`, sabendo que
+// `v` não é menor que o dado de `ultimo`.
+// a sub-árvore de um filho direito não tem limite superior além do limite
+// do seu pai, então só é preciso comparar ao subir de um filho esquerdo
+static No* arv_sobe_dedo(Arvore *arv, No *ultimo, void *v) {
+    No *atual = ultimo;
+    uint64_t prefixo_v = arv_prefixo_de(arv, v);
+
+    while(!arv_no_vazio(atual->pai)) {
+        if(atual == atual->pai->esq && arv_compara(arv, v, prefixo_v, atual->pai) < 0) {
+            break;
+        }
+        atual = atual->pai;
+    }
+
+    return atual;
+}
+
+size_t arv_insere_lote(Arvore *arv, void **dados, size_t n) {
+    if(arv == NULL || dados == NULL || n == 0) return 0;
+
+    for(size_t i = 0; i < n; i++) {
+        if(dados[i] == NULL) return 0;
+    }
+
+    void **temp = (void**)malloc(n * sizeof(void*));
+    if(temp == NULL) return 0;
+    arv_ordena_dados(arv, dados, temp, 0, n);
+
+    // com valores únicos, os dados recusados vão para `temp`. os repetidos
+    // do próprio vetor ficaram vizinhos na ordenação, e só o primeiro de
+    // cada grupo continua em `dados[0..m)`
+    size_t recusados = 0;
+    size_t m = n;
+    if(arv->unicos) {
+        m = 0;
+        for(size_t i = 0; i < n; i++) {
+            ARV_EST_CONTA(arv, comparacoes);
+            if(m > 0 && arv->comp(dados[m - 1], dados[i]) == 0) {
+                temp[recusados++] = dados[i];
+            }
+            else {
+                dados[m++] = dados[i];
+            }
+        }
+    }
+
+    // se a árvore está vazia, dá para construir direto
+    // a partir do vetor ordenado
+    size_t inseridos = 0;
+    size_t i = 0;
+    if(arv_vazia(arv) && arv_constroi_ordenado(arv, dados, m)) {
+        inseridos = i = m;
+    }
+
+    // senão, cada dado é inserido descendo a partir de um ancestral do
+    // último inserido (o "dedo"), ao invés de descer desde a raiz.
+    // como os dados estão em ordem, dados vizinhos ficam próximos na árvore.
+    // os inseridos vão sendo juntados no começo do vetor
+    No *ultimo = NULL;
+    for(; i < m; i++) {
+        No *inicio = arv->raiz;
+        if(ultimo != NULL) {
+            inicio = arv_sobe_dedo(arv, ultimo, dados[i]);
+        }
+
+        No *igual;
+        No *novo_no = arv_insere_a_partir(arv, inicio, dados[i], arv->unicos ? &igual : NULL);
+        if(novo_no == NULL) {
+            if(arv->unicos && igual != NULL) {
+                temp[recusados++] = dados[i];
+                continue;
+            }
+            break;
+        }
+        dados[inseridos++] = dados[i];
+        ultimo = novo_no;
+    }
+
+    // depois dos inseridos vêm os recusados e os que não chegaram a ser
+    // inseridos por falha de alocação
+    memmove(&dados[inseridos + recusados], &dados[i], (m - i) * sizeof(void*));
+    memcpy(&dados[inseridos], temp, recusados * sizeof(void*));
+    free(temp);
+
+    return inseridos;
 }
 
 
@@ -405,38 +1184,44 @@ static void arv_subtitui_subarv(Arvore *arv, No *sub1, No *sub2) {
 
     // agora, atualiza o pai de `sub2`
     // o novo pai de `sub2` é o antigo pai de `sub1`
-
-    // importante, mesmo que `sub2` seja um NIL, porque no fixup da remoção
-    // podemos precisar navegar para cima de `sub2`
-    // como o pai de um NIL só é utilizado pela fixup de uma remoção, não
-    // precisamos nos preocupar em restaurar o pai de um NIL para NIL denovo
-    sub2->pai = sub1->pai;
+    // (se `sub2` for NIL não há pai a atualizar, o fixup da remoção
+    // recebe o pai separadamente)
+    if(!arv_no_vazio(sub2)) {
+        sub2->pai = sub1->pai;
+    }
 }
 
 
 // função auxiliar para fazer a correção da árvore
 // partindo do nó `no` (que tem um "preto extra", quebrando
-// a altura-preta), e navegando para cima
-static void arv_remove_fixup(Arvore *arv, No *no) {
+// a altura-preta), e navegando para cima.
+// como `no` pode ser NIL (NULL), o seu pai `pai` é passado separadamente.
+// retorna true se a altura-preta da árvore diminuiu
+static bool arv_remove_fixup(Arvore *arv, No *no, No *pai) {
+    // se o "preto extra" subir até a raiz, ele é simplesmente descartado,
+    // e todos os caminhos perdem um nó preto
+    bool diminuiu = false;
+
     // enquanto `no` não for a raiz e ainda ter um "preto extra"
     // (se for raíz já está válida novamente a árvore também)
-    while(no != arv->raiz && no->cor == PRETO) {
+    while(no != arv->raiz && arv_busca_cor(no) == PRETO) {
+        ARV_EST_CONTA(arv, iteracoes_fixup_remocao);
         // se `no` é um filho esquerdo
-        if(no == no->pai->esq) {
+        if(no == pai->esq) {
             // busca o irmao
-            No *irmao = no->pai->dir;
+            No *irmao = pai->dir;
 
             // caso 1a: o irmão de `no` é vermelho
             // deve trocar as cores do pai e do irmão,
             // além de rotacionar o pai para esquerda
-            if(irmao->cor == VERMELHO) {
+            if(arv_busca_cor(irmao) == VERMELHO) {
                 irmao->cor = PRETO;
-                no->pai->cor = VERMELHO;
-                arv_rotacao_esquerda(arv, no->pai);
+                pai->cor = VERMELHO;
+                arv_rotacao_esquerda(arv, pai);
                 
                 // atualiza o `irmao` para o novo irmão de `no`, que
                 // agora deve ser preto
-                irmao = no->pai->dir;
+                irmao = pai->dir;
                 
                 // o problema continua em um dos casos abaixo: 2a, 3a ou 4a
             }
@@ -444,13 +1229,15 @@ static void arv_remove_fixup(Arvore *arv, No *no) {
             // caso 2a: o irmão `irmao` é preto e seus 2 filhos são pretos
             // o irmão é pintado de vermelho, "empurrando" o problema
             // do "preto-extra" para cima
-            if(irmao->esq->cor == PRETO && irmao->dir->cor == PRETO) {
+            if(arv_busca_cor(irmao->esq) == PRETO && arv_busca_cor(irmao->dir) == PRETO) {
                 // pinta `irmao` de vermelho
                 irmao->cor = VERMELHO;
                 
                 // atualiza o novo `no` do loop, que passa a ser o pai,
                 // já que o "preto extra" foi para cima
-                no = no->pai;
+                no = pai;
+                pai = no->pai;
+                diminuiu = no == arv->raiz;
             }
             // caso 3a ou 4a: o irmão `irmao` é preto e tem tem pelo menos 1 filho vermelho
             else {
@@ -458,7 +1245,7 @@ static void arv_remove_fixup(Arvore *arv, No *no) {
                 // seu filho direito é preto
                 // deve repintar o filho esquerdo para preto, o `irmao` para
                 // vermelho e rotacionar o `irmao` para direita
-                if(irmao->dir->cor == PRETO) {
+                if(arv_busca_cor(irmao->dir) == PRETO) {
                     // pinta o filho esquerdo de preto
                     irmao->esq->cor = PRETO;
                     // pinta o `irmao` de vermelho
@@ -467,19 +1254,19 @@ static void arv_remove_fixup(Arvore *arv, No *no) {
                     arv_rotacao_direita(arv, irmao);
                     
                     // `irmao` agora é o novo irmão depois da rotação
-                    irmao = no->pai->dir;
+                    irmao = pai->dir;
                 }
 
                 // caso 4a: `irmao` é preto e seu filho direito é vermelho
                 // deve remover o "preto extra", dessa vez é definitivo
                 // o `irmao` herda a cor de seu pai
-                irmao->cor = no->pai->cor;
+                irmao->cor = pai->cor;
                 // o pai é pintado de preto
-                no->pai->cor = PRETO;
+                pai->cor = PRETO;
                 // filho direito de `irmao` é pintado de preto
                 irmao->dir->cor = PRETO;
                 // rotaciona o pai de `no` para esquerda
-                arv_rotacao_esquerda(arv, no->pai);
+                arv_rotacao_esquerda(arv, pai);
                 
 
                 // depois disso, o "preto extra" foi resolvido
@@ -490,19 +1277,19 @@ static void arv_remove_fixup(Arvore *arv, No *no) {
         // senão, `no` é um filho direito (apenas espelha os casos a)
         else {
             // busca o irmao
-            No *irmao = no->pai->esq;
+            No *irmao = pai->esq;
 
             // caso 1b: o irmão de `no` é vermelho
             // deve trocar as cores do pai e do irmão,
             // além de rotacionar o pai para direita
-            if(irmao->cor == VERMELHO) {
+            if(arv_busca_cor(irmao) == VERMELHO) {
                 irmao->cor = PRETO;
-                no->pai->cor = VERMELHO;
-                arv_rotacao_direita(arv, no->pai);
+                pai->cor = VERMELHO;
+                arv_rotacao_direita(arv, pai);
 
                 // atualiza o `irmao` para o novo irmão de `no`, que
                 // agora deve ser preto
-                irmao = no->pai->esq;
+                irmao = pai->esq;
 
                 // o problema continua em um dos casos abaixo: 2b, 3b ou 4b
             }
@@ -510,9 +1297,11 @@ static void arv_remove_fixup(Arvore *arv, No *no) {
             // caso 2b: o irmão `irmao` é preto e seus 2 filhos são pretos
             // o irmão é pintado de vermelho, "empurrando" o problema
             // do "preto-extra" para cima
-            if(irmao->esq->cor == PRETO && irmao->dir->cor == PRETO) {
+            if(arv_busca_cor(irmao->esq) == PRETO && arv_busca_cor(irmao->dir) == PRETO) {
                 irmao->cor = VERMELHO;
-                no = no->pai;
+                no = pai;
+                pai = no->pai;
+                diminuiu = no == arv->raiz;
             }
             
             // caso 3b ou 4b: o irmão `irmao` é preto e tem tem pelo menos 1 filho vermelho
@@ -521,7 +1310,7 @@ static void arv_remove_fixup(Arvore *arv, No *no) {
                 // seu filho esquerdo é preto
                 // deve repintar o filho direito para preto, o `irmao` para
                 // vermelho e rotacionar o `irmao` para esquerda
-                if(irmao->esq->cor == PRETO) {
+                if(arv_busca_cor(irmao->esq) == PRETO) {
                     // pinta o filho direito de preto
                     irmao->dir->cor = PRETO;
                     // pinta o `irmao` de vermelho
@@ -530,19 +1319,19 @@ static void arv_remove_fixup(Arvore *arv, No *no) {
                     arv_rotacao_esquerda(arv, irmao);
 
                     // `irmao` agora é o novo irmão depois da rotação
-                    irmao = no->pai->esq;
+                    irmao = pai->esq;
                 }
 
                 // caso 4b: `irmao` é preto e seu filho esquerdo é vermelho
                 // deve remover o "preto extra", dessa vez é definitivo
                 // o `irmao` herda a cor de seu pai
-                irmao->cor = no->pai->cor;
+                irmao->cor = pai->cor;
                 // o pai é pintado de preto
-                no->pai->cor = PRETO;
+                pai->cor = PRETO;
                 // filho esquerdo de `irmao` é pintado de preto
                 irmao->esq->cor = PRETO;
                 // rotaciona o pai de `no` para direita
-                arv_rotacao_direita(arv, no->pai);
+                arv_rotacao_direita(arv, pai);
                 
                 // depois disso, o "preto extra" foi resolvido
                 // para sair do loop atualiza `no` para a raíz da árvore
@@ -555,73 +1344,884 @@ static void arv_remove_fixup(Arvore *arv, No *no) {
     // ser preto corrige qualquer "preto extra" que sobrou e vira preto.
     // há também o caso em que um nó vermelho absorveu o "preto extra",
     // que corrige também
-    no->cor = PRETO;
+    if(!arv_no_vazio(no)) no->cor = PRETO;
+    return diminuiu;
 }
 
-bool arv_remove_no(Arvore *arv, void *v) {
-    if(arv == NULL) return false;
-
-    // busca o nó a remover
-    No *no_buscado = arv_busca_no(arv->raiz, v, arv->comp);
-    // se não encontrou, retorna false
-    if(arv_no_vazio(no_buscado)) return false;
-
-    // `no_remover` é o  ponteiro para o nó que realmente será removido,
-    // vamos copiar o conteudo do sucessor para cima, facilitando
-    // a remoção (se tiver 2 filhos)
-    No *no_remover = no_buscado;
-    
-    // se `no_buscado` tiver 2 filhos, copiamos o conteúdo do sucessor para
-    // `no_buscado` (que está acima) e removemos o sucessor dele
-    if(!arv_no_vazio(no_buscado->esq) && !arv_no_vazio(no_buscado->dir)) {
-        // pega o menor dos sucessores partindo do `no_buscado`
-        No *sucessor = arv_busca_minimo(no_buscado->dir);
-        // copia o ponteiro para o dado para `no_buscado`
-        void *temp = no_buscado->dado;
-        no_buscado->dado = sucessor->dado;
-        sucessor->dado = temp;
-        // agora, o nó realmente a remover é esse sucessor que teve seu
-        // dado copiado
-        no_remover = sucessor;
-    }
-
-    // agora, `no_remover` pode ter no máximo 1 filho
-    // (ou é o `no_buscado`, ou é o menor sucessor)
-
-    // acha o nó para substituir esse que será realmente removido,
-    // que sera seu filho não NIL ou NIL se o `no_remover`
-    // for um nó sem filhos
+// função auxiliar que desliga o nó `no` da árvore sem liberá-lo.
+// se `no` tiver 2 filhos, o seu sucessor é religado no lugar dele (ao
+// invés de trocar os dados entre os dois nós), assim cada dado continua
+// no mesmo nó, o que é obrigatório na árvore intrusiva
+static void arv_desliga_no(Arvore *arv, No *no) {
+    // `no_movido` é o nó que realmente sai da sua posição na árvore,
+    // que é o próprio `no` se ele tiver no máximo 1 filho, ou o seu
+    // sucessor se tiver 2 filhos
+    No *no_movido = no;
+    Cor cor_movido = no_movido->cor;
+
+    // `no_substituto` é o nó que ocupa a antiga posição de `no_movido`,
+    // é a partir dele (e de seu pai, já que pode ser NIL) que a correção é feita
     No *no_substituto;
-    if(arv_no_vazio(no_remover->esq)) {
-        no_substituto = no_remover->dir;
+    No *pai_substituto = no->pai;
+
+    if(arv_no_vazio(no->esq)) {
+        no_substituto = no->dir;
+        arv_subtitui_subarv(arv, no, no->dir);
     }
-    else {
-        no_substituto = no_remover->esq;
+    else if(arv_no_vazio(no->dir)) {
+        no_substituto = no->esq;
+        arv_subtitui_subarv(arv, no, no->esq);
     }
+    else {
+        // `no` tem 2 filhos, pega o menor dos sucessores partindo de `no`,
+        // que não tem filho esquerdo
+        no_movido = arv_busca_minimo(no->dir);
+        cor_movido = no_movido->cor;
+        no_substituto = no_movido->dir;
+
+        // se o sucessor é o próprio filho direito de `no`, ele leva sua
+        // sub-árvore direita junto, e continua sendo o pai do substituto
+        if(no_movido->pai == no) {
+            pai_substituto = no_movido;
+        }
+        // senão, o filho direito do sucessor ocupa o lugar dele e o
+        // sucessor adota a sub-árvore direita de `no`
+        else {
+            pai_substituto = no_movido->pai;
+            arv_subtitui_subarv(arv, no_movido, no_movido->dir);
+            no_movido->dir = no->dir;
+            no_movido->dir->pai = no_movido;
+        }
 
-    // salva a cor do `no_remover` antes de substitui a sub-árvore
-    Cor cor_removido = no_remover->cor;
+        // o sucessor ocupa a posição de `no`, adotando sua sub-árvore
+        // esquerda e sua cor
+        arv_subtitui_subarv(arv, no, no_movido);
+        no_movido->esq = no->esq;
+        no_movido->esq->pai = no_movido;
+        no_movido->cor = no->cor;
+    }
 
-    // substitui a sub-árvore de `no_remover` pelo `no_substituto`
-    // (o pai de `no_remover` passa a apontar para `no_substituto`)
-    arv_subtitui_subarv(arv, no_remover, no_substituto);
+    // só os tamanhos do pai do substituto para cima mudaram (se `no` tinha
+    // 2 filhos, o caminho passa pelo sucessor, que está no lugar de `no`)
+    arv_atualiza_tamanho_ate_raiz(arv, pai_substituto);
 
-    // se a cor do nó removido for preta, a propriedade 5 (altura-preta)
-    // foi quebrada, devemos corrigir a partir de `no_substituto`
-    if(cor_removido == PRETO) {
-        arv_remove_fixup(arv, no_substituto);
+    // se a cor do nó que saiu da posição for preta, a propriedade 5
+    // (altura-preta) foi quebrada, devemos corrigir a partir de `no_substituto`
+    if(cor_movido == PRETO) {
+        if(arv_remove_fixup(arv, no_substituto, pai_substituto)) arv->altura_preta--;
     }
-
-    // libera o nó realmente removido
-    // mas primeiro libera o dado do nó se tiver o liberador
-    if(arv->libera != NULL) arv->libera(no_remover->dado);
-    free(no_remover);
-    arv->num_nos--;
-    return true;
+    if(arv_no_vazio(arv->raiz)) arv->altura_preta = 0;
 }
 
+// função auxiliar que retorna o nó com o valor `v`, ou NULL se não houver
+static No* arv_procura(Arvore *arv, void *v) {
+    uint64_t prefixo_v = arv_prefixo_de(arv, v);
+    No *atual = arv->raiz;
+    while(!arv_no_vazio(atual)) {
+        int resultado_comp = arv_compara(arv, v, prefixo_v, atual);
 
-//// --- consultas ---
+        if(resultado_comp == 0) {
+            return atual;
+        }
+        else if(resultado_comp < 0) {
+            atual = atual->esq;
+        }
+        else {
+            atual = atual->dir;
+        }
+    }
+
+    return NULL;
+}
+
+// função auxiliar que tira o nó `no` da árvore e o libera, junto com o
+// dado se a árvore possuir o liberador
+static void arv_remove_e_libera(Arvore *arv, No *no) {
+    arv_desliga_no(arv, no);
+
+    // libera o nó removido, mas primeiro libera o dado do nó se tiver o
+    // liberador. na árvore intrusiva o nó faz parte do dado, então só
+    // o dado é liberado
+    if(arv->libera != NULL) arv->libera(no->dado);
+    arv_libera_no_unico(arv, no);
+    arv->num_nos--;
+}
+
+bool arv_remove_no(Arvore *arv, void *v) {
+    if(arv == NULL) return false;
+
+    ARV_EST_INICIO(inicio);
+
+    // busca o nó a remover
+    No *no_buscado = arv_procura(arv, v);
+    // se não encontrou, não remove nada
+    bool removeu = !arv_no_vazio(no_buscado);
+
+    if(removeu) {
+        arv_remove_e_libera(arv, no_buscado);
+    }
+
+    ARV_EST_FIM(arv, ARV_OP_REMOVE, inicio);
+    return removeu;
+}
+
+bool arv_remove_no_handle(Arvore *arv, No *no) {
+    if(arv == NULL) return false;
+    if(arv_no_vazio(no)) return false;
+
+    // não precisa de busca: o nó já é a posição a remover
+    ARV_EST_INICIO(inicio);
+    arv_remove_e_libera(arv, no);
+    ARV_EST_FIM(arv, ARV_OP_REMOVE, inicio);
+    return true;
+}
+
+
+//// --- junção / divisão / operações de conjunto ---
+
+// uma sub-árvore rubro-negra válida, sem pai e com raiz preta (ou vazia),
+// junto da sua altura-preta (número de nós pretos da raiz até um NIL).
+// as operações abaixo quebram e juntam fragmentos, e saber a altura-preta
+// de cada um é o que permite juntar dois fragmentos descendo só até a
+// altura do menor deles
+typedef struct {
+    No *raiz;
+    int altura_preta;
+} Fragmento;
+
+// função auxiliar que calcula a altura-preta da sub-árvore com raiz `no`,
+// descendo pelo caminho mais a esquerda
+static int arv_altura_preta_de(No *no) {
+    int altura_preta = 0;
+    while(!arv_no_vazio(no)) {
+        if(no->cor == PRETO) altura_preta++;
+        no = no->esq;
+    }
+    return altura_preta;
+}
+
+// função auxiliar que solta a sub-árvore com raiz `no` e altura-preta
+// `altura_preta` do seu pai, transformando ela em um fragmento.
+// se a raiz for vermelha, ela é pintada de preto (a altura-preta aumenta)
+static Fragmento arv_fragmento(No *no, int altura_preta) {
+    Fragmento frag = { no, altura_preta };
+    if(arv_no_vazio(no)) return frag;
+
+    no->pai = NULL;
+    if(no->cor == VERMELHO) {
+        no->cor = PRETO;
+        frag.altura_preta++;
+    }
+    return frag;
+}
+
+// função auxiliar que junta os fragmentos `menor` e `maior` usando o nó
+// `meio` entre eles (todos os dados de `menor` <= `meio` <= todos os dados
+// de `maior`) e retorna o fragmento resultante.
+// o fragmento mais baixo é pendurado, junto com `meio`, no ponto da borda
+// do mais alto que tem a mesma altura-preta, e depois o mesmo fixup da
+// inserção corrige um possível vermelho-vermelho. o custo é proporcional à
+// diferença das alturas-pretas.
+// usa `arv->raiz` como rascunho para o fixup
+static Fragmento arv_junta_fragmentos(Arvore *arv, Fragmento menor, No *meio, Fragmento maior) {
+    Fragmento junto;
+
+    // mesma altura-preta: `meio` vira a raiz, preta, dos dois
+    if(menor.altura_preta == maior.altura_preta) {
+        meio->esq = menor.raiz;
+        meio->dir = maior.raiz;
+        meio->pai = NULL;
+        meio->cor = PRETO;
+        if(!arv_no_vazio(menor.raiz)) menor.raiz->pai = meio;
+        if(!arv_no_vazio(maior.raiz)) maior.raiz->pai = meio;
+        arv_atualiza_tamanho(arv, meio);
+
+        junto.raiz = meio;
+        junto.altura_preta = menor.altura_preta + 1;
+        return junto;
+    }
+
+    if(menor.altura_preta > maior.altura_preta) {
+        // desce pela borda direita de `menor` até um nó preto (ou NIL)
+        // com a altura-preta de `maior`
+        No *pai = NULL;
+        No *atual = menor.raiz;
+        int altura_preta = menor.altura_preta;
+        while(arv_busca_cor(atual) == VERMELHO || altura_preta > maior.altura_preta) {
+            if(atual->cor == PRETO) altura_preta--;
+            pai = atual;
+            atual = atual->dir;
+        }
+
+        // `meio` entra no lugar de `atual`, vermelho, com `atual` e `maior`
+        // como filhos, o que mantém a altura-preta de todos os caminhos
+        meio->esq = atual;
+        meio->dir = maior.raiz;
+        meio->pai = pai;
+        meio->cor = VERMELHO;
+        pai->dir = meio;
+        if(!arv_no_vazio(atual)) atual->pai = meio;
+        if(!arv_no_vazio(maior.raiz)) maior.raiz->pai = meio;
+        arv_atualiza_tamanho_ate_raiz(arv, meio);
+
+        arv->raiz = menor.raiz;
+        junto.altura_preta = menor.altura_preta;
+    }
+    // senão, espelha pela borda esquerda de `maior`
+    else {
+        No *pai = NULL;
+        No *atual = maior.raiz;
+        int altura_preta = maior.altura_preta;
+        while(arv_busca_cor(atual) == VERMELHO || altura_preta > menor.altura_preta) {
+            if(atual->cor == PRETO) altura_preta--;
+            pai = atual;
+            atual = atual->esq;
+        }
+
+        meio->esq = menor.raiz;
+        meio->dir = atual;
+        meio->pai = pai;
+        meio->cor = VERMELHO;
+        pai->esq = meio;
+        if(!arv_no_vazio(atual)) atual->pai = meio;
+        if(!arv_no_vazio(menor.raiz)) menor.raiz->pai = meio;
+        arv_atualiza_tamanho_ate_raiz(arv, meio);
+
+        arv->raiz = maior.raiz;
+        junto.altura_preta = maior.altura_preta;
+    }
+
+    // corrige um possível vermelho-vermelho entre `meio` e seu pai
+    if(arv_insere_fixup(arv, meio)) junto.altura_preta++;
+    junto.raiz = arv->raiz;
+    return junto;
+}
+
+// função auxiliar que junta os fragmentos `menor` e `maior` sem um nó
+// entre eles: o menor nó de `maior` é retirado e usado como o meio.
+// usa `arv->raiz` como rascunho
+static Fragmento arv_junta_fragmentos_sem_meio(Arvore *arv, Fragmento menor, Fragmento maior) {
+    if(arv_no_vazio(maior.raiz)) return menor;
+    if(arv_no_vazio(menor.raiz)) return maior;
+
+    arv->raiz = maior.raiz;
+    No *meio = arv_busca_minimo(maior.raiz);
+    arv_desliga_no(arv, meio);
+
+    maior = arv_fragmento(arv->raiz, arv_altura_preta_de(arv->raiz));
+    return arv_junta_fragmentos(arv, menor, meio, maior);
+}
+
+// função auxiliar que divide o fragmento `frag` em `menor` (dados menores
+// que `chave`) e `maior` (dados maiores ou iguais a `chave`), juntando de
+// volta as sub-árvores que ficam de cada lado do caminho de busca.
+// se `igual` não for NULL, um nó com dado igual a `chave` encontrado no
+// caminho é separado e devolvido nele (ou NULL se não encontrar).
+// usa `arv->raiz` como rascunho
+static void arv_divide_fragmento(Arvore *arv, Fragmento frag, void *chave,
+                                 Fragmento *menor, Fragmento *maior, No **igual) {
+    if(arv_no_vazio(frag.raiz)) {
+        *menor = frag;
+        *maior = frag;
+        return;
+    }
+
+    No *no = frag.raiz;
+    int altura_preta_filhos = frag.altura_preta - (no->cor == PRETO ? 1 : 0);
+    Fragmento esq = arv_fragmento(no->esq, altura_preta_filhos);
+    Fragmento dir = arv_fragmento(no->dir, altura_preta_filhos);
+    int resultado_comp = arv_compara(arv, chave, arv_prefixo_de(arv, chave), no);
+
+    if(igual != NULL && resultado_comp == 0) {
+        *igual = no;
+        *menor = esq;
+        *maior = dir;
+    }
+    // `no` fica no lado dos maiores, junto da sub-árvore direita
+    else if(resultado_comp <= 0) {
+        Fragmento resto;
+        arv_divide_fragmento(arv, esq, chave, menor, &resto, igual);
+        *maior = arv_junta_fragmentos(arv, resto, no, dir);
+    }
+    // `no` fica no lado dos menores, junto da sub-árvore esquerda
+    else {
+        Fragmento resto;
+        arv_divide_fragmento(arv, dir, chave, &resto, maior, igual);
+        *menor = arv_junta_fragmentos(arv, esq, no, resto);
+    }
+}
+
+// função auxiliar que libera todos os nós do fragmento com raiz `no`
+// (que pertencem a árvore `arv`), liberando os dados com `libera`
+static void arv_libera_fragmento(Arvore *arv, No *no, Liberador *libera) {
+    if(arv_no_vazio(no)) return;
+
+    arv_libera_fragmento(arv, no->esq, libera);
+    arv_libera_fragmento(arv, no->dir, libera);
+
+    if(libera != NULL) libera(no->dado);
+    arv_libera_no_unico(arv, no);
+}
+
+// função auxiliar que cria um fragmento a partir da árvore `arv` e
+// esvazia a árvore
+static Fragmento arv_retira_fragmento(Arvore *arv) {
+    Fragmento frag = { arv->raiz, arv->altura_preta };
+    arv->raiz = NULL;
+    arv->num_nos = 0;
+    arv->altura_preta = 0;
+    return frag;
+}
+
+// função auxiliar que volta o fragmento `frag` (com `num_nos` nós) a ser a
+// árvore inteira `arv`
+static void arv_devolve_fragmento(Arvore *arv, Fragmento frag, size_t num_nos) {
+    arv->raiz = frag.raiz;
+    arv->num_nos = num_nos;
+    arv->altura_preta = frag.altura_preta;
+}
+
+// função auxiliar que copia a sub-árvore com raiz `no` (mesma forma e
+// mesmas cores) em nós alocados pela árvore `arv`, e retorna a raiz da
+// cópia, ou NULL com `*falhou` = true em caso de falha de alocação
+static No* arv_clona_rec(Arvore *arv, No *no, No *pai, bool *falhou) {
+    if(arv_no_vazio(no) || *falhou) return NULL;
+
+    No *copia = arv_cria_no(arv, no->dado, no->cor);
+    if(copia == NULL) {
+        *falhou = true;
+        return NULL;
+    }
+    copia->pai = pai;
+    copia->esq = arv_clona_rec(arv, no->esq, copia, falhou);
+    copia->dir = arv_clona_rec(arv, no->dir, copia, falhou);
+    if(!*falhou) arv_atualiza_tamanho(arv, copia);
+    return copia;
+}
+
+// função auxiliar que libera os nós da sub-árvore com raiz `no` pelo
+// alocador da árvore `arv`, sem liberar os dados
+static void arv_libera_nos(Arvore *arv, No *no) {
+    if(arv_no_vazio(no)) return;
+
+    arv_libera_nos(arv, no->esq);
+    arv_libera_nos(arv, no->dir);
+    arv_libera_no_unico(arv, no);
+}
+
+// função auxiliar que recalcula o prefixo dos nós da sub-árvore com raiz
+// `no` com o extrator da árvore `arv`
+static void arv_recalcula_prefixos(Arvore *arv, No *no) {
+    if(arv_no_vazio(no)) return;
+
+    arv_guarda_prefixo(arv, no);
+    arv_recalcula_prefixos(arv, no->esq);
+    arv_recalcula_prefixos(arv, no->dir);
+}
+
+// função auxiliar que recalcula o tamanho e o agregado dos nós da
+// sub-árvore com raiz `no` com a configuração da árvore `arv`, dos filhos
+// para os pais
+static void arv_recalcula_tamanhos(Arvore *arv, No *no) {
+    if(arv_no_vazio(no)) return;
+
+    arv_recalcula_tamanhos(arv, no->esq);
+    arv_recalcula_tamanhos(arv, no->dir);
+    arv_atualiza_tamanho(arv, no);
+}
+
+// função auxiliar que retorna true se as árvores `arv` e `outra` calculam
+// o mesmo agregado (ou nenhuma das duas tem agregado)
+static bool arv_mesmo_agregado(Arvore *arv, Arvore *outra) {
+    if(arv->acumula != outra->acumula) return false;
+    if(arv->acumula == NULL) return true;
+
+    return arv->combina == outra->combina &&
+           arv->contexto_agregado == outra->contexto_agregado &&
+           arv->tam_agregado == outra->tam_agregado &&
+           memcmp(arv->agregado_inicial, outra->agregado_inicial, arv->tam_agregado) == 0;
+}
+
+// função auxiliar que corrige os prefixos, os tamanhos e os agregados dos
+// nós reaproveitados da árvore `outra` no fragmento `frag`, quando `arv`
+// usa outro extrator de prefixo, guarda tamanhos que `outra` não guarda
+// ou usa outro agregado
+static void arv_corrige_adotados(Arvore *arv, Arvore *outra, Fragmento *frag) {
+    if(arv->prefixo != NULL && arv->prefixo != outra->prefixo) arv_recalcula_prefixos(arv, frag->raiz);
+    if((arv->tamanhos && !outra->tamanhos) || !arv_mesmo_agregado(arv, outra)) {
+        arv_recalcula_tamanhos(arv, frag->raiz);
+    }
+}
+
+// função auxiliar que faz os nós da árvore `outra` passarem a ser da árvore
+// `arv`, para que as duas possam ser juntadas, e retorna o fragmento com
+// esses nós (`outra` fica vazia).
+// se as duas usam o mesmo tipo de alocação, os nós são só reaproveitados
+// (se cada uma tem seu pool, os blocos de `outra` passam para o pool de
+// `arv`). senão, os nós são copiados com o alocador de `arv`.
+// retorna false em caso de falha de alocação (nada é alterado)
+static bool arv_adota_nos(Arvore *arv, Arvore *outra, Fragmento *frag) {
+    // nós de outro tamanho, ou com o prefixo em outra posição, não servem
+    if(arv->deslocamento_intrusivo == outra->deslocamento_intrusivo && arv->tam_no == outra->tam_no &&
+       arv->deslocamento_prefixo == outra->deslocamento_prefixo) {
+        // intrusivas no mesmo campo, ou nós alocados um a um nas duas,
+        // ou o mesmo pool: os nós já servem
+        if(arv->deslocamento_intrusivo >= 0 || arv->pool == outra->pool) {
+            *frag = arv_retira_fragmento(outra);
+            // nós reaproveitados de uma árvore com outro extrator de
+            // prefixo, sem tamanhos ou com outro agregado ficariam com
+            // valores errados
+            arv_corrige_adotados(arv, outra, frag);
+            return true;
+        }
+
+        // cada uma tem seu pool e ninguém mais usa o de `outra`: os blocos
+        // de `outra` passam para `arv`, e o pool de `outra` fica vazio
+        if(arv->pool != NULL && outra->pool != NULL && outra->pool->referencias == 1) {
+            Pool *origem = outra->pool;
+            Pool *destino = arv->pool;
+
+            // os nós que sobraram no bloco atual de `origem` viram livres
+            if(origem->blocos != NULL) {
+                for(size_t i = origem->usados_bloco; i < origem->nos_por_bloco; i++) {
+                    No *no = arv_pool_no(origem, origem->blocos, i);
+                    no->dir = origem->livres;
+                    origem->livres = no;
+                }
+            }
+
+            // os blocos de `origem` entram depois do bloco atual de `destino`
+            BlocoPool *ultimo = origem->blocos;
+            if(ultimo != NULL) {
+                while(ultimo->prox != NULL) ultimo = ultimo->prox;
+                if(destino->blocos == NULL) {
+                    ultimo->prox = NULL;
+                    destino->blocos = origem->blocos;
+                    destino->usados_bloco = destino->nos_por_bloco;
+                }
+                else {
+                    ultimo->prox = destino->blocos->prox;
+                    destino->blocos->prox = origem->blocos;
+                }
+            }
+
+            // os livres de `origem` entram na lista de livres de `destino`
+            while(origem->livres != NULL) {
+                No *no = origem->livres;
+                origem->livres = no->dir;
+                no->dir = destino->livres;
+                destino->livres = no;
+            }
+
+            origem->blocos = NULL;
+            origem->usados_bloco = 0;
+
+            *frag = arv_retira_fragmento(outra);
+            // nós reaproveitados de uma árvore com outro extrator de
+            // prefixo, sem tamanhos ou com outro agregado ficariam com
+            // valores errados
+            arv_corrige_adotados(arv, outra, frag);
+            return true;
+        }
+    }
+
+    // alocações incompatíveis: copia os nós
+    bool falhou = false;
+    No *copia = arv_clona_rec(arv, outra->raiz, NULL, &falhou);
+    if(falhou) {
+        arv_libera_nos(arv, copia);
+        return false;
+    }
+
+    arv_libera_nos(outra, outra->raiz);
+    outra->raiz = copia;
+    *frag = arv_retira_fragmento(outra);
+    return true;
+}
+
+// função auxiliar que cria uma árvore vazia com a mesma configuração de
+// `arv`. se `arv` usa pool, a nova árvore usa o mesmo pool
+static Arvore* arv_cria_semelhante(Arvore *arv) {
+    Arvore *nova_arvore = arv_cria(arv->comp, arv->libera);
+    if(nova_arvore == NULL) return NULL;
+
+    nova_arvore->deslocamento_intrusivo = arv->deslocamento_intrusivo;
+    nova_arvore->prefixo = arv->prefixo;
+    nova_arvore->unicos = arv->unicos;
+    nova_arvore->tamanhos = arv->tamanhos;
+    nova_arvore->threads_liberacao = arv->threads_liberacao;
+    if(arv->acumula != NULL &&
+       !arv_define_agregado(nova_arvore, arv->tam_agregado, arv->agregado_inicial,
+                            arv->acumula, arv->combina, arv->contexto_agregado)) {
+        arv_libera_arvore(nova_arvore);
+        return NULL;
+    }
+    arv_calcula_tam_no(nova_arvore);
+    nova_arvore->pool = arv->pool;
+    if(nova_arvore->pool != NULL) nova_arvore->pool->referencias++;
+
+    return nova_arvore;
+}
+
+// função auxiliar que retorna true se os dados de `outra` podem entrar em
+// `arv` sem repetidos internos: se `arv` recusa repetidos, `outra` também
+// precisa recusar, já que conferir os dados dela custaria O(n)
+static bool arv_aceita_dados_de(Arvore *arv, Arvore *outra) {
+    return !arv->unicos || outra->unicos || arv_vazia(outra);
+}
+
+bool arv_junta(Arvore *arv, Arvore *outra) {
+    if(arv == NULL || outra == NULL || arv == outra) return false;
+    if(!arv_aceita_dados_de(arv, outra)) return false;
+    if(arv_vazia(outra)) return true;
+
+    // as duas árvores não podem se intercalar: todos os dados de uma
+    // devem ser menores ou iguais a todos os dados da outra. se `arv`
+    // recusa repetidos, eles devem ser estritamente menores
+    int limite = arv->unicos ? 0 : 1;
+    bool outra_maior = true;
+    if(!arv_vazia(arv)) {
+        if(arv->comp(arv_busca_maximo(arv->raiz)->dado, arv_busca_minimo(outra->raiz)->dado) < limite) {
+            outra_maior = true;
+        }
+        else if(arv->comp(arv_busca_maximo(outra->raiz)->dado, arv_busca_minimo(arv->raiz)->dado) < limite) {
+            outra_maior = false;
+        }
+        else {
+            return false;
+        }
+    }
+
+    size_t num_nos = arv->num_nos + outra->num_nos;
+    Fragmento b;
+    if(!arv_adota_nos(arv, outra, &b)) return false;
+    Fragmento a = arv_retira_fragmento(arv);
+
+    Fragmento junto = outra_maior ? arv_junta_fragmentos_sem_meio(arv, a, b)
+                                  : arv_junta_fragmentos_sem_meio(arv, b, a);
+    arv_devolve_fragmento(arv, junto, num_nos);
+    return true;
+}
+
+// função auxiliar que retorna o número de nós do fragmento com raiz `a`,
+// sem os tamanhos das sub-árvores: percorre em ordem os fragmentos `a` e
+// `b`, que juntos têm `num_nos` nós, ao mesmo tempo até um deles acabar,
+// em O(min(|a|, |b|))
+static size_t arv_conta_fragmento(No *a, No *b, size_t num_nos) {
+    No *atual_a = arv_busca_minimo(a);
+    No *atual_b = arv_busca_minimo(b);
+    size_t contados = 0;
+    while(atual_a != NULL && atual_b != NULL) {
+        atual_a = arv_iter_proximo(atual_a);
+        atual_b = arv_iter_proximo(atual_b);
+        contados++;
+    }
+
+    return atual_a == NULL ? contados : num_nos - contados;
+}
+
+bool arv_divide(Arvore *arv, void *chave, Arvore **menores, Arvore **maiores) {
+    if(arv == NULL || menores == NULL || maiores == NULL) return false;
+
+    Arvore *arv_menores = arv_cria_semelhante(arv);
+    Arvore *arv_maiores = arv_cria_semelhante(arv);
+    if(arv_menores == NULL || arv_maiores == NULL) {
+        arv_libera_arvore(arv_menores);
+        arv_libera_arvore(arv_maiores);
+        return false;
+    }
+
+    size_t num_nos = arv->num_nos;
+    Fragmento menor, maior;
+    arv_divide_fragmento(arv, arv_retira_fragmento(arv), chave, &menor, &maior, NULL);
+
+    size_t num_menores = arv->tamanhos ? arv_busca_tamanho(menor.raiz)
+                                       : arv_conta_fragmento(menor.raiz, maior.raiz, num_nos);
+    arv_devolve_fragmento(arv_menores, menor, num_menores);
+    arv_devolve_fragmento(arv_maiores, maior, num_nos - num_menores);
+    // a raiz de `arv` foi usada como rascunho
+    arv->raiz = NULL;
+    arv->altura_preta = 0;
+
+    *menores = arv_menores;
+    *maiores = arv_maiores;
+    return true;
+}
+
+// a união, a interseção e a diferença dividem `b` pelo dado da raiz de `a`
+// e resolvem recursivamente cada metade, juntando os resultados com a raiz
+// de `a` no meio (ou sem ela). cada nível custa só a diferença de
+// alturas-pretas dos pedaços, o que dá O(m log(n/m + 1)) no total, com m o
+// tamanho da menor árvore.
+// as metades são resolvidas uma depois da outra: as duas usam a raiz de
+// `arv` nas junções e o alocador de nós da árvore (o pool e a sua lista
+// de livres), então não podem rodar ao mesmo tempo.
+
+// função auxiliar da união de conjuntos. `a` tem os nós da árvore `arv` e
+// `b` os da outra árvore (já adotados por `arv`). um nó de `b` com o mesmo
+// dado de um nó de `a` é liberado com `libera_b`, e `repetidos` conta quantos
+static Fragmento arv_uniao_rec(Arvore *arv, Fragmento a, Fragmento b, Liberador *libera_b,
+                               size_t *repetidos) {
+    if(arv_no_vazio(a.raiz)) return b;
+    if(arv_no_vazio(b.raiz)) return a;
+
+    No *meio = a.raiz;
+    int altura_preta_filhos = a.altura_preta - 1;
+    Fragmento a_esq = arv_fragmento(meio->esq, altura_preta_filhos);
+    Fragmento a_dir = arv_fragmento(meio->dir, altura_preta_filhos);
+
+    Fragmento b_esq, b_dir;
+    No *igual = NULL;
+    arv_divide_fragmento(arv, b, meio->dado, &b_esq, &b_dir, &igual);
+    if(igual != NULL) {
+        // o dado repetido de `b` é descartado
+        if(libera_b != NULL) libera_b(igual->dado);
+        arv_libera_no_unico(arv, igual);
+        (*repetidos)++;
+    }
+
+    Fragmento esq = arv_uniao_rec(arv, a_esq, b_esq, libera_b, repetidos);
+    Fragmento dir = arv_uniao_rec(arv, a_dir, b_dir, libera_b, repetidos);
+    return arv_junta_fragmentos(arv, esq, meio, dir);
+}
+
+// função auxiliar da interseção de conjuntos, com os mesmos argumentos da
+// união. `mantidos` conta quantos nós de `a` ficaram no resultado
+static Fragmento arv_intersecao_rec(Arvore *arv, Fragmento a, Fragmento b, Liberador *libera_b,
+                                    size_t *mantidos) {
+    Fragmento vazio = { NULL, 0 };
+    if(arv_no_vazio(a.raiz)) {
+        arv_libera_fragmento(arv, b.raiz, libera_b);
+        return vazio;
+    }
+    if(arv_no_vazio(b.raiz)) {
+        arv_libera_fragmento(arv, a.raiz, arv->libera);
+        return vazio;
+    }
+
+    No *meio = a.raiz;
+    int altura_preta_filhos = a.altura_preta - 1;
+    Fragmento a_esq = arv_fragmento(meio->esq, altura_preta_filhos);
+    Fragmento a_dir = arv_fragmento(meio->dir, altura_preta_filhos);
+
+    Fragmento b_esq, b_dir;
+    No *igual = NULL;
+    arv_divide_fragmento(arv, b, meio->dado, &b_esq, &b_dir, &igual);
+
+    Fragmento esq = arv_intersecao_rec(arv, a_esq, b_esq, libera_b, mantidos);
+    Fragmento dir = arv_intersecao_rec(arv, a_dir, b_dir, libera_b, mantidos);
+
+    // o dado de `a` só fica se também estiver em `b`
+    if(igual != NULL) {
+        if(libera_b != NULL) libera_b(igual->dado);
+        arv_libera_no_unico(arv, igual);
+        (*mantidos)++;
+        return arv_junta_fragmentos(arv, esq, meio, dir);
+    }
+
+    if(arv->libera != NULL) arv->libera(meio->dado);
+    arv_libera_no_unico(arv, meio);
+    return arv_junta_fragmentos_sem_meio(arv, esq, dir);
+}
+
+// função auxiliar da diferença de conjuntos, com os mesmos argumentos da
+// união. `removidos` conta quantos nós de `a` saíram do resultado
+static Fragmento arv_diferenca_rec(Arvore *arv, Fragmento a, Fragmento b, Liberador *libera_b,
+                                   size_t *removidos) {
+    if(arv_no_vazio(a.raiz)) {
+        arv_libera_fragmento(arv, b.raiz, libera_b);
+        return a;
+    }
+    if(arv_no_vazio(b.raiz)) {
+        return a;
+    }
+
+    No *meio = a.raiz;
+    int altura_preta_filhos = a.altura_preta - 1;
+    Fragmento a_esq = arv_fragmento(meio->esq, altura_preta_filhos);
+    Fragmento a_dir = arv_fragmento(meio->dir, altura_preta_filhos);
+
+    Fragmento b_esq, b_dir;
+    No *igual = NULL;
+    arv_divide_fragmento(arv, b, meio->dado, &b_esq, &b_dir, &igual);
+
+    Fragmento esq = arv_diferenca_rec(arv, a_esq, b_esq, libera_b, removidos);
+    Fragmento dir = arv_diferenca_rec(arv, a_dir, b_dir, libera_b, removidos);
+
+    // o dado de `a` sai se também estiver em `b`
+    if(igual != NULL) {
+        if(libera_b != NULL) libera_b(igual->dado);
+        arv_libera_no_unico(arv, igual);
+
+        if(arv->libera != NULL) arv->libera(meio->dado);
+        arv_libera_no_unico(arv, meio);
+        (*removidos)++;
+        return arv_junta_fragmentos_sem_meio(arv, esq, dir);
+    }
+
+    return arv_junta_fragmentos(arv, esq, meio, dir);
+}
+
+bool arv_uniao(Arvore *arv, Arvore *outra) {
+    if(arv == NULL || outra == NULL || arv == outra) return false;
+    if(!arv_aceita_dados_de(arv, outra)) return false;
+
+    size_t num_nos = arv->num_nos + outra->num_nos;
+    Fragmento b;
+    if(!arv_adota_nos(arv, outra, &b)) return false;
+    Fragmento a = arv_retira_fragmento(arv);
+
+    size_t repetidos = 0;
+    Fragmento resultado = arv_uniao_rec(arv, a, b, outra->libera, &repetidos);
+    arv_devolve_fragmento(arv, resultado, num_nos - repetidos);
+    return true;
+}
+
+bool arv_intersecao(Arvore *arv, Arvore *outra) {
+    if(arv == NULL || outra == NULL || arv == outra) return false;
+
+    Fragmento b;
+    if(!arv_adota_nos(arv, outra, &b)) return false;
+    Fragmento a = arv_retira_fragmento(arv);
+
+    size_t mantidos = 0;
+    Fragmento resultado = arv_intersecao_rec(arv, a, b, outra->libera, &mantidos);
+    arv_devolve_fragmento(arv, resultado, mantidos);
+    return true;
+}
+
+bool arv_diferenca(Arvore *arv, Arvore *outra) {
+    if(arv == NULL || outra == NULL || arv == outra) return false;
+
+    size_t num_nos = arv->num_nos;
+    Fragmento b;
+    if(!arv_adota_nos(arv, outra, &b)) return false;
+    Fragmento a = arv_retira_fragmento(arv);
+
+    size_t removidos = 0;
+    Fragmento resultado = arv_diferenca_rec(arv, a, b, outra->libera, &removidos);
+    arv_devolve_fragmento(arv, resultado, num_nos - removidos);
+    return true;
+}
+
+
+
+//// --- construção em lote ---
+
+// quantidade de nós dos blocos do pool criado por arv_constroi_ordenado
+// em uma árvore que não tinha pool
+#define ARV_NOS_POR_BLOCO_PADRAO 64
+
+// função auxiliar que monta, a partir dos nós já alocados `nos[ini..fim)`
+// (cada um já com seu dado), a sub-árvore perfeitamente balanceada com
+// raiz no meio do intervalo, e retorna sua raiz.
+// todos os caminhos até um NIL têm `ultimo_nivel` ou `ultimo_nivel + 1`
+// nós, então pintar de vermelho só os nós do último nível mantém a
+// mesma altura-preta em todos os caminhos
+static No* arv_constroi_rec(Arvore *arv, No **nos, size_t ini, size_t fim, No *pai,
+                            int nivel, int ultimo_nivel) {
+    if(ini >= fim) return NULL;
+
+    size_t meio = ini + (fim - ini) / 2;
+    No *raiz = nos[meio];
+
+    raiz->pai = pai;
+    // a raiz da árvore inteira (nível 0) é sempre preta
+    raiz->cor = (nivel == ultimo_nivel && nivel > 0) ? VERMELHO : PRETO;
+    raiz->esq = arv_constroi_rec(arv, nos, ini, meio, raiz, nivel + 1, ultimo_nivel);
+    raiz->dir = arv_constroi_rec(arv, nos, meio + 1, fim, raiz, nivel + 1, ultimo_nivel);
+    if(arv->tamanhos) *arv_tamanho_de(raiz) = fim - ini;
+    arv_atualiza_agregado(arv, raiz);
+
+    return raiz;
+}
+
+bool arv_constroi_ordenado(Arvore *arv, void **dados, size_t n) {
+    if(arv == NULL) return false;
+    // só constrói a partir de uma árvore vazia
+    if(!arv_vazia(arv)) return false;
+    if(n == 0) return true;
+    if(dados == NULL) return false;
+
+    // confere se os dados estão mesmo ordenados, senão a árvore
+    // construída não seria uma árvore de busca
+    for(size_t i = 0; i < n; i++) {
+        if(dados[i] == NULL) return false;
+        if(i == 0) continue;
+
+        // com valores únicos, os dados também não podem se repetir
+        int resultado_comp = arv->comp(dados[i - 1], dados[i]);
+        if(resultado_comp > 0 || (resultado_comp == 0 && arv->unicos)) return false;
+    }
+    ARV_EST_CONTA_N(arv, comparacoes, n - 1);
+
+    // uma árvore sem pool passa a usar um, já que o bloco contíguo
+    // não pode ser liberado nó a nó
+    if(arv->deslocamento_intrusivo < 0 && arv->pool == NULL) {
+        arv->pool = arv_pool_cria(ARV_NOS_POR_BLOCO_PADRAO, arv->tam_no);
+        if(arv->pool == NULL) return false;
+    }
+
+    // vetor temporário com o endereço do nó de cada dado, em ordem
+    No **nos = (No**)malloc(n * sizeof(No*));
+    if(nos == NULL) return false;
+
+    BlocoPool *bloco = NULL;
+    if(arv->deslocamento_intrusivo >= 0) {
+        // os nós já estão dentro dos dados
+        for(size_t i = 0; i < n; i++) {
+            nos[i] = (No*)((char*)dados[i] + arv->deslocamento_intrusivo);
+        }
+    }
+    else {
+        // todos os nós são alocados em um único bloco contíguo, que passa
+        // a fazer parte do pool da árvore
+        bloco = (BlocoPool*)malloc(sizeof(BlocoPool) + n * arv->tam_no);
+        if(bloco == NULL) {
+            free(nos);
+            return false;
+        }
+        for(size_t i = 0; i < n; i++) {
+            nos[i] = arv_pool_no(arv->pool, bloco, i);
+        }
+        ARV_EST_CONTA_N(arv, nos_alocados, n);
+    }
+
+    for(size_t i = 0; i < n; i++) {
+        nos[i]->dado = dados[i];
+        arv_guarda_prefixo(arv, nos[i]);
+    }
+
+    // nível (a partir de 0) do último nível da árvore balanceada
+    int ultimo_nivel = 0;
+    while(((size_t)2 << ultimo_nivel) - 1 < n) ultimo_nivel++;
+
+    arv->raiz = arv_constroi_rec(arv, nos, 0, n, NULL, 0, ultimo_nivel);
+    arv->num_nos = n;
+    arv->altura_preta = arv_altura_preta_de(arv->raiz);
+    free(nos);
+
+    if(bloco != NULL) {
+        // o bloco já está cheio, então entra depois do bloco atual
+        // (se tiver um) para não desperdiçar o espaço que sobrou nele
+        Pool *pool = arv->pool;
+        if(pool->blocos == NULL) {
+            bloco->prox = NULL;
+            pool->blocos = bloco;
+            pool->usados_bloco = pool->nos_por_bloco;
+        }
+        else {
+            bloco->prox = pool->blocos->prox;
+            pool->blocos->prox = bloco;
+        }
+    }
+
+    return true;
+}
+
+
+
+//// --- consultas ---
 
 bool arv_vazia(Arvore *arv) {
     if(arv == NULL) return true;
@@ -629,22 +2229,21 @@ bool arv_vazia(Arvore *arv) {
 }
 
 bool arv_no_vazio(No *no) {
-    // checar o NULL também por mais segurança
-    return no == NIL || no == NULL;
+    return no == NULL;
 }
 
-int arv_nnos(Arvore *arv) {
+size_t arv_nnos(Arvore *arv) {
     if(arv == NULL) return 0;
     return arv->num_nos;
 }
 
 No* arv_busca_raiz(Arvore *arv) {
-    if(arv == NULL) return NIL;
+    if(arv == NULL) return NULL;
     return arv->raiz;
 }
 
 No* arv_busca_filho(No *no, bool dir) {
-    if(arv_no_vazio(no)) return NIL;
+    if(arv_no_vazio(no)) return NULL;
 
     if(dir) {
         return no->dir;
@@ -659,7 +2258,7 @@ Cor arv_busca_cor(No *no) {
 }
 
 No* arv_busca_pai(No *no) {
-    if(arv_no_vazio(no)) return NIL;
+    if(arv_no_vazio(no)) return NULL;
 
     return no->pai;
 }
@@ -671,7 +2270,7 @@ void* arv_busca_valor(No *no) {
 }
 
 No* arv_busca_no(No *raiz, void *v, Comparador *comp) {
-    if(arv_no_vazio(raiz)) return NIL;
+    if(arv_no_vazio(raiz)) return NULL;
 
     No *atual = raiz;
     while(!arv_no_vazio(atual)) {
@@ -689,39 +2288,436 @@ No* arv_busca_no(No *raiz, void *v, Comparador *comp) {
     }
 
     // se chegou aqui, não achou
-    return NIL;
+    return NULL;
+}
+
+No* arv_busca(Arvore *arv, void *v) {
+    if(arv == NULL) return NULL;
+
+    ARV_EST_INICIO(inicio);
+    No *no = arv_procura(arv, v);
+    ARV_EST_FIM(arv, ARV_OP_BUSCA, inicio);
+    return no;
 }
 
 bool arv_contem(Arvore *arv, void *v) {
     if(arv == NULL) return false;
 
-    return arv_busca_no(arv->raiz, v, arv->comp) != NIL;
+    return !arv_no_vazio(arv_busca(arv, v));
 }
 
-// função auxiliar para calcular a altura da árvore
-// de forma recursiva
-static int arv_altura_rec(No *no) {
-    if(arv_no_vazio(no)) return 0;
+// número de buscas que arv_busca_multipla avança juntas. cada busca tem
+// no máximo um carregamento pendente, então é também o número de faltas
+// de cache sobrepostas
+#define ARV_BUSCA_GRUPO 16
+
+// função auxiliar que faz as `n` (no máximo ARV_BUSCA_GRUPO) buscas de
+// arv_busca_multipla juntas, e retorna quantas encontraram o valor.
+// a cada rodada, cada busca em andamento desce um nível e pede o
+// carregamento antecipado do próximo nó, que só vai ser lido na rodada
+// seguinte, depois de todas as outras buscas terem feito o mesmo. assim
+// as faltas de cache das buscas ficam sobrepostas ao invés de em série
+static size_t arv_busca_grupo(Arvore *arv, void **chaves, size_t n, No **resultados) {
+    No *atuais[ARV_BUSCA_GRUPO];
+    uint64_t prefixos[ARV_BUSCA_GRUPO];
+    // índices das buscas em andamento, em ativas[0..num_ativas)
+    size_t ativas[ARV_BUSCA_GRUPO];
+    size_t num_ativas = 0;
+
+    for(size_t i = 0; i < n; i++) {
+        resultados[i] = NULL;
+        prefixos[i] = arv_prefixo_de(arv, chaves[i]);
+        atuais[i] = arv->raiz;
+        if(!arv_no_vazio(arv->raiz)) ativas[num_ativas++] = i;
+    }
 
-    int altura_esq = arv_altura_rec(no->esq);
-    int altura_dir = arv_altura_rec(no->dir);
+    size_t encontrados = 0;
+    while(num_ativas > 0) {
+        // sem prefixo, toda comparação lê o dado do nó, então o dado é
+        // carregado antes (os nós já foram pedidos na rodada anterior)
+        if(arv->prefixo == NULL) {
+            for(size_t j = 0; j < num_ativas; j++) {
+                __builtin_prefetch(atuais[ativas[j]]->dado);
+            }
+        }
 
-    if(altura_esq > altura_dir) {
-        return 1 + altura_esq;
-    } 
-    else {
-        return 1 + altura_dir;
+        size_t j = 0;
+        while(j < num_ativas) {
+            size_t i = ativas[j];
+            No *atual = atuais[i];
+            int resultado_comp = arv_compara(arv, chaves[i], prefixos[i], atual);
+
+            if(resultado_comp == 0) {
+                resultados[i] = atual;
+                encontrados++;
+                atual = NULL;
+            }
+            else {
+                atual = resultado_comp < 0 ? atual->esq : atual->dir;
+            }
+
+            // a busca terminou, a última ativa ocupa o lugar dela
+            if(arv_no_vazio(atual)) {
+                ativas[j] = ativas[--num_ativas];
+                continue;
+            }
+
+            __builtin_prefetch(atual);
+            atuais[i] = atual;
+            j++;
+        }
     }
+
+    return encontrados;
 }
 
-int arv_altura(Arvore *arv) {
-    if(arv_vazia(arv)) return 0;
+size_t arv_busca_multipla(Arvore *arv, void **chaves, size_t n, No **resultados) {
+    if(arv == NULL || chaves == NULL || resultados == NULL) return 0;
+
+    ARV_EST_INICIO(inicio);
+    size_t encontrados = 0;
+    for(size_t base = 0; base < n; base += ARV_BUSCA_GRUPO) {
+        size_t tam_grupo = n - base < ARV_BUSCA_GRUPO ? n - base : ARV_BUSCA_GRUPO;
+        encontrados += arv_busca_grupo(arv, chaves + base, tam_grupo, resultados + base);
+    }
+    // o lote inteiro conta como uma busca nas estatísticas
+    ARV_EST_FIM(arv, ARV_OP_BUSCA, inicio);
+
+    return encontrados;
+}
+
+bool arv_guarda_tamanhos(Arvore *arv) {
+    if(arv == NULL) return false;
+
+    return arv->tamanhos;
+}
+
+Comparador* arv_comparador(Arvore *arv) {
+    if(arv == NULL) return NULL;
+
+    return arv->comp;
+}
+
+ExtratorPrefixo* arv_extrator_prefixo(Arvore *arv) {
+    if(arv == NULL) return NULL;
+
+    return arv->prefixo;
+}
+
+Liberador* arv_liberador(Arvore *arv) {
+    if(arv == NULL) return NULL;
+
+    return arv->libera;
+}
+
+// função auxiliar para calcular a altura da árvore
+// de forma recursiva
+static int arv_altura_rec(No *no) {
+    if(arv_no_vazio(no)) return 0;
+
+    int altura_esq = arv_altura_rec(no->esq);
+    int altura_dir = arv_altura_rec(no->dir);
+
+    if(altura_esq > altura_dir) {
+        return 1 + altura_esq;
+    } 
+    else {
+        return 1 + altura_dir;
+    }
+}
+
+int arv_altura(Arvore *arv) {
+    if(arv_vazia(arv)) return 0;
     
     return arv_altura_rec(arv->raiz);
 }
 
+int arv_altura_preta(Arvore *arv) {
+    if(arv == NULL) return 0;
+
+    return arv->altura_preta;
+}
+
+int arv_altura_maxima(Arvore *arv) {
+    if(arv == NULL) return 0;
+
+    return 2 * arv->altura_preta;
+}
+
+bool arv_estima_profundidades(Arvore *arv, size_t amostras, ArvProfundidades *saida) {
+    if(saida == NULL) return false;
+    memset(saida, 0, sizeof(ArvProfundidades));
+    if(arv_vazia(arv) || amostras == 0) return false;
+
+    if(amostras > arv->num_nos) amostras = arv->num_nos;
+
+    // a amostra i é o nó do meio da i-ésima fatia da ordem da árvore,
+    // achado com arv_seleciona (ou andando em ordem até ele, se a árvore
+    // não guarda os tamanhos), e a profundidade é contada subindo até a raiz
+    size_t soma = 0;
+    saida->minima = ARV_MAX_PROFUNDIDADE;
+    No *anterior = arv_iter_inicio(arv);
+    size_t k_anterior = 0;
+    for(size_t i = 0; i < amostras; i++) {
+        size_t k = (size_t)(((double)i + 0.5) * (double)arv->num_nos / (double)amostras);
+        if(k >= arv->num_nos) k = arv->num_nos - 1;
+
+        No *amostra;
+        if(arv->tamanhos) {
+            amostra = arv_seleciona(arv, k);
+        }
+        else {
+            for(; k_anterior < k; k_anterior++) anterior = arv_iter_proximo(anterior);
+            amostra = anterior;
+        }
+
+        int profundidade = 0;
+        for(No *no = amostra; !arv_no_vazio(no); no = no->pai) {
+            profundidade++;
+        }
+
+        soma += (size_t)profundidade;
+        saida->histograma[profundidade]++;
+        if(profundidade < saida->minima) saida->minima = profundidade;
+        if(profundidade > saida->maxima) saida->maxima = profundidade;
+    }
+
+    saida->amostras = amostras;
+    saida->media = (double)soma / (double)amostras;
+    return true;
+}
+
+//// --- estatísticas ---
+
+bool arv_estatisticas(Arvore *arv, ArvEstatisticas *saida) {
+    if(saida == NULL) return false;
+    memset(saida, 0, sizeof(ArvEstatisticas));
+    if(arv == NULL) return false;
+
+#ifdef ARV_ESTATISTICAS
+    // soma os contadores de todas as fatias
+    uint64_t soma[ARV_EST_NUM_CONTADORES] = { 0 };
+    for(int f = 0; f < ARV_EST_FATIAS; f++) {
+        for(size_t i = 0; i < ARV_EST_NUM_CONTADORES; i++) {
+            soma[i] += atomic_load_explicit(&arv->estatisticas[f].contadores[i], memory_order_relaxed);
+        }
+    }
+    memcpy(saida, soma, sizeof(ArvEstatisticas));
+    return true;
+#else
+    return false;
+#endif
+}
+
+void arv_zera_estatisticas(Arvore *arv) {
+    if(arv == NULL) return;
+
+#ifdef ARV_ESTATISTICAS
+    for(int f = 0; f < ARV_EST_FATIAS; f++) {
+        for(size_t i = 0; i < ARV_EST_NUM_CONTADORES; i++) {
+            atomic_store_explicit(&arv->estatisticas[f].contadores[i], 0, memory_order_relaxed);
+        }
+    }
+#endif
+}
+
+//// --- iteração ---
+
+No* arv_iter_inicio(Arvore *arv) {
+    if(arv == NULL) return NULL;
+
+    return arv_busca_minimo(arv->raiz);
+}
+
+No* arv_iter_fim(Arvore *arv) {
+    if(arv == NULL) return NULL;
+
+    return arv_busca_maximo(arv->raiz);
+}
+
+No* arv_iter_proximo(No *no) {
+    if(arv_no_vazio(no)) return NULL;
+
+    // se tem sub-árvore direita, o próximo é o menor nó dela
+    if(!arv_no_vazio(no->dir)) {
+        return arv_busca_minimo(no->dir);
+    }
+
+    // senão, sobe enquanto `no` for filho direito, o próximo é o
+    // primeiro ancestral do qual `no` está na sub-árvore esquerda
+    while(!arv_no_vazio(no->pai) && no == no->pai->dir) {
+        no = no->pai;
+    }
+    return no->pai;
+}
+
+No* arv_iter_anterior(No *no) {
+    if(arv_no_vazio(no)) return NULL;
+
+    // espelho de arv_iter_proximo
+    if(!arv_no_vazio(no->esq)) {
+        return arv_busca_maximo(no->esq);
+    }
+
+    while(!arv_no_vazio(no->pai) && no == no->pai->esq) {
+        no = no->pai;
+    }
+    return no->pai;
+}
+
+// função auxiliar que retorna o primeiro nó com valor maior ou igual a
+// `v` (se `inclusive`) ou estritamente maior que `v` (senão), ou NULL se
+// não houver. o candidato é o último nó em que a descida foi para a esquerda
+static No* arv_primeiro_a_partir(Arvore *arv, void *v, bool inclusive) {
+    No *candidato = NULL;
+    No *atual = arv->raiz;
+    uint64_t prefixo_v = arv_prefixo_de(arv, v);
+
+    while(!arv_no_vazio(atual)) {
+        int resultado_comp = arv_compara(arv, v, prefixo_v, atual);
+
+        if(resultado_comp < 0 || (inclusive && resultado_comp == 0)) {
+            candidato = atual;
+            atual = atual->esq;
+        }
+        else {
+            atual = atual->dir;
+        }
+    }
+
+    return candidato;
+}
+
+// função auxiliar que retorna o último nó com valor menor ou igual a
+// `v` (se `inclusive`) ou estritamente menor que `v` (senão), ou NULL se
+// não houver. espelho de arv_primeiro_a_partir
+static No* arv_ultimo_ate(Arvore *arv, void *v, bool inclusive) {
+    No *candidato = NULL;
+    No *atual = arv->raiz;
+    uint64_t prefixo_v = arv_prefixo_de(arv, v);
+
+    while(!arv_no_vazio(atual)) {
+        int resultado_comp = arv_compara(arv, v, prefixo_v, atual);
+
+        if(resultado_comp > 0 || (inclusive && resultado_comp == 0)) {
+            candidato = atual;
+            atual = atual->dir;
+        }
+        else {
+            atual = atual->esq;
+        }
+    }
+
+    return candidato;
+}
+
+No* arv_limite_inferior(Arvore *arv, void *v) {
+    if(arv == NULL) return NULL;
+
+    return arv_primeiro_a_partir(arv, v, true);
+}
+
+No* arv_limite_superior(Arvore *arv, void *v) {
+    if(arv == NULL) return NULL;
+
+    return arv_primeiro_a_partir(arv, v, false);
+}
+
+No* arv_piso(Arvore *arv, void *v) {
+    if(arv == NULL) return NULL;
+
+    return arv_ultimo_ate(arv, v, true);
+}
+
+No* arv_teto(Arvore *arv, void *v) {
+    if(arv == NULL) return NULL;
+
+    return arv_primeiro_a_partir(arv, v, true);
+}
+
+ArvIntervalo arv_intervalo(Arvore *arv, void *lo, void *hi) {
+    ArvIntervalo intervalo = { NULL, NULL };
+    if(arv == NULL) return intervalo;
+
+    // com `lo` > `hi` o início ficaria depois do fim
+    if(arv->comp(lo, hi) > 0) return intervalo;
+
+    intervalo.inicio = arv_limite_inferior(arv, lo);
+    intervalo.fim = arv_limite_superior(arv, hi);
+    return intervalo;
+}
+
+size_t arv_busca_tamanho(No *no) {
+    if(arv_no_vazio(no)) return 0;
+
+    return *arv_tamanho_de(no);
+}
+
+No* arv_seleciona(Arvore *arv, size_t k) {
+    if(arv == NULL) return NULL;
+    if(k >= arv->num_nos) return NULL;
+
+    // sem os tamanhos, anda `k` nós a partir do mínimo
+    if(!arv->tamanhos) {
+        No *no = arv_iter_inicio(arv);
+        for(; k > 0; k--) no = arv_iter_proximo(no);
+        return no;
+    }
+
+    // desce sabendo quantos nós tem a esquerda de cada nó: se `k` é menor,
+    // o nó está na sub-árvore esquerda, senão pula esses nós (e o próprio
+    // nó) e procura na sub-árvore direita
+    No *atual = arv->raiz;
+    while(!arv_no_vazio(atual)) {
+        size_t tam_esq = arv_busca_tamanho(atual->esq);
+
+        if(k < tam_esq) {
+            atual = atual->esq;
+        }
+        else if(k == tam_esq) {
+            return atual;
+        }
+        else {
+            k -= tam_esq + 1;
+            atual = atual->dir;
+        }
+    }
+
+    // `k` maior que o número de nós
+    return NULL;
+}
+
+size_t arv_posto(Arvore *arv, void *v) {
+    if(arv == NULL) return 0;
+
+    // sem os tamanhos, conta os nós antes do primeiro maior ou igual a `v`
+    if(!arv->tamanhos) {
+        No *limite = arv_limite_inferior(arv, v);
+        size_t posto = 0;
+        for(No *no = arv_iter_inicio(arv); no != limite; no = arv_iter_proximo(no)) posto++;
+        return posto;
+    }
+
+    // soma os nós que ficam a esquerda do caminho de busca de `v`,
+    // descendo para a esquerda também nos iguais para contar só os menores
+    size_t posto = 0;
+    uint64_t prefixo_v = arv_prefixo_de(arv, v);
+    No *atual = arv->raiz;
+    while(!arv_no_vazio(atual)) {
+        if(arv_compara(arv, v, prefixo_v, atual) <= 0) {
+            atual = atual->esq;
+        }
+        else {
+            posto += arv_busca_tamanho(atual->esq) + 1;
+            atual = atual->dir;
+        }
+    }
+
+    return posto;
+}
+
 No* arv_busca_minimo(No *raiz) {
-    if(arv_no_vazio(raiz)) return NIL;
+    if(arv_no_vazio(raiz)) return NULL;
 
     No *menor = raiz;
 
@@ -733,7 +2729,7 @@ No* arv_busca_minimo(No *raiz) {
 }
 
 No* arv_busca_maximo(No *raiz) {
-    if(arv_no_vazio(raiz)) return NIL;
+    if(arv_no_vazio(raiz)) return NULL;
 
     No *maior = raiz;
 
@@ -743,3 +2739,375 @@ No* arv_busca_maximo(No *raiz) {
 
     return maior;
 }
+
+
+
+//// --- percurso paralelo ---
+
+// sub-árvores por thread, para as threads que pegam sub-árvores menores
+// poderem pegar mais delas
+#define ARV_PARALELO_PARTES_POR_THREAD 8
+#define ARV_PARALELO_MAX_PROFUNDIDADE 12
+#define ARV_PARALELO_MAX_THREADS 256
+
+// parte da árvore no processamento paralelo: uma sub-árvore inteira ou
+// um só nó dos níveis acima das sub-árvores
+typedef struct {
+    No *no;
+    bool sub_arvore;
+} ParteParalela;
+
+typedef struct trabalho_paralelo TrabalhoParalelo;
+
+// estado compartilhado pelas threads de uma operação paralela
+struct trabalho_paralelo {
+    // partes da árvore, na ordem da árvore
+    ParteParalela *partes;
+    size_t num_partes;
+    // próxima parte que ainda não foi pega por nenhuma thread
+    atomic_size_t proxima;
+
+    // processa a sub-árvore `raiz`, guardando o resultado em `parcial`
+    void (*processa)(TrabalhoParalelo *trabalho, No *raiz, void *parcial);
+    // um resultado parcial de `tam_parcial` bytes por parte, ou NULL
+    unsigned char *parciais;
+    size_t tam_parcial;
+
+    // argumentos da operação
+    Visitante *visita;
+    Acumulador *acumula;
+    const void *inicial;
+    Liberador *libera;
+    void *contexto;
+};
+
+// função auxiliar que retorna quantas threads usar para a árvore
+static int arv_num_threads(Arvore *arv, int num_threads) {
+    if(arv->num_nos < ARV_PARALELO_MIN_NOS) return 1;
+
+    if(num_threads <= 0) {
+        long processadores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = processadores > 0 ? (int)processadores : 1;
+    }
+    if(num_threads > ARV_PARALELO_MAX_THREADS) num_threads = ARV_PARALELO_MAX_THREADS;
+    return num_threads;
+}
+
+// função auxiliar que guarda em `partes`, na ordem da árvore, as
+// sub-árvores da profundidade `prof` abaixo de `no` e os nós acima delas
+static void arv_divide_partes(No *no, int prof, ParteParalela *partes, size_t *num_partes) {
+    if(arv_no_vazio(no)) return;
+
+    if(prof == 0) {
+        partes[(*num_partes)++] = (ParteParalela){ no, true };
+        return;
+    }
+
+    arv_divide_partes(no->esq, prof - 1, partes, num_partes);
+    partes[(*num_partes)++] = (ParteParalela){ no, false };
+    arv_divide_partes(no->dir, prof - 1, partes, num_partes);
+}
+
+// função executada por cada thread: pega a próxima sub-árvore livre até
+// não sobrar nenhuma
+static void* arv_trabalha(void *arg) {
+    TrabalhoParalelo *trabalho = (TrabalhoParalelo*)arg;
+
+    while(true) {
+        size_t i = atomic_fetch_add_explicit(&trabalho->proxima, 1, memory_order_relaxed);
+        if(i >= trabalho->num_partes) break;
+        if(!trabalho->partes[i].sub_arvore) continue;
+
+        void *parcial = NULL;
+        if(trabalho->parciais != NULL) parcial = trabalho->parciais + i * trabalho->tam_parcial;
+        trabalho->processa(trabalho, trabalho->partes[i].no, parcial);
+    }
+
+    return NULL;
+}
+
+// função auxiliar que divide a árvore e processa as sub-árvores com
+// `num_threads` threads, contando a atual. os nós acima das sub-árvores
+// ficam para o chamador, que também libera `partes` e `parciais`.
+// retorna false em caso de falha de alocação (e nada foi processado)
+static bool arv_executa_paralelo(Arvore *arv, int num_threads, TrabalhoParalelo *trabalho) {
+    int prof = 0;
+    while(prof < ARV_PARALELO_MAX_PROFUNDIDADE &&
+          ((size_t)1 << prof) < (size_t)num_threads * ARV_PARALELO_PARTES_POR_THREAD) {
+        prof++;
+    }
+
+    // até 2^prof sub-árvores e 2^prof - 1 nós acima delas
+    trabalho->partes = (ParteParalela*)malloc(((size_t)2 << prof) * sizeof(ParteParalela));
+    if(trabalho->partes == NULL) return false;
+    trabalho->num_partes = 0;
+    arv_divide_partes(arv->raiz, prof, trabalho->partes, &trabalho->num_partes);
+
+    trabalho->parciais = NULL;
+    if(trabalho->tam_parcial > 0) {
+        trabalho->parciais = (unsigned char*)malloc(trabalho->num_partes * trabalho->tam_parcial);
+        if(trabalho->parciais == NULL) {
+            free(trabalho->partes);
+            return false;
+        }
+    }
+    atomic_init(&trabalho->proxima, 0);
+
+    // se alguma thread não puder ser criada, as outras fazem a parte dela
+    pthread_t *threads = (pthread_t*)malloc((size_t)(num_threads - 1) * sizeof(pthread_t));
+    int criadas = 0;
+    if(threads != NULL) {
+        while(criadas < num_threads - 1 &&
+              pthread_create(&threads[criadas], NULL, arv_trabalha, trabalho) == 0) {
+            criadas++;
+        }
+    }
+
+    arv_trabalha(trabalho);
+
+    for(int i = 0; i < criadas; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    return true;
+}
+
+// função auxiliar que visita os dados da sub-árvore `raiz` em ordem,
+// parando no máximo da sub-árvore
+static void arv_processa_visita(TrabalhoParalelo *trabalho, No *raiz, void *parcial) {
+    (void)parcial;
+
+    No *ultimo = arv_busca_maximo(raiz);
+    for(No *atual = arv_busca_minimo(raiz); ; atual = arv_iter_proximo(atual)) {
+        trabalho->visita(atual->dado, trabalho->contexto);
+        if(atual == ultimo) break;
+    }
+}
+
+void arv_percorre_paralelo(Arvore *arv, int num_threads, Visitante *visita, void *contexto) {
+    if(arv == NULL || visita == NULL || arv_vazia(arv)) return;
+
+    TrabalhoParalelo trabalho = { 0 };
+    trabalho.processa = arv_processa_visita;
+    trabalho.visita = visita;
+    trabalho.contexto = contexto;
+
+    int threads = arv_num_threads(arv, num_threads);
+    if(threads <= 1 || !arv_executa_paralelo(arv, threads, &trabalho)) {
+        arv_processa_visita(&trabalho, arv->raiz, NULL);
+        return;
+    }
+
+    for(size_t i = 0; i < trabalho.num_partes; i++) {
+        if(!trabalho.partes[i].sub_arvore) visita(trabalho.partes[i].no->dado, contexto);
+    }
+    free(trabalho.partes);
+}
+
+// função auxiliar que acumula os dados da sub-árvore `raiz`, em ordem, no
+// resultado parcial `parcial`, que começa com o valor inicial
+static void arv_processa_reducao(TrabalhoParalelo *trabalho, No *raiz, void *parcial) {
+    if(parcial != trabalho->inicial) memcpy(parcial, trabalho->inicial, trabalho->tam_parcial);
+
+    No *ultimo = arv_busca_maximo(raiz);
+    for(No *atual = arv_busca_minimo(raiz); ; atual = arv_iter_proximo(atual)) {
+        trabalho->acumula(parcial, atual->dado, trabalho->contexto);
+        if(atual == ultimo) break;
+    }
+}
+
+void arv_reduz_paralelo(Arvore *arv, int num_threads, void *resultado, size_t tam_resultado,
+                        Acumulador *acumula, Combinador *combina, void *contexto) {
+    if(arv == NULL || resultado == NULL || tam_resultado == 0) return;
+    if(acumula == NULL || combina == NULL || arv_vazia(arv)) return;
+
+    TrabalhoParalelo trabalho = { 0 };
+    trabalho.processa = arv_processa_reducao;
+    trabalho.tam_parcial = tam_resultado;
+    trabalho.acumula = acumula;
+    trabalho.inicial = resultado;
+    trabalho.contexto = contexto;
+
+    // só com a thread atual, os dados são acumulados direto no resultado
+    int threads = arv_num_threads(arv, num_threads);
+    if(threads <= 1 || !arv_executa_paralelo(arv, threads, &trabalho)) {
+        arv_processa_reducao(&trabalho, arv->raiz, resultado);
+        return;
+    }
+
+    // junta as partes na ordem da árvore. `resultado` ainda tem o valor
+    // inicial, já que as threads só leram dele
+    for(size_t i = 0; i < trabalho.num_partes; i++) {
+        ParteParalela *parte = &trabalho.partes[i];
+        if(parte->sub_arvore) {
+            combina(resultado, trabalho.parciais + i * tam_resultado, contexto);
+        }
+        else {
+            acumula(resultado, parte->no->dado, contexto);
+        }
+    }
+    free(trabalho.parciais);
+    free(trabalho.partes);
+}
+
+// função auxiliar que libera os nós e os dados da sub-árvore `raiz`
+static void arv_processa_libera_nos(TrabalhoParalelo *trabalho, No *raiz, void *parcial) {
+    (void)parcial;
+    arv_libera_no(raiz, trabalho->libera);
+}
+
+// função auxiliar que libera só os dados da sub-árvore `raiz`, quando os
+// nós são do pool ou fazem parte dos dados
+static void arv_processa_libera_dados(TrabalhoParalelo *trabalho, No *raiz, void *parcial) {
+    (void)parcial;
+    arv_libera_dados(raiz, trabalho->libera);
+}
+
+bool arv_define_threads_liberacao(Arvore *arv, int num_threads) {
+    if(arv == NULL || num_threads < 0) return false;
+
+    arv->threads_liberacao = num_threads;
+    return true;
+}
+
+void arv_libera_arvore_paralelo(Arvore *arv, int num_threads) {
+    if(arv == NULL) return;
+
+    // com o pool, ou na árvore intrusiva, só os dados são liberados um a um
+    bool so_dados = arv->deslocamento_intrusivo >= 0 || arv->pool != NULL;
+    bool pool_compartilhado = arv->pool != NULL && arv->pool->referencias > 1;
+
+    int threads = arv_num_threads(arv, num_threads);
+    if(threads <= 1 || pool_compartilhado || (so_dados && arv->libera == NULL)) {
+        arv_libera_sequencial(arv);
+        return;
+    }
+
+    TrabalhoParalelo trabalho = { 0 };
+    trabalho.processa = so_dados ? arv_processa_libera_dados : arv_processa_libera_nos;
+    trabalho.libera = arv->libera;
+    if(!arv_executa_paralelo(arv, threads, &trabalho)) {
+        arv_libera_sequencial(arv);
+        return;
+    }
+
+    // as sub-árvores já foram liberadas, faltam os nós acima delas
+    for(size_t i = 0; i < trabalho.num_partes; i++) {
+        if(trabalho.partes[i].sub_arvore) continue;
+
+        No *no = trabalho.partes[i].no;
+        if(arv->libera != NULL) arv->libera(no->dado);
+        if(!so_dados) free(no);
+    }
+    free(trabalho.partes);
+
+    // o resto (os blocos do pool e o descritor) é liberado com a árvore vazia
+    arv->raiz = NULL;
+    arv->num_nos = 0;
+    arv_libera_sequencial(arv);
+}
+
+
+
+//// --- agregados ---
+
+// número máximo de pedaços do lado esquerdo do intervalo em
+// arv_agrega_intervalo: até dois por nível do caminho (o nó e a sub-árvore
+// direita dele), mais a sub-árvore esquerda inteira do nó em que a
+// descida termina quando não há limite inferior
+#define ARV_PEDACOS_AGREGADO (2 * ARV_MAX_PROFUNDIDADE + 1)
+
+// pedaço do intervalo somado por arv_agrega_intervalo: só o dado do nó,
+// ou o agregado da sub-árvore inteira dele
+typedef struct {
+    No *no;
+    bool sub_arvore;
+} PedacoAgregado;
+
+// função auxiliar que junta o pedaço `pedaco` ao resultado `resultado`
+static void arv_agrega_pedaco(Arvore *arv, void *resultado, PedacoAgregado pedaco) {
+    if(pedaco.sub_arvore) {
+        arv->combina(resultado, arv_agregado_de(pedaco.no), arv->contexto_agregado);
+    }
+    else {
+        arv->acumula(resultado, pedaco.no->dado, arv->contexto_agregado);
+    }
+}
+
+bool arv_agrega_intervalo(Arvore *arv, void *lo, void *hi, void *resultado) {
+    if(arv == NULL || resultado == NULL) return false;
+    if(arv->acumula == NULL) return false;
+
+    memcpy(resultado, arv->agregado_inicial, arv->tam_agregado);
+
+    // os prefixos dos limites são calculados uma vez só para as descidas
+    uint64_t prefixo_lo = lo != NULL ? arv_prefixo_de(arv, lo) : 0;
+    uint64_t prefixo_hi = hi != NULL ? arv_prefixo_de(arv, hi) : 0;
+
+    // desce até o primeiro nó dentro do intervalo, onde os caminhos até
+    // `lo` e até `hi` se separam
+    No *divisao = arv->raiz;
+    while(!arv_no_vazio(divisao)) {
+        if(lo != NULL && arv_compara(arv, lo, prefixo_lo, divisao) > 0) {
+            divisao = divisao->dir;
+            continue;
+        }
+        if(hi != NULL && arv_compara(arv, hi, prefixo_hi, divisao) < 0) {
+            divisao = divisao->esq;
+            continue;
+        }
+        break;
+    }
+    // nenhum nó no intervalo
+    if(arv_no_vazio(divisao)) return true;
+
+    // lado esquerdo: cada nó >= `lo` entra com a sua sub-árvore direita,
+    // e os pedaços são achados do último para o primeiro
+    PedacoAgregado esquerda[ARV_PEDACOS_AGREGADO];
+    size_t num_esquerda = 0;
+    for(No *no = divisao->esq; !arv_no_vazio(no); ) {
+        if(lo == NULL || arv_compara(arv, lo, prefixo_lo, no) <= 0) {
+            if(!arv_no_vazio(no->dir)) esquerda[num_esquerda++] = (PedacoAgregado){ no->dir, true };
+            esquerda[num_esquerda++] = (PedacoAgregado){ no, false };
+            // sem limite inferior, a sub-árvore esquerda entra inteira
+            if(lo == NULL) {
+                if(!arv_no_vazio(no->esq)) esquerda[num_esquerda++] = (PedacoAgregado){ no->esq, true };
+                break;
+            }
+            no = no->esq;
+        }
+        else {
+            no = no->dir;
+        }
+    }
+    while(num_esquerda > 0) arv_agrega_pedaco(arv, resultado, esquerda[--num_esquerda]);
+
+    arv->acumula(resultado, divisao->dado, arv->contexto_agregado);
+
+    // lado direito: cada nó <= `hi` entra com a sua sub-árvore esquerda,
+    // já na ordem da árvore
+    for(No *no = divisao->dir; !arv_no_vazio(no); ) {
+        if(hi == NULL || arv_compara(arv, hi, prefixo_hi, no) >= 0) {
+            if(!arv_no_vazio(no->esq)) arv_agrega_pedaco(arv, resultado, (PedacoAgregado){ no->esq, true });
+            arv_agrega_pedaco(arv, resultado, (PedacoAgregado){ no, false });
+            // sem limite superior, a sub-árvore direita entra inteira
+            if(hi == NULL) {
+                if(!arv_no_vazio(no->dir)) arv_agrega_pedaco(arv, resultado, (PedacoAgregado){ no->dir, true });
+                break;
+            }
+            no = no->dir;
+        }
+        else {
+            no = no->esq;
+        }
+    }
+
+    return true;
+}
+
+const void* arv_busca_agregado(No *no) {
+    if(arv_no_vazio(no)) return NULL;
+
+    return arv_agregado_de(no);
+}
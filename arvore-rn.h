@@ -13,15 +13,47 @@
 // que a árvore utilizará para liberar o dado apontado pelo nó 
 // completamente em casos de remoção ou liberação total da árvore.
 //
+// na árvore intrusiva (arv_cria_intrusiva), o próprio dado do usuário
+// possui um campo do tipo `No`, e a árvore usa esse campo como nó ao
+// invés de alocar um nó separado para apontar para o dado.
 //
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 //// --- tipos exportados ---
 typedef struct no No;
 typedef struct arvore Arvore;
 typedef enum { VERMELHO, PRETO } Cor;
 
+// intervalo de nós consecutivos da árvore, devolvido por arv_intervalo.
+// `inicio` é o primeiro nó do intervalo e `fim` é o primeiro nó depois
+// do intervalo (NULL se o intervalo vai até o último nó), então o
+// intervalo é percorrido com:
+//   for(No *no = it.inicio; no != it.fim; no = arv_iter_proximo(no))
+typedef struct {
+    No *inicio;
+    No *fim;
+} ArvIntervalo;
+
+// estrutura de um nó da árvore rubro-negra.
+// ela é exportada apenas para poder ser embutida nos dados de uma
+// árvore intrusiva, os campos só devem ser acessados pela árvore
+// (use as funções de consulta para isso).
+struct no {
+    void *dado;
+    Cor cor;
+    No *dir;
+    No *esq;
+    No *pai;
+};
+
+// retorna um ponteiro para o dado do tipo `tipo` que embute o nó `no`
+// no campo `campo`, para ser usado com a árvore intrusiva.
+#define ARV_REGISTRO(no, tipo, campo) \
+    ((tipo*)((char*)(no) - offsetof(tipo, campo)))
+
 // a função recebe ponteiros para dois dados, e retorna um inteiro
 // com o resultado da comparação, que deve ser:
 //   - positivo se o primeiro item tem "valor" maior que o segundo,
@@ -34,10 +66,66 @@ typedef int Comparador(void *dado1, void *dado2);
 // pelo dado.
 typedef void Liberador(void *dado);
 
+// operações com latência medida pelas estatísticas da árvore
+typedef enum { ARV_OP_INSERE, ARV_OP_REMOVE, ARV_OP_BUSCA, ARV_NUM_OPS } ArvOperacao;
+
+// número de faixas dos histogramas de latência. a faixa i conta as
+// operações que levaram de 2^i a 2^(i+1) - 1 nanossegundos (a última
+// faixa conta também as mais lentas)
+#define ARV_FAIXAS_LATENCIA 32
+
+// estatísticas de uma árvore, devolvidas por arv_estatisticas.
+// só são coletadas se a biblioteca for compilada com ARV_ESTATISTICAS
+// definido (make ESTATISTICAS=1)
+typedef struct {
+    // chamadas ao comparador, e comparações resolvidas só pelo prefixo
+    uint64_t comparacoes;
+    uint64_t comparacoes_prefixo;
+    // rotações (esquerda e direita) feitas pelas correções
+    uint64_t rotacoes;
+    // iterações dos laços de correção da inserção e da remoção
+    uint64_t iteracoes_fixup_insercao;
+    uint64_t iteracoes_fixup_remocao;
+    // nós pegos do alocador (malloc ou pool) e devolvidos a ele
+    uint64_t nos_alocados;
+    uint64_t nos_liberados;
+    // quantas operações de cada tipo foram feitas e o histograma das
+    // suas latências (arv_insere_no, arv_remove_no e arv_busca/arv_contem)
+    uint64_t operacoes[ARV_NUM_OPS];
+    uint64_t latencias[ARV_NUM_OPS][ARV_FAIXAS_LATENCIA];
+} ArvEstatisticas;
+
+// a função recebe um ponteiro para um dado e retorna um prefixo da sua
+// chave que respeita a ordem do Comparador: se o prefixo de um dado for
+// menor que o de outro, o dado também deve ser menor que o outro.
+// prefixos iguais não dizem nada, e aí o Comparador decide.
+typedef uint64_t ExtratorPrefixo(void *dado);
+
+// a função recebe um dado visitado por uma das funções de percurso ou de
+// consulta da biblioteca (desta árvore e das variantes em arvore-rn-*.h)
+// e o contexto passado pelo usuário. cada função diz se a visitante pode
+// alterar o dado ou ser chamada por várias threads ao mesmo tempo.
+typedef void Visitante(void *dado, void *contexto);
+
+// a função acumula o dado `dado` no resultado parcial `acumulado`, para
+// arv_reduz_paralelo (onde é chamada ao mesmo tempo por várias threads,
+// cada uma com o seu resultado parcial) e para o agregado da árvore
+// (ver arv_define_agregado).
+typedef void Acumulador(void *acumulado, void *dado, void *contexto);
+
+// a função junta o resultado parcial `outro` (que vem depois na ordem da
+// árvore) ao resultado `acumulado`, para arv_reduz_paralelo e para o
+// agregado da árvore.
+typedef void Combinador(void *acumulado, void *outro, void *contexto);
+
 
 
 //// --- criação / destruição ---
 
+// árvores diferentes não compartilham nenhum estado, então cada árvore
+// pode ser usada por uma thread diferente sem sincronização. já uma
+// mesma árvore não deve ser acessada por mais de uma thread ao mesmo tempo.
+
 // cria e retorna uma árvore rubro-negra vazia.
 // retorna um ponteiro para nova árvore ou NULL em caso de falha de alocação.
 // se `libera` for NULL, a árvore não liberará a memória alocado pelos dados
@@ -45,25 +133,201 @@ typedef void Liberador(void *dado);
 // quem chamar deve liberar com arv_libera_arvore quando não for mais útil.
 Arvore* arv_cria(Comparador *comp, Liberador *libera);
 
+// cria e retorna uma árvore rubro-negra vazia que aloca seus nós em
+// blocos de `nos_por_bloco` nós, ao invés de um malloc por nó.
+// nós removidos são reaproveitados nas próximas inserções, e todos os
+// blocos são liberados de uma vez por arv_libera_arvore.
+// retorna NULL em caso de falha de alocação ou se `nos_por_bloco` for 0.
+Arvore* arv_cria_com_pool(Comparador *comp, Liberador *libera, size_t nos_por_bloco);
+
+// cria e retorna uma árvore rubro-negra intrusiva vazia.
+// os dados inseridos devem embutir um campo do tipo `No`, que fica a
+// `deslocamento` bytes do início do dado (use offsetof(tipo, campo)).
+// a árvore não aloca nenhum nó, e o comparador recebe os próprios dados,
+// assim como na árvore comum. em uma remoção, o liberador recebe o dado
+// que contém o nó (o nó não pode ser usado depois disso).
+// um dado só pode estar em uma árvore por campo `No` que possuir.
+// retorna NULL em caso de falha de alocação.
+Arvore* arv_cria_intrusiva(Comparador *comp, Liberador *libera, size_t deslocamento);
+
 // libera toda a árvore rubro-negra. se a árvore possuir uma função de 
 // liberação, libera toda a memória ocupada pelos dados também.
+// árvores grandes são liberadas em várias threads, como em
+// arv_libera_arvore_paralelo, se arv_define_threads_liberacao pediu.
 void arv_libera_arvore(Arvore *arv);
 
+// faz a árvore guardar em cada nó o prefixo do dado calculado por
+// `extrator`. nas descidas (busca, inserção, remoção e buscas por limite)
+// os nós com prefixo diferente do valor procurado são ordenados só pelo
+// prefixo, que está no próprio nó, e o comparador só é chamado quando
+// os prefixos empatam, sem acessar o dado.
+// o prefixo não faz parte de `No`: ele ocupa 8 bytes a mais alocados com
+// cada nó só nas árvores que usam prefixo, então as outras não pagam nada.
+// só pode ser chamada com a árvore vazia (e, se ela usa pool, antes do
+// pool ter alocado algum nó), retorna false se não estiver ou se a árvore
+// for intrusiva, já que o nó embutido no dado não tem espaço para o
+// prefixo. `extrator` NULL desliga o prefixo.
+bool arv_define_prefixo(Arvore *arv, ExtratorPrefixo *extrator);
+
+// extrator de prefixo para strings comparadas com strcmp: os primeiros
+// 8 bytes da string (completados com zeros) como um inteiro big-endian.
+uint64_t arv_prefixo_str(void *dado);
+
+// define se as inserções da árvore `arv` recusam valores iguais (pelo
+// comparador) a um que já está na árvore. por padrão os repetidos são
+// aceitos, e ficam à direita dos iguais.
+// só pode ser chamada com a árvore vazia, retorna false se não estiver.
+bool arv_define_unicos(Arvore *arv, bool unicos);
+
+// define se a árvore guarda em cada nó o número de nós da sua sub-árvore,
+// que arv_seleciona, arv_posto e arv_estima_profundidades usam para
+// responder em O(logn). o tamanho ocupa 8 bytes a mais alocados com cada
+// nó, e é atualizado subindo do nó alterado até a raiz a cada inserção e
+// remoção, então só as árvores que usam essas consultas devem ligá-lo.
+// por padrão a árvore não guarda os tamanhos.
+// só pode ser chamada com a árvore vazia (e, se ela usa pool, antes do
+// pool ter alocado algum nó), retorna false se não estiver ou se a árvore
+// for intrusiva e `tamanhos` for true.
+bool arv_define_tamanhos(Arvore *arv, bool tamanhos);
+
+// faz a árvore guardar em cada nó um agregado de `tam_agregado` bytes da
+// sua sub-árvore: `inicial` (o elemento neutro de `combina`, copiado pela
+// árvore) acumulado, com `acumula`, com os dados da sub-árvore em ordem.
+// o agregado de um nó é montado com o do filho esquerdo, o dado do nó e o
+// do filho direito, e é recalculado nos caminhos alterados pelas
+// inserções, remoções e rotações, então as duas funções devem ser
+// associativas (como em arv_reduz_paralelo) e só podem depender dos dados.
+// arv_agrega_intervalo usa os agregados para responder em O(log n).
+// só pode ser chamada com a árvore vazia (e, se ela usa pool, antes do
+// pool ter alocado algum nó), retorna false se não estiver ou se a árvore
+// for intrusiva. `acumula` NULL desliga o agregado.
+bool arv_define_agregado(Arvore *arv, size_t tam_agregado, const void *inicial,
+                         Acumulador *acumula, Combinador *combina, void *contexto);
+
 
 
 //// --- inserção/remoção ---
 
 // insere na árvore rubro-negra o nó com o valor apontado por `v`.
 // `v` deve apontar para uma região de memória alocada pelo usuário.
-// retorna true se for bem sucedido ou false caso não.
+// retorna true se for bem sucedido ou false caso não (inclusive se a
+// árvore recusa repetidos e já tem um valor igual, ver arv_define_unicos,
+// e nesse caso `v` continua sendo do usuário).
 bool arv_insere_no(Arvore *arv, void *v);
 
+// busca um valor igual a `v` e, se não houver, insere `v`, com uma
+// única descida.
+// retorna o nó encontrado (e `v` continua sendo do usuário) ou o novo
+// nó com `v`, ou NULL em caso de falha de alocação.
+No* arv_insere_ou_busca(Arvore *arv, void *v);
+
+// busca um valor igual a `v` e troca o dado do nó encontrado por `v`,
+// liberando o dado antigo se a árvore possuir uma função de liberação.
+// se não houver, insere `v`. tudo com uma única descida.
+// na árvore intrusiva, o nó embutido em `v` é que ocupa o lugar do nó
+// encontrado.
+// retorna true se for bem sucedido ou false caso não.
+bool arv_atualiza(Arvore *arv, void *v);
+
+// insere na árvore rubro-negra os `n` dados do vetor `dados`.
+// o vetor é ordenado (com o comparador da árvore) e cada dado é inserido
+// descendo a partir de um ancestral do dado inserido anteriormente, ao
+// invés de descer desde a raiz. se a árvore estiver vazia, ela é
+// construída direto como em arv_constroi_ordenado.
+// retorna quantos dados foram inseridos, que ficam no começo do vetor,
+// em ordem. os outros (os repetidos, se a árvore os recusa, e os que
+// sobraram em caso de falha de alocação) ficam depois deles e continuam
+// sendo do usuário. se algum dado for NULL, nada é inserido.
+size_t arv_insere_lote(Arvore *arv, void **dados, size_t n);
+
 // remove da árvore rubro-negra o nó com o valor apontado por `v`.
 // se a árvore possuir uma função de liberação, libera a memória ocupada 
 // pelo dado também.
 // retorna true se for bem sucedido ou false caso não.
 bool arv_remove_no(Arvore *arv, void *v);
 
+// remove da árvore rubro-negra o nó `no`, que deve ser um nó de `arv`
+// (devolvido por uma busca, iteração ou inserção), sem buscar de novo.
+// se a árvore possuir uma função de liberação, libera a memória ocupada
+// pelo dado também.
+// a remoção nunca troca os dados entre os nós: se `no` tem 2 filhos, o
+// sucessor é religado no lugar dele, então os ponteiros para os outros
+// nós continuam apontando para os mesmos dados.
+// a remoção não faz nenhuma comparação, e as correções de cores fazem
+// O(1) rotações amortizadas, então ela custa O(1) amortizado nas árvores
+// sem tamanhos nem agregado. se a árvore guarda os tamanhos das
+// sub-árvores (ver arv_define_tamanhos) ou um agregado (ver
+// arv_define_agregado), eles são atualizados nos ancestrais do nó até a
+// raiz, e a remoção custa O(logn) como arv_remove_no.
+// retorna true se for bem sucedido ou false caso não.
+bool arv_remove_no_handle(Arvore *arv, No *no);
+
+
+
+//// --- junção / divisão / operações de conjunto ---
+
+// as operações abaixo movem nós inteiros entre as árvores, sem realocar,
+// sempre que as duas árvores alocam seus nós do mesmo jeito (se não, os
+// nós de `outra` são copiados com o alocador de `arv`). as duas árvores
+// devem ter o mesmo comparador e guardar o mesmo tipo de dado.
+// todas elas retornam false em caso de falha de alocação, sem alterar
+// nenhuma das árvores.
+
+// move todos os dados de `outra` para `arv`, em O(log n). todos os dados
+// de uma das árvores devem ser menores ou iguais a todos os dados da
+// outra (em qualquer ordem), senão retorna false sem fazer nada.
+// se `arv` recusa repetidos (ver arv_define_unicos), `outra` também deve
+// recusar, e os dados de uma devem ser estritamente menores que os da
+// outra: com o maior dado de uma igual ao menor da outra, também retorna
+// false sem fazer nada.
+// `outra` fica vazia, e ainda deve ser liberada com arv_libera_arvore.
+bool arv_junta(Arvore *arv, Arvore *outra);
+
+// divide `arv` em duas árvores novas, em O(log n): `*menores`, com os
+// dados menores que `chave`, e `*maiores`, com os dados maiores ou iguais
+// a `chave`. as duas têm a mesma configuração de `arv` (se `arv` usa pool,
+// as três passam a compartilhar o pool, e então não podem ser usadas em
+// threads diferentes ao mesmo tempo). `arv` fica vazia, e as três devem
+// ser liberadas com arv_libera_arvore.
+bool arv_divide(Arvore *arv, void *chave, Arvore **menores, Arvore **maiores);
+
+// as operações de conjunto tratam cada árvore como um conjunto (dados
+// iguais segundo o comparador são o mesmo elemento) e custam
+// O(m log(n/m + 1)), com m e n os tamanhos da menor e da maior árvore.
+// o resultado fica em `arv`, e `outra` sempre fica vazia: os dados de
+// `outra` que não vão para o resultado são liberados pelo liberador de
+// `outra`, e os de `arv` que saem do resultado pelo liberador de `arv`.
+// `outra` ainda deve ser liberada com arv_libera_arvore.
+// as operações são feitas só pela thread que chamou.
+
+// `arv` passa a ter os dados das duas árvores. quando as duas têm dados
+// iguais, fica o dado de `arv`. se `arv` recusa repetidos, `outra` também
+// deve recusar, senão retorna false sem fazer nada.
+bool arv_uniao(Arvore *arv, Arvore *outra);
+
+// `arv` passa a ter só os seus dados que também estão em `outra`.
+bool arv_intersecao(Arvore *arv, Arvore *outra);
+
+// `arv` passa a ter só os seus dados que não estão em `outra`.
+bool arv_diferenca(Arvore *arv, Arvore *outra);
+
+
+
+//// --- construção em lote ---
+
+// constrói, a partir de uma árvore vazia, a árvore com os `n` dados do
+// vetor `dados`, que já devem estar em ordem crescente (segundo o
+// comparador da árvore). a árvore resultante é perfeitamente balanceada,
+// e é construída em tempo linear, sem nenhuma comparação além da
+// conferência da ordem e com todos os nós em uma única alocação (que passa
+// a fazer parte do pool da árvore, como em arv_cria_com_pool).
+// assim como em arv_insere_no, os dados passam a ser da árvore.
+// retorna true se for bem sucedido, ou false se a árvore não estiver
+// vazia, se os dados não estiverem ordenados (ou tiverem repetidos, se a
+// árvore os recusa) ou em falha de alocação
+// (nesses casos a árvore não é alterada).
+bool arv_constroi_ordenado(Arvore *arv, void **dados, size_t n);
+
 
 
 //// --- consultas ---
@@ -72,11 +336,11 @@ bool arv_remove_no(Arvore *arv, void *v);
 bool arv_vazia(Arvore *arv);
 
 // retorna true se o nó for vazio.
-// um nó vazio é um nó NIL.
+// um nó vazio é um nó NIL, que é representado por NULL.
 bool arv_no_vazio(No *no);
 
-// retorna o número de nós da árvore.
-int arv_nnos(Arvore *arv);
+// retorna o número de nós da árvore, em O(1).
+size_t arv_nnos(Arvore *arv);
 
 // retorna um ponteiro para o nó raiz da árvore.
 No* arv_busca_raiz(Arvore *arv);
@@ -100,12 +364,220 @@ void* arv_busca_valor(No *no);
 // procura a partir do nó `raiz`.
 No* arv_busca_no(No *raiz, void *v, Comparador *comp);
 
+// retorna o nó da árvore com o valor `v`, ou NULL se não houver.
+// diferente de arv_busca_no, usa o prefixo dos nós (arv_define_prefixo).
+No* arv_busca(Arvore *arv, void *v);
+
 // retorna true se a árvore conter o valor `v` ou false senão conter.
 bool arv_contem(Arvore *arv, void *v);
 
-// retorna a altura da árvore.
+// busca os `n` valores de `chaves` e guarda em `resultados[i]` o nó com o
+// valor igual a `chaves[i]`, ou NULL se não houver, como arv_busca.
+// as buscas são feitas em grupos que descem a árvore juntos, carregando
+// antecipadamente o próximo nó de cada uma, então o tempo de espera pela
+// memória de uma busca se sobrepõe ao das outras.
+// retorna quantos valores foram encontrados.
+size_t arv_busca_multipla(Arvore *arv, void **chaves, size_t n, No **resultados);
+
+// retorna true se a árvore guarda o tamanho das sub-árvores (ver
+// arv_define_tamanhos).
+bool arv_guarda_tamanhos(Arvore *arv);
+
+// retorna a função de comparação da árvore.
+Comparador* arv_comparador(Arvore *arv);
+
+// retorna o extrator de prefixo da árvore (ver arv_define_prefixo),
+// ou NULL se a árvore não usa prefixo.
+ExtratorPrefixo* arv_extrator_prefixo(Arvore *arv);
+
+// retorna a função de liberação da árvore, ou NULL se a árvore não
+// libera os dados.
+Liberador* arv_liberador(Arvore *arv);
+
+// retorna a altura da árvore (número de nós do caminho mais longo da
+// raiz até um NIL). percorre a árvore inteira, em O(n): para consultas
+// frequentes, prefira arv_altura_maxima ou arv_estima_profundidades.
 int arv_altura(Arvore *arv);
 
+// retorna a altura-preta da árvore (número de nós pretos de qualquer
+// caminho da raiz até um NIL), em O(1). a altura da árvore está sempre
+// entre a altura-preta e o dobro dela.
+int arv_altura_preta(Arvore *arv);
+
+// retorna um limite superior para a altura da árvore, em O(1): como um
+// nó vermelho não pode ter filho vermelho e a raiz é preta, nenhum
+// caminho tem mais nós vermelhos que pretos, então a altura é no
+// máximo o dobro da altura-preta.
+int arv_altura_maxima(Arvore *arv);
+
+// profundidade máxima de um nó. a altura de uma árvore rubro-negra com n
+// nós é no máximo 2 log2(n + 1), que é menor que isso para qualquer n
+#define ARV_MAX_PROFUNDIDADE 128
+
+// estimativa da distribuição das profundidades dos nós, preenchida por
+// arv_estima_profundidades. a raiz tem profundidade 1.
+typedef struct {
+    size_t amostras;
+    double media;
+    int minima;
+    int maxima;
+    // histograma[p] é quantos nós amostrados têm profundidade p
+    size_t histograma[ARV_MAX_PROFUNDIDADE + 1];
+} ArvProfundidades;
+
+// estima a distribuição das profundidades dos nós a partir de `amostras`
+// nós espaçados igualmente na ordem da árvore (todos os nós, se a árvore
+// tiver menos que isso), em O(amostras * logn) ao invés de percorrer a
+// árvore toda se a árvore guarda os tamanhos (ver arv_define_tamanhos),
+// senão percorrendo a árvore em ordem, em O(n).
+// a profundidade média estima o custo médio de uma busca.
+// retorna false se `saida` for NULL ou a árvore estiver vazia.
+bool arv_estima_profundidades(Arvore *arv, size_t amostras, ArvProfundidades *saida);
+
+// retorna o número de nós da sub-árvore com raiz no nó `no`, ou 0 se `no`
+// for NULL. só pode ser usada com os nós de uma árvore que guarda os
+// tamanhos (ver arv_define_tamanhos).
+size_t arv_busca_tamanho(No *no);
+
+// retorna um ponteiro para o nó com o k-ésimo menor valor da árvore,
+// contando a partir de 0 (ou seja, arv_seleciona(arv, 0) é o mínimo),
+// em O(logn) se a árvore guarda os tamanhos (ver arv_define_tamanhos),
+// senão andando `k` nós a partir do mínimo, em O(k).
+// se `k` for maior ou igual ao número de nós, retorna NULL.
+No* arv_seleciona(Arvore *arv, size_t k);
+
+// retorna o posto do valor `v` na árvore, que é o número de dados
+// menores que `v`, em O(logn) se a árvore guarda os tamanhos (ver
+// arv_define_tamanhos), senão contando os nós menores, em O(posto + logn).
+// se a árvore contém `v`, é a posição (a partir de 0) do primeiro dado
+// igual a `v` na ordem da árvore.
+size_t arv_posto(Arvore *arv, void *v);
+
+//// --- estatísticas ---
+
+// os contadores são separados por thread (cada thread escreve no seu
+// próprio conjunto de contadores, em linhas de cache diferentes), então
+// contar não exige operações atômicas nem sincronização, e as threads
+// leitoras da árvore concorrente também são contadas.
+
+// preenche `saida` com a soma das estatísticas de todas as threads.
+// retorna false (e zera `saida`) se a biblioteca foi compilada sem
+// ARV_ESTATISTICAS.
+// se outras threads estiverem usando a árvore, os contadores podem estar
+// sendo atualizados durante a leitura.
+bool arv_estatisticas(Arvore *arv, ArvEstatisticas *saida);
+
+// zera as estatísticas da árvore.
+void arv_zera_estatisticas(Arvore *arv);
+
+
+
+//// --- iteração ---
+
+// a iteração usa os ponteiros para os pais, então não aloca memória nem
+// usa recursão, e percorrer a árvore inteira custa O(n) no total (O(1)
+// amortizado por passo). a árvore não deve ser alterada durante a
+// iteração, exceto pela remoção do nó atual depois de já ter pego o próximo.
+
+// retorna um ponteiro para o primeiro nó da árvore (o de menor valor),
+// ou NULL se a árvore estiver vazia.
+No* arv_iter_inicio(Arvore *arv);
+
+// retorna um ponteiro para o último nó da árvore (o de maior valor),
+// ou NULL se a árvore estiver vazia.
+No* arv_iter_fim(Arvore *arv);
+
+// retorna um ponteiro para o nó seguinte a `no` na ordem da árvore,
+// ou NULL se `no` for o último.
+No* arv_iter_proximo(No *no);
+
+// retorna um ponteiro para o nó anterior a `no` na ordem da árvore,
+// ou NULL se `no` for o primeiro.
+No* arv_iter_anterior(No *no);
+
+// as buscas abaixo fazem uma única descida da raiz, em O(logn), e
+// retornam NULL se não existir nenhum nó que satisfaça a condição.
+// com valores repetidos, retornam o primeiro (ou último, no piso) deles.
+
+// retorna um ponteiro para o primeiro nó com valor maior ou igual a `v`.
+No* arv_limite_inferior(Arvore *arv, void *v);
+
+// retorna um ponteiro para o primeiro nó com valor estritamente maior que `v`.
+No* arv_limite_superior(Arvore *arv, void *v);
+
+// retorna um ponteiro para o último nó com valor menor ou igual a `v`.
+No* arv_piso(Arvore *arv, void *v);
+
+// retorna um ponteiro para o primeiro nó com valor maior ou igual a `v`
+// (o mesmo nó de arv_limite_inferior).
+No* arv_teto(Arvore *arv, void *v);
+
+// retorna o intervalo com os nós de valor entre `lo` e `hi` (incluindo os
+// dois), encontrado com duas descidas em O(logn). se não houver nenhum,
+// `inicio` == `fim`.
+ArvIntervalo arv_intervalo(Arvore *arv, void *lo, void *hi);
+
+
+
+//// --- percurso paralelo ---
+
+// as funções abaixo dividem a árvore nas sub-árvores de um nível perto da
+// raiz (várias por thread) e as threads vão pegando a próxima sub-árvore
+// livre até acabarem, então as threads que pegam sub-árvores menores
+// pegam mais delas. os poucos nós acima desse nível são processados pela
+// thread que chamou a função.
+// `num_threads` conta com a thread que chamou, e 0 usa uma thread por
+// processador. árvores pequenas são processadas só pela thread que chamou.
+// a árvore não deve ser alterada durante essas funções.
+
+// chama `visita` com cada dado da árvore e `contexto`, em várias threads
+// e sem ordem definida. `visita` é chamada ao mesmo tempo por várias
+// threads, cada uma com dados diferentes.
+void arv_percorre_paralelo(Arvore *arv, int num_threads, Visitante *visita, void *contexto);
+
+// reduz os dados da árvore a um resultado de `tam_resultado` bytes, em
+// várias threads. `resultado` deve conter, na chamada, o valor inicial
+// (o elemento neutro de `combina`), que é copiado para o resultado
+// parcial de cada sub-árvore. cada thread acumula os dados da sua
+// sub-árvore com `acumula`, e no final os resultados parciais são
+// juntados em `resultado` com `combina`, na ordem da árvore, então basta
+// que as duas funções sejam associativas.
+void arv_reduz_paralelo(Arvore *arv, int num_threads, void *resultado, size_t tam_resultado,
+                        Acumulador *acumula, Combinador *combina, void *contexto);
+
+// libera toda a árvore como arv_libera_arvore, mas liberando os nós e os
+// dados em várias threads. a função de liberação da árvore é chamada ao
+// mesmo tempo por várias threads, com dados diferentes.
+// se o pool da árvore é usado por outra árvore, a liberação é feita só
+// pela thread que chamou.
+void arv_libera_arvore_paralelo(Arvore *arv, int num_threads);
+
+// define com quantas threads arv_libera_arvore libera a árvore, contando
+// com a que chamou (0 usa uma por processador), como se chamasse
+// arv_libera_arvore_paralelo. árvores pequenas continuam sendo liberadas
+// só pela thread que chamou.
+// por padrão é 1, já que com mais threads a função de liberação passa a
+// ser chamada ao mesmo tempo por várias threads. as árvores criadas a
+// partir desta (por arv_divide, por exemplo) herdam o número de threads.
+// retorna false se `num_threads` for negativo.
+bool arv_define_threads_liberacao(Arvore *arv, int num_threads);
+
+
+
+//// --- agregados ---
+
+// guarda em `resultado` (com o tamanho do agregado da árvore) o agregado
+// dos dados `x` da árvore com `lo` <= `x` <= `hi`, em O(log n).
+// `lo` ou `hi` NULL deixam o intervalo aberto daquele lado.
+// retorna false se a árvore não tiver agregado (ver arv_define_agregado).
+bool arv_agrega_intervalo(Arvore *arv, void *lo, void *hi, void *resultado);
+
+// retorna o agregado da sub-árvore com raiz no nó `no`, ou NULL se `no`
+// for NULL. só pode ser usada com os nós de uma árvore com agregado.
+const void* arv_busca_agregado(No *no);
+
+
+
 // retorna um ponteiro para o nó com menor valor a partir do nó passado como argumento.
 No* arv_busca_minimo(No *raiz);
 
@@ -0,0 +1,194 @@
+// benchmark de leitura da árvore concorrente
+//
+// mede quantas consultas por segundo a árvore concorrente (trava de
+// leitura distribuída) atende com 1, 2, 4, ... threads leitoras, comparando
+// com a mesma árvore protegida por um único mutex. opcionalmente uma
+// thread escritora fica inserindo e removendo chaves durante a medição.
+//
+// uso: bench-concorrente [nós] [segundos por medição] [max threads] [escritora 0/1]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "../arvore-rn.h"
+#include "../arvore-rn-concorrente.h"
+
+static int comparador_int(void *p1, void *p2) {
+    int i1 = *(int*)p1;
+    int i2 = *(int*)p2;
+
+    if(i1 < i2) return -1;
+    if(i1 > i2) return 1;
+    return 0;
+}
+
+static int* aloca_int(int valor) {
+    int *dado = (int*)malloc(sizeof(int));
+    if(dado != NULL) *dado = valor;
+    return dado;
+}
+
+// gerador xorshift, cada thread tem o seu
+static unsigned long long proximo_aleatorio(unsigned long long *estado) {
+    unsigned long long x = *estado;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *estado = x;
+    return x;
+}
+
+static double agora() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// modo de proteção da árvore durante a medição
+typedef enum { CONCORRENTE, MUTEX } Modo;
+
+typedef struct {
+    Modo modo;
+    ArvoreConcorrente *arvc;
+    Arvore *arv;
+    pthread_mutex_t *mutex;
+    int nnos;
+    unsigned long long semente;
+    atomic_bool *parar;
+    unsigned long long operacoes;
+} Trabalho;
+
+static void* leitora(void *arg) {
+    Trabalho *t = (Trabalho*)arg;
+    unsigned long long estado = t->semente;
+    unsigned long long ops = 0;
+    unsigned long long achados = 0;
+
+    while(!atomic_load_explicit(t->parar, memory_order_relaxed)) {
+        // lotes pequenos para não consultar a flag a cada operação
+        for(int i = 0; i < 256; i++) {
+            int chave = (int)(proximo_aleatorio(&estado) % (unsigned long long)(2 * t->nnos));
+            bool achou;
+            if(t->modo == CONCORRENTE) {
+                achou = arv_conc_contem(t->arvc, &chave);
+            }
+            else {
+                pthread_mutex_lock(t->mutex);
+                achou = arv_contem(t->arv, &chave);
+                pthread_mutex_unlock(t->mutex);
+            }
+            achados += achou;
+        }
+        ops += 256;
+    }
+
+    // evita que o compilador descarte as buscas
+    if(achados == 0xffffffffffffffffULL) printf("?");
+    t->operacoes = ops;
+    return NULL;
+}
+
+static void* escritora(void *arg) {
+    Trabalho *t = (Trabalho*)arg;
+    unsigned long long estado = t->semente;
+    unsigned long long ops = 0;
+
+    // insere e remove chaves fora do intervalo inicial, mantendo o
+    // tamanho da árvore estável
+    while(!atomic_load_explicit(t->parar, memory_order_relaxed)) {
+        int chave = t->nnos + (int)(proximo_aleatorio(&estado) % (unsigned long long)t->nnos);
+        if(t->modo == CONCORRENTE) {
+            int *dado = aloca_int(chave);
+            if(!arv_conc_insere_no(t->arvc, dado)) free(dado);
+            arv_conc_remove_no(t->arvc, &chave);
+        }
+        else {
+            pthread_mutex_lock(t->mutex);
+            int *dado = aloca_int(chave);
+            if(!arv_insere_no(t->arv, dado)) free(dado);
+            arv_remove_no(t->arv, &chave);
+            pthread_mutex_unlock(t->mutex);
+        }
+        ops += 2;
+    }
+
+    t->operacoes = ops;
+    return NULL;
+}
+
+// roda uma medição com `nthreads` leitoras e devolve as consultas por segundo
+static double mede(Modo modo, ArvoreConcorrente *arvc, Arvore *arv, pthread_mutex_t *mutex,
+                   int nnos, int nthreads, double segundos, bool com_escritora) {
+    atomic_bool parar;
+    atomic_init(&parar, false);
+
+    Trabalho trabalhos[nthreads + 1];
+    pthread_t threads[nthreads + 1];
+    int total = nthreads + (com_escritora ? 1 : 0);
+
+    for(int i = 0; i < total; i++) {
+        trabalhos[i] = (Trabalho){ modo, arvc, arv, mutex, nnos, 0x9e3779b97f4a7c15ULL * (i + 1), &parar, 0 };
+        pthread_create(&threads[i], NULL, i < nthreads ? leitora : escritora, &trabalhos[i]);
+    }
+
+    double inicio = agora();
+    usleep((useconds_t)(segundos * 1e6));
+    atomic_store(&parar, true);
+
+    unsigned long long leituras = 0;
+    for(int i = 0; i < total; i++) {
+        pthread_join(threads[i], NULL);
+        if(i < nthreads) leituras += trabalhos[i].operacoes;
+    }
+    double decorrido = agora() - inicio;
+
+    return leituras / decorrido;
+}
+
+int main(int argc, char **argv) {
+    int nnos = argc > 1 ? atoi(argv[1]) : 1000000;
+    double segundos = argc > 2 ? atof(argv[2]) : 1.0;
+    int max_threads = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    bool com_escritora = argc > 4 ? atoi(argv[4]) != 0 : false;
+
+    if(nnos <= 0 || segundos <= 0 || max_threads <= 0) {
+        fprintf(stderr, "uso: %s [nós] [segundos por medição] [max threads] [escritora 0/1]\n", argv[0]);
+        return 1;
+    }
+
+    // a árvore concorrente e a árvore do mutex têm as mesmas chaves pares
+    ArvoreConcorrente *arvc = arv_conc_cria(arv_cria(comparador_int, free));
+    Arvore *arv = arv_cria(comparador_int, free);
+    pthread_mutex_t mutex;
+    pthread_mutex_init(&mutex, NULL);
+    if(arvc == NULL || arv == NULL) {
+        fprintf(stderr, "falha ao criar as árvores\n");
+        return 1;
+    }
+
+    for(int i = 0; i < nnos; i++) {
+        arv_conc_insere_no(arvc, aloca_int(2 * i));
+        arv_insere_no(arv, aloca_int(2 * i));
+    }
+
+    printf("nós: %d, %.1fs por medição, escritora: %s\n", nnos, segundos, com_escritora ? "sim" : "não");
+    printf("%8s %20s %18s %12s\n", "threads", "concorrente (ops/s)", "mutex (ops/s)", "conc/mutex");
+
+    for(int n = 1; n <= max_threads; n *= 2) {
+        double conc = mede(CONCORRENTE, arvc, NULL, NULL, 2 * nnos, n, segundos, com_escritora);
+        double mx = mede(MUTEX, NULL, arv, &mutex, 2 * nnos, n, segundos, com_escritora);
+        printf("%8d %20.0f %18.0f %12.2f\n", n, conc, mx, conc / mx);
+
+        // garante que a última medição use todas as threads
+        if(n < max_threads && 2 * n > max_threads) n = max_threads / 2;
+    }
+
+    arv_conc_libera(arvc);
+    arv_libera_arvore(arv);
+    pthread_mutex_destroy(&mutex);
+    return 0;
+}
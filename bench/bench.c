@@ -0,0 +1,635 @@
+// benchmark da árvore rubro-negra
+//
+// mede inserções (arv_insere_no), remoções (arv_remove_no) e buscas
+// (arv_contem) com chaves inteiras, em cargas de trabalho diferentes:
+//   - sequencial: chaves inseridas, buscadas e removidas em ordem crescente
+//   - aleatoria:  chaves em ordem aleatória, metade das buscas não acha
+//   - zipf:       como a aleatória, mas as buscas seguem uma distribuição de
+//                 zipf (poucas chaves muito consultadas)
+//   - mista:      depois da carga inicial, 90% buscas (zipf), 5% inserções
+//                 e 5% remoções intercaladas
+// cada combinação de estrutura, carga e tamanho roda em um processo
+// separado, para o pico de memória (RSS) de uma não contaminar a outra.
+// a árvore tipada (arvore-rn-tipada.h) mostra o custo do comparador
+// chamado por ponteiro, e a tabela hash é a referência para comparação.
+// a árvore congelada (arvore-rn-congelada.h) é uma árvore comum que é
+// congelada antes da fase de buscas, e não roda a carga mista.
+//
+// para cada fase são mostradas as operações por segundo e as latências
+// p50/p99, medidas individualmente em uma amostra das operações.
+//
+// uso: bench [-n tamanhos] [-c cargas] [-e estruturas] [-s semente]
+//   -n  lista separada por vírgulas (padrão 1000,100000,1000000),
+//       aceita sufixos k e m (por exemplo 1k,100m)
+//   -c  sequencial,aleatoria,zipf,mista (padrão: todas)
+//   -e  arvore,arvore-pool,arvore-tipada,arvore-compacta,arvore-congelada,hash
+//       (padrão: todas)
+//   -s  semente do gerador aleatório (padrão 42)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "../arvore-rn.h"
+#include "../arvore-rn-tipada.h"
+#include "../arvore-rn-congelada.h"
+#include "../arvore-rn-compacta.h"
+
+
+//// --- utilitários ---
+
+static uint64_t agora_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// gerador splitmix64
+static uint64_t estado_aleatorio = 42;
+
+static uint64_t aleatorio() {
+    uint64_t z = (estado_aleatorio += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static size_t aleatorio_ate(size_t n) {
+    return (size_t)(aleatorio() % n);
+}
+
+static double aleatorio_unitario() {
+    return (aleatorio() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// embaralha `v` (fisher-yates)
+static void embaralha(int *v, size_t n) {
+    for(size_t i = n; i > 1; i--) {
+        size_t j = aleatorio_ate(i);
+        int temp = v[i - 1];
+        v[i - 1] = v[j];
+        v[j] = temp;
+    }
+}
+
+// gerador de zipf de Gray et al. ("Quickly generating billion-record
+// synthetic databases"), que sorteia em O(1) depois de calcular zeta(n)
+typedef struct {
+    size_t n;
+    double theta, alfa, zetan, eta;
+} Zipf;
+
+static void zipf_inicia(Zipf *z, size_t n, double theta) {
+    double zeta2 = 1.0 + pow(0.5, theta);
+    z->n = n;
+    z->theta = theta;
+    z->zetan = 0;
+    for(size_t i = 1; i <= n; i++) z->zetan += 1.0 / pow((double)i, theta);
+    z->alfa = 1.0 / (1.0 - theta);
+    z->eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - zeta2 / z->zetan);
+}
+
+// retorna um posto entre 0 e n - 1, os primeiros são os mais prováveis
+static size_t zipf_sorteia(Zipf *z) {
+    double u = aleatorio_unitario();
+    double uz = u * z->zetan;
+    if(uz < 1.0) return 0;
+    if(uz < 1.0 + pow(0.5, z->theta)) return 1 < z->n ? 1 : 0;
+    size_t r = (size_t)((double)z->n * pow(z->eta * u - z->eta + 1.0, z->alfa));
+    return r < z->n ? r : z->n - 1;
+}
+
+static int compara_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+
+
+//// --- estruturas medidas ---
+
+typedef struct {
+    const char *nome;
+    void* (*cria)(size_t capacidade);
+    bool (*insere)(void *estrutura, int chave);
+    bool (*remove)(void *estrutura, int chave);
+    bool (*contem)(void *estrutura, int chave);
+    void (*libera)(void *estrutura);
+    // chamada antes de cada fase, pode ser NULL
+    void (*prepara)(void *estrutura, const char *fase);
+    // a estrutura não aceita escritas intercaladas com buscas
+    bool somente_leitura;
+} Estrutura;
+
+static int comparador_int(void *p1, void *p2) {
+    int i1 = *(int*)p1;
+    int i2 = *(int*)p2;
+
+    if(i1 < i2) return -1;
+    if(i1 > i2) return 1;
+    return 0;
+}
+
+// árvore comum, com o dado alocado pelo usuário como no README
+static void* arvore_cria(size_t capacidade) {
+    (void)capacidade;
+    return arv_cria(comparador_int, free);
+}
+
+static void* arvore_pool_cria(size_t capacidade) {
+    (void)capacidade;
+    return arv_cria_com_pool(comparador_int, free, 4096);
+}
+
+static bool arvore_insere(void *estrutura, int chave) {
+    int *dado = (int*)malloc(sizeof(int));
+    if(dado == NULL) return false;
+    *dado = chave;
+    if(!arv_insere_no((Arvore*)estrutura, dado)) {
+        free(dado);
+        return false;
+    }
+    return true;
+}
+
+static bool arvore_remove(void *estrutura, int chave) {
+    return arv_remove_no((Arvore*)estrutura, &chave);
+}
+
+static bool arvore_contem(void *estrutura, int chave) {
+    return arv_contem((Arvore*)estrutura, &chave);
+}
+
+static void arvore_libera(void *estrutura) {
+    arv_libera_arvore((Arvore*)estrutura);
+}
+
+// árvore tipada, com a chave no nó e a comparação em linha
+ARV_DEFINE(ArvInt, int, ARV_COMPARA_NUM)
+
+static void* tipada_cria(size_t capacidade) {
+    (void)capacidade;
+    return ArvInt_cria();
+}
+
+static bool tipada_insere(void *estrutura, int chave) {
+    return ArvInt_insere_no((ArvInt*)estrutura, chave);
+}
+
+static bool tipada_remove(void *estrutura, int chave) {
+    return ArvInt_remove_no((ArvInt*)estrutura, chave);
+}
+
+static bool tipada_contem(void *estrutura, int chave) {
+    return ArvInt_contem((ArvInt*)estrutura, chave);
+}
+
+static void tipada_libera(void *estrutura) {
+    ArvInt_libera_arvore((ArvInt*)estrutura);
+}
+
+// árvore compacta, com nós de 16 bytes em um vetor
+static void* compacta_cria(size_t capacidade) {
+    (void)capacidade;
+    return arv_comp_cria(comparador_int, free);
+}
+
+static bool compacta_insere(void *estrutura, int chave) {
+    int *dado = (int*)malloc(sizeof(int));
+    if(dado == NULL) return false;
+    *dado = chave;
+    if(!arv_comp_insere_no((ArvoreCompacta*)estrutura, dado)) {
+        free(dado);
+        return false;
+    }
+    return true;
+}
+
+static bool compacta_remove(void *estrutura, int chave) {
+    return arv_comp_remove_no((ArvoreCompacta*)estrutura, &chave);
+}
+
+static bool compacta_contem(void *estrutura, int chave) {
+    return arv_comp_contem((ArvoreCompacta*)estrutura, &chave);
+}
+
+static void compacta_libera(void *estrutura) {
+    arv_comp_libera((ArvoreCompacta*)estrutura);
+}
+
+// prefixo de um int que respeita a ordem de comparador_int (o bit de
+// sinal invertido faz os negativos ficarem antes dos positivos)
+static uint64_t prefixo_int(void *dado) {
+    return (uint64_t)((uint32_t)*(int*)dado ^ 0x80000000u);
+}
+
+// árvore comum que é congelada para a fase de buscas. usa o prefixo, que
+// é a chave inteira, para a cópia congelada não precisar acessar os dados
+typedef struct {
+    Arvore *arv;
+    ArvoreCongelada *congelada;
+} Congelada;
+
+static void* congelada_cria(size_t capacidade) {
+    Congelada *c = (Congelada*)malloc(sizeof(Congelada));
+    if(c == NULL) return NULL;
+
+    c->arv = (Arvore*)arvore_cria(capacidade);
+    c->congelada = NULL;
+    if(c->arv == NULL) {
+        free(c);
+        return NULL;
+    }
+    arv_define_prefixo(c->arv, prefixo_int);
+    return c;
+}
+
+static bool congelada_insere(void *estrutura, int chave) {
+    return arvore_insere(((Congelada*)estrutura)->arv, chave);
+}
+
+static bool congelada_remove(void *estrutura, int chave) {
+    return arvore_remove(((Congelada*)estrutura)->arv, chave);
+}
+
+static bool congelada_contem(void *estrutura, int chave) {
+    return arv_cong_contem(((Congelada*)estrutura)->congelada, &chave);
+}
+
+// a cópia congelada existe só durante as buscas, já que as remoções
+// liberam os dados que ela aponta
+static void congelada_prepara(void *estrutura, const char *fase) {
+    Congelada *c = (Congelada*)estrutura;
+    arv_cong_libera(c->congelada);
+    c->congelada = strcmp(fase, "busca") == 0 ? arv_congela(c->arv) : NULL;
+}
+
+static void congelada_libera(void *estrutura) {
+    Congelada *c = (Congelada*)estrutura;
+    arv_cong_libera(c->congelada);
+    arv_libera_arvore(c->arv);
+    free(c);
+}
+
+// tabela hash de endereçamento aberto (sondagem linear) como referência.
+// guarda ponteiros para dados alocados um a um, como a árvore
+#define HASH_REMOVIDO ((int*)1)
+
+typedef struct {
+    int **posicoes;
+    size_t mascara;
+} TabelaHash;
+
+static size_t hash_int(int chave) {
+    uint64_t x = (uint64_t)(uint32_t)chave * 0x9e3779b97f4a7c15ULL;
+    return (size_t)(x >> 17);
+}
+
+static void* hash_cria(size_t capacidade) {
+    TabelaHash *t = (TabelaHash*)malloc(sizeof(TabelaHash));
+    if(t == NULL) return NULL;
+
+    // ocupação máxima de 50%
+    size_t tamanho = 16;
+    while(tamanho < 2 * capacidade) tamanho *= 2;
+    t->posicoes = (int**)calloc(tamanho, sizeof(int*));
+    if(t->posicoes == NULL) {
+        free(t);
+        return NULL;
+    }
+    t->mascara = tamanho - 1;
+    return t;
+}
+
+static bool hash_insere(void *estrutura, int chave) {
+    TabelaHash *t = (TabelaHash*)estrutura;
+    size_t i = hash_int(chave) & t->mascara;
+    while(t->posicoes[i] != NULL && t->posicoes[i] != HASH_REMOVIDO) {
+        i = (i + 1) & t->mascara;
+    }
+
+    int *dado = (int*)malloc(sizeof(int));
+    if(dado == NULL) return false;
+    *dado = chave;
+    t->posicoes[i] = dado;
+    return true;
+}
+
+static int** hash_procura(TabelaHash *t, int chave) {
+    size_t i = hash_int(chave) & t->mascara;
+    while(t->posicoes[i] != NULL) {
+        if(t->posicoes[i] != HASH_REMOVIDO && *t->posicoes[i] == chave) {
+            return &t->posicoes[i];
+        }
+        i = (i + 1) & t->mascara;
+    }
+    return NULL;
+}
+
+static bool hash_remove(void *estrutura, int chave) {
+    int **posicao = hash_procura((TabelaHash*)estrutura, chave);
+    if(posicao == NULL) return false;
+
+    free(*posicao);
+    *posicao = HASH_REMOVIDO;
+    return true;
+}
+
+static bool hash_contem(void *estrutura, int chave) {
+    return hash_procura((TabelaHash*)estrutura, chave) != NULL;
+}
+
+static void hash_libera(void *estrutura) {
+    TabelaHash *t = (TabelaHash*)estrutura;
+    for(size_t i = 0; i <= t->mascara; i++) {
+        if(t->posicoes[i] != NULL && t->posicoes[i] != HASH_REMOVIDO) free(t->posicoes[i]);
+    }
+    free(t->posicoes);
+    free(t);
+}
+
+static const Estrutura ESTRUTURAS[] = {
+    { "arvore", arvore_cria, arvore_insere, arvore_remove, arvore_contem, arvore_libera, NULL, false },
+    { "arvore-pool", arvore_pool_cria, arvore_insere, arvore_remove, arvore_contem, arvore_libera, NULL, false },
+    { "arvore-tipada", tipada_cria, tipada_insere, tipada_remove, tipada_contem, tipada_libera, NULL, false },
+    { "arvore-compacta", compacta_cria, compacta_insere, compacta_remove, compacta_contem,
+      compacta_libera, NULL, false },
+    { "arvore-congelada", congelada_cria, congelada_insere, congelada_remove, congelada_contem,
+      congelada_libera, congelada_prepara, true },
+    { "hash", hash_cria, hash_insere, hash_remove, hash_contem, hash_libera, NULL, false },
+};
+#define NUM_ESTRUTURAS (sizeof(ESTRUTURAS) / sizeof(ESTRUTURAS[0]))
+
+
+
+//// --- cargas de trabalho ---
+
+typedef enum { OP_INSERE, OP_BUSCA, OP_REMOVE } TipoOp;
+
+// uma fase é uma sequência de operações pré-calculadas, para o sorteio
+// das chaves não entrar na medição
+typedef struct {
+    const char *nome;
+    size_t n;
+    TipoOp *tipos;
+    int *chaves;
+} Fase;
+
+static const char *CARGAS[] = { "sequencial", "aleatoria", "zipf", "mista" };
+#define NUM_CARGAS (sizeof(CARGAS) / sizeof(CARGAS[0]))
+
+static void fase_aloca(Fase *f, const char *nome, size_t n) {
+    f->nome = nome;
+    f->n = n;
+    f->tipos = (TipoOp*)malloc(n * sizeof(TipoOp));
+    f->chaves = (int*)malloc(n * sizeof(int));
+    if(f->tipos == NULL || f->chaves == NULL) {
+        fprintf(stderr, "sem memória para as operações\n");
+        exit(1);
+    }
+}
+
+static void fase_libera(Fase *f) {
+    free(f->tipos);
+    free(f->chaves);
+}
+
+// monta as fases da carga `carga` com `n` chaves, retorna quantas fases
+static int monta_fases(const char *carga, size_t n, Fase fases[3]) {
+    int *chaves = (int*)malloc(n * sizeof(int));
+    if(chaves == NULL) {
+        fprintf(stderr, "sem memória para as chaves\n");
+        exit(1);
+    }
+    for(size_t i = 0; i < n; i++) chaves[i] = (int)i;
+
+    bool sequencial = strcmp(carga, "sequencial") == 0;
+    if(!sequencial) embaralha(chaves, n);
+
+    // carga inicial: todas as chaves
+    fase_aloca(&fases[0], "insere", n);
+    for(size_t i = 0; i < n; i++) {
+        fases[0].tipos[i] = OP_INSERE;
+        fases[0].chaves[i] = chaves[i];
+    }
+
+    if(strcmp(carga, "mista") == 0) {
+        // `presentes` acompanha quais chaves estão na estrutura para as
+        // remoções sempre acharem a chave e as inserções nunca repetirem
+        int *presentes = (int*)malloc(2 * n * sizeof(int) + sizeof(int));
+        memcpy(presentes, chaves, n * sizeof(int));
+        size_t num_presentes = n;
+        int proxima = (int)n;
+
+        Zipf z;
+        zipf_inicia(&z, n, 0.99);
+
+        fase_aloca(&fases[1], "mista", n);
+        for(size_t i = 0; i < n; i++) {
+            unsigned sorteio = (unsigned)aleatorio_ate(100);
+            if(sorteio < 5 || num_presentes == 0) {
+                fases[1].tipos[i] = OP_INSERE;
+                fases[1].chaves[i] = proxima;
+                presentes[num_presentes++] = proxima++;
+            }
+            else if(sorteio < 10) {
+                size_t j = aleatorio_ate(num_presentes);
+                fases[1].tipos[i] = OP_REMOVE;
+                fases[1].chaves[i] = presentes[j];
+                presentes[j] = presentes[--num_presentes];
+            }
+            else {
+                fases[1].tipos[i] = OP_BUSCA;
+                fases[1].chaves[i] = presentes[zipf_sorteia(&z) % num_presentes];
+            }
+        }
+
+        free(presentes);
+        free(chaves);
+        return 2;
+    }
+
+    fase_aloca(&fases[1], "busca", n);
+    if(sequencial) {
+        for(size_t i = 0; i < n; i++) {
+            fases[1].tipos[i] = OP_BUSCA;
+            fases[1].chaves[i] = (int)i;
+        }
+    }
+    else if(strcmp(carga, "zipf") == 0) {
+        Zipf z;
+        zipf_inicia(&z, n, 0.99);
+        for(size_t i = 0; i < n; i++) {
+            fases[1].tipos[i] = OP_BUSCA;
+            fases[1].chaves[i] = chaves[zipf_sorteia(&z)];
+        }
+    }
+    else {
+        // metade das buscas é de chaves que não existem
+        for(size_t i = 0; i < n; i++) {
+            fases[1].tipos[i] = OP_BUSCA;
+            fases[1].chaves[i] = (int)aleatorio_ate(2 * n);
+        }
+    }
+
+    if(!sequencial) embaralha(chaves, n);
+    fase_aloca(&fases[2], "remove", n);
+    for(size_t i = 0; i < n; i++) {
+        fases[2].tipos[i] = OP_REMOVE;
+        fases[2].chaves[i] = chaves[i];
+    }
+
+    free(chaves);
+    return 3;
+}
+
+
+
+//// --- medição ---
+
+// no máximo essa quantidade de operações tem a latência medida por fase
+#define MAX_AMOSTRAS 1000000
+
+static void mede_fase(const Estrutura *e, void *estrutura, const char *carga, size_t n, Fase *f) {
+    size_t passo = f->n / MAX_AMOSTRAS + 1;
+    uint64_t *latencias = (uint64_t*)malloc((f->n / passo + 1) * sizeof(uint64_t));
+    size_t num_amostras = 0;
+    size_t sucessos = 0;
+
+    uint64_t inicio = agora_ns();
+    for(size_t i = 0; i < f->n; i++) {
+        bool amostra = i % passo == 0;
+        uint64_t t0 = amostra ? agora_ns() : 0;
+
+        bool ok;
+        switch(f->tipos[i]) {
+            case OP_INSERE: ok = e->insere(estrutura, f->chaves[i]); break;
+            case OP_REMOVE: ok = e->remove(estrutura, f->chaves[i]); break;
+            default:        ok = e->contem(estrutura, f->chaves[i]); break;
+        }
+        sucessos += ok;
+
+        if(amostra) latencias[num_amostras++] = agora_ns() - t0;
+    }
+    double segundos = (agora_ns() - inicio) / 1e9;
+
+    qsort(latencias, num_amostras, sizeof(uint64_t), compara_u64);
+    uint64_t p50 = latencias[num_amostras / 2];
+    uint64_t p99 = latencias[(size_t)(num_amostras * 0.99)];
+    free(latencias);
+
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+
+    printf("%-16s %-11s %11zu %-7s %14.0f %9llu %9llu %10.1f %6.1f%%\n",
+           e->nome, carga, n, f->nome, f->n / segundos,
+           (unsigned long long)p50, (unsigned long long)p99,
+           uso.ru_maxrss / 1024.0, 100.0 * sucessos / f->n);
+}
+
+// roda uma combinação em um processo filho
+static void roda(const Estrutura *e, const char *carga, size_t n, uint64_t semente) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if(pid > 0) {
+        waitpid(pid, NULL, 0);
+        return;
+    }
+
+    estado_aleatorio = semente;
+    Fase fases[3];
+    int num_fases = monta_fases(carga, n, fases);
+
+    void *estrutura = e->cria(2 * n);
+    if(estrutura == NULL) {
+        fprintf(stderr, "falha ao criar %s\n", e->nome);
+        exit(1);
+    }
+    for(int i = 0; i < num_fases; i++) {
+        if(e->prepara != NULL) e->prepara(estrutura, fases[i].nome);
+        mede_fase(e, estrutura, carga, n, &fases[i]);
+        fase_libera(&fases[i]);
+    }
+    e->libera(estrutura);
+
+    fflush(stdout);
+    _exit(0);
+}
+
+// retorna true se `nome` está na lista separada por vírgulas `lista`
+// (uma lista NULL contém tudo)
+static bool lista_contem(const char *lista, const char *nome) {
+    if(lista == NULL) return true;
+
+    size_t tam = strlen(nome);
+    const char *p = lista;
+    while(*p) {
+        const char *fim = strchr(p, ',');
+        size_t tam_item = fim ? (size_t)(fim - p) : strlen(p);
+        if(tam_item == tam && strncmp(p, nome, tam) == 0) return true;
+        if(fim == NULL) break;
+        p = fim + 1;
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    const char *tamanhos = "1000,100000,1000000";
+    const char *cargas = NULL;
+    const char *estruturas = NULL;
+    uint64_t semente = 42;
+
+    int opcao;
+    while((opcao = getopt(argc, argv, "n:c:e:s:")) != -1) {
+        switch(opcao) {
+            case 'n': tamanhos = optarg; break;
+            case 'c': cargas = optarg; break;
+            case 'e': estruturas = optarg; break;
+            case 's': semente = strtoull(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "uso: %s [-n tamanhos] [-c cargas] [-e estruturas] [-s semente]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    printf("%-16s %-11s %11s %-7s %14s %9s %9s %10s %7s\n",
+           "estrutura", "carga", "tamanho", "fase", "ops/s", "p50(ns)", "p99(ns)", "RSS(MB)", "acerto");
+
+    const char *p = tamanhos;
+    while(*p) {
+        char *fim;
+        double valor = strtod(p, &fim);
+        if(*fim == 'k' || *fim == 'K') { valor *= 1e3; fim++; }
+        else if(*fim == 'm' || *fim == 'M') { valor *= 1e6; fim++; }
+        size_t n = (size_t)valor;
+        if(n == 0 || n > 1000000000) {
+            fprintf(stderr, "tamanho inválido: %s\n", p);
+            return 1;
+        }
+
+        for(size_t c = 0; c < NUM_CARGAS; c++) {
+            if(!lista_contem(cargas, CARGAS[c])) continue;
+            for(size_t e = 0; e < NUM_ESTRUTURAS; e++) {
+                if(!lista_contem(estruturas, ESTRUTURAS[e].nome)) continue;
+                if(ESTRUTURAS[e].somente_leitura && strcmp(CARGAS[c], "mista") == 0) continue;
+                roda(&ESTRUTURAS[e], CARGAS[c], n, semente);
+            }
+        }
+
+        if(*fim == ',') fim++;
+        p = fim;
+    }
+
+    return 0;
+}
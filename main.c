@@ -60,7 +60,10 @@ int main() {
     // complexa deveria se passar uma função que libera todos os campos e
     // o próprio descritor da struct, por exemplo
     Arvore *arv = arv_cria(comparador_str, free);
-    printf("árvore de strings criada! nós: %d.\n", arv_nnos(arv));
+    // como o comparador é o strcmp, a árvore pode guardar os primeiros
+    // bytes de cada string no nó e só chamar o comparador nos empates
+    arv_define_prefixo(arv, arv_prefixo_str);
+    printf("árvore de strings criada! nós: %zu.\n", arv_nnos(arv));
     imprime_arvore(arv);
 
     // ao inserir, o usuário tem que alocar o espaço em memória para os dados
@@ -75,7 +78,7 @@ int main() {
     arv_insere_no(arv, strdup("Kiwi"));
     imprime_arvore(arv);
 
-    printf("número de nós: %d.\n", arv_nnos(arv));
+    printf("número de nós: %zu.\n", arv_nnos(arv));
     printf("altura da árvore: %d.\n", arv_altura(arv));
 
     if(arv_contem(arv, "Kiwi")) {
@@ -91,7 +94,7 @@ int main() {
     arv_remove_no(arv, "Morango"); 
     imprime_arvore(arv);
 
-    printf("número de nós: %d.\n", arv_nnos(arv)); 
+    printf("número de nós: %zu.\n", arv_nnos(arv)); 
 
     if(!arv_contem(arv, "Morango")) {
         printf("a árvore não contém 'Morango'.\n");
@@ -108,6 +111,22 @@ int main() {
     printf("valor mínimo da árvore: %s.\n", valor_min);
     printf("valor máximo da árvore: %s.\n", valor_max);
 
+    // para percorrer os nós em ordem não é preciso recursão, basta ir
+    // de um nó para o próximo
+    printf("nós em ordem:");
+    for(No *no = arv_iter_inicio(arv); no != NULL; no = arv_iter_proximo(no)) {
+        printf(" %s", (char*)arv_busca_valor(no));
+    }
+    printf(".\n");
+
+    // o intervalo vai do primeiro nó >= "B" até o último nó <= "L"
+    printf("nós entre 'B' e 'L':");
+    ArvIntervalo intervalo = arv_intervalo(arv, "B", "L");
+    for(No *no = intervalo.inicio; no != intervalo.fim; no = arv_iter_proximo(no)) {
+        printf(" %s", (char*)arv_busca_valor(no));
+    }
+    printf(".\n");
+
 
     arv_libera_arvore(arv);
     return 0;
@@ -0,0 +1,121 @@
+#ifndef _TESTES_COMUM_
+#define _TESTES_COMUM_
+
+// utilitários compartilhados pelos testes (testes/teste-*.c).
+//
+// cada teste é um programa que roda sozinho e termina com código de saída
+// diferente de 0 na primeira falha. `make test` compila os testes e a
+// biblioteca com AddressSanitizer e UndefinedBehaviorSanitizer, então
+// vazamentos e acessos inválidos também fazem o teste falhar.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "../arvore-rn.h"
+
+// interrompe o teste se `condicao` for falsa, mostrando onde
+#define CONFERE(condicao) do { \
+        if(!(condicao)) { \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #condicao); \
+            abort(); \
+        } \
+    } while(0)
+
+
+//// --- dados ---
+
+// gerador splitmix64, com a mesma semente em todas as execuções
+static uint64_t estado_aleatorio = 42;
+
+static inline uint64_t aleatorio(void) {
+    uint64_t z = (estado_aleatorio += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// inteiro aleatório em [0, n)
+static inline int aleatorio_ate(int n) {
+    return (int)(aleatorio() % (uint64_t)n);
+}
+
+static inline int compara_int(void *dado1, void *dado2) {
+    int a = *(int*)dado1;
+    int b = *(int*)dado2;
+    return (a > b) - (a < b);
+}
+
+// retorna um novo int alocado com o valor `valor`, liberado com free
+static inline int* novo_int(int valor) {
+    int *dado = (int*)malloc(sizeof(int));
+    CONFERE(dado != NULL);
+    *dado = valor;
+    return dado;
+}
+
+
+//// --- invariantes da árvore ---
+
+// confere a sub-árvore com raiz `no`, filho de `pai`: o pai de cada nó,
+// nenhum nó vermelho com filho vermelho, a mesma altura-preta em todos os
+// caminhos e, se `tamanhos`, o tamanho de cada sub-árvore.
+// retorna a altura-preta
+static inline int confere_sub_arvore(No *no, No *pai, bool tamanhos) {
+    if(arv_no_vazio(no)) return 0;
+
+    CONFERE(arv_busca_pai(no) == pai);
+
+    No *esq = arv_busca_filho(no, false);
+    No *dir = arv_busca_filho(no, true);
+    if(arv_busca_cor(no) == VERMELHO) {
+        CONFERE(arv_busca_cor(esq) == PRETO);
+        CONFERE(arv_busca_cor(dir) == PRETO);
+    }
+
+    int altura_esq = confere_sub_arvore(esq, no, tamanhos);
+    int altura_dir = confere_sub_arvore(dir, no, tamanhos);
+    CONFERE(altura_esq == altura_dir);
+    if(tamanhos) CONFERE(arv_busca_tamanho(no) == 1 + arv_busca_tamanho(esq) + arv_busca_tamanho(dir));
+
+    return altura_esq + (arv_busca_cor(no) == PRETO);
+}
+
+// confere todas as propriedades da árvore rubro-negra `arv`, o número de
+// nós, a altura-preta guardada, os tamanhos das sub-árvores (se a árvore
+// os guarda) e a ordem dos dados pelo comparador
+static inline void confere_arvore(Arvore *arv) {
+    No *raiz = arv_busca_raiz(arv);
+    bool tamanhos = arv_guarda_tamanhos(arv);
+    CONFERE(arv_busca_cor(raiz) == PRETO);
+    CONFERE(arv_busca_pai(raiz) == NULL);
+    CONFERE(confere_sub_arvore(raiz, NULL, tamanhos) == arv_altura_preta(arv));
+    if(tamanhos) CONFERE(arv_busca_tamanho(raiz) == arv_nnos(arv));
+    CONFERE(arv_vazia(arv) == (arv_nnos(arv) == 0));
+
+    Comparador *comp = arv_comparador(arv);
+    size_t contados = 0;
+    No *anterior = NULL;
+    for(No *no = arv_iter_inicio(arv); no != NULL; no = arv_iter_proximo(no)) {
+        if(anterior != NULL) CONFERE(comp(arv_busca_valor(anterior), arv_busca_valor(no)) <= 0);
+        CONFERE(arv_iter_anterior(no) == anterior);
+        anterior = no;
+        contados++;
+    }
+    CONFERE(anterior == arv_iter_fim(arv));
+    CONFERE(contados == arv_nnos(arv));
+}
+
+// confere que a árvore de ints `arv` tem exatamente os valores `v` em
+// [0, n) com presente[v] true, cada um uma vez
+static inline void confere_conjunto(Arvore *arv, const bool *presente, int n) {
+    size_t esperados = 0;
+    for(int v = 0; v < n; v++) {
+        CONFERE(arv_contem(arv, &v) == presente[v]);
+        esperados += presente[v];
+    }
+    CONFERE(arv_nnos(arv) == esperados);
+}
+
+#endif
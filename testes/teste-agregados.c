@@ -0,0 +1,207 @@
+// agregados das sub-árvores (arv_define_agregado): depois de cada tipo de
+// operação que altera a árvore, confere o agregado guardado em cada nó
+// contra o recalculado a partir dos filhos, e arv_agrega_intervalo contra
+// o agregado calculado percorrendo os dados do intervalo
+
+#include "comum.h"
+
+#define CHAVES 1000
+
+typedef struct {
+    int chave;
+    int peso;
+} Item;
+
+// soma e máximo dos pesos, quantidade e a última chave em ordem (que só
+// dá certo se os agregados forem combinados na ordem da árvore)
+typedef struct {
+    long soma;
+    int maximo;
+    size_t quantidade;
+    int ultima;
+} Agregado;
+
+static const Agregado VAZIO = { 0, -1, 0, -1 };
+
+static int compara_item(void *dado1, void *dado2) {
+    return compara_int(&((Item*)dado1)->chave, &((Item*)dado2)->chave);
+}
+
+// prefixo só da parte alta da chave, para as descidas de
+// arv_agrega_intervalo passarem por prefixos diferentes e iguais
+static uint64_t prefixo_item(void *dado) {
+    // os limites das consultas podem ser negativos
+    return (uint64_t)((int64_t)((Item*)dado)->chave + INT32_MAX + 1) / 16;
+}
+
+static Item* novo_item(int chave, int peso) {
+    Item *item = (Item*)malloc(sizeof(Item));
+    CONFERE(item != NULL);
+    item->chave = chave;
+    item->peso = peso;
+    return item;
+}
+
+static void acumula(void *acumulado, void *dado, void *contexto) {
+    (void)contexto;
+    Agregado *a = (Agregado*)acumulado;
+    Item *item = (Item*)dado;
+    a->soma += item->peso;
+    if(item->peso > a->maximo) a->maximo = item->peso;
+    a->quantidade++;
+    a->ultima = item->chave;
+}
+
+static void combina(void *acumulado, void *outro, void *contexto) {
+    (void)contexto;
+    Agregado *a = (Agregado*)acumulado;
+    Agregado *o = (Agregado*)outro;
+    a->soma += o->soma;
+    if(o->maximo > a->maximo) a->maximo = o->maximo;
+    a->quantidade += o->quantidade;
+    if(o->quantidade > 0) a->ultima = o->ultima;
+}
+
+static bool iguais(const Agregado *a, const Agregado *b) {
+    return a->soma == b->soma && a->maximo == b->maximo &&
+           a->quantidade == b->quantidade && a->ultima == b->ultima;
+}
+
+static Arvore* cria_arvore(bool pool, bool tamanhos) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_item, free, 64) : arv_cria(compara_item, free);
+    CONFERE(arv_define_tamanhos(arv, tamanhos));
+    CONFERE(arv_define_agregado(arv, sizeof(Agregado), &VAZIO, acumula, combina, NULL));
+    if(pool) CONFERE(arv_define_prefixo(arv, prefixo_item));
+    return arv;
+}
+
+// confere o agregado de cada nó contra o dos filhos e o dado do nó, e o
+// tamanho da sub-árvore se a árvore o guarda
+static void confere_no(No *no, bool tamanhos) {
+    if(no == NULL) return;
+    No *esq = arv_busca_filho(no, false);
+    No *dir = arv_busca_filho(no, true);
+    confere_no(esq, tamanhos);
+    confere_no(dir, tamanhos);
+
+    Agregado esperado = VAZIO;
+    if(esq != NULL) combina(&esperado, (void*)arv_busca_agregado(esq), NULL);
+    acumula(&esperado, arv_busca_valor(no), NULL);
+    if(dir != NULL) combina(&esperado, (void*)arv_busca_agregado(dir), NULL);
+    CONFERE(iguais((const Agregado*)arv_busca_agregado(no), &esperado));
+    if(tamanhos) CONFERE(esperado.quantidade == arv_busca_tamanho(no));
+}
+
+static void confere_agregados(Arvore *arv) {
+    confere_arvore(arv);
+    confere_no(arv_busca_raiz(arv), arv_guarda_tamanhos(arv));
+
+    for(int i = 0; i < 60; i++) {
+        Item lo = { aleatorio_ate(CHAVES + 200) - 100, 0 };
+        Item hi = { aleatorio_ate(CHAVES + 200) - 100, 0 };
+        bool com_lo = aleatorio_ate(5) != 0;
+        bool com_hi = aleatorio_ate(5) != 0;
+
+        Agregado resultado, esperado = VAZIO;
+        CONFERE(arv_agrega_intervalo(arv, com_lo ? &lo : NULL, com_hi ? &hi : NULL, &resultado));
+        for(No *no = arv_iter_inicio(arv); no != NULL; no = arv_iter_proximo(no)) {
+            Item *item = (Item*)arv_busca_valor(no);
+            if(com_lo && item->chave < lo.chave) continue;
+            if(com_hi && item->chave > hi.chave) continue;
+            acumula(&esperado, item, NULL);
+        }
+        CONFERE(iguais(&resultado, &esperado));
+    }
+}
+
+static void testa_agregados(bool pool, bool tamanhos) {
+    Arvore *arv = cria_arvore(pool, tamanhos);
+    confere_agregados(arv);
+
+    // todas as operações que alteram uma árvore
+    for(int i = 0; i < 3000; i++) {
+        int chave = aleatorio_ate(CHAVES);
+        int operacao = aleatorio_ate(10);
+        if(operacao < 5) {
+            CONFERE(arv_insere_no(arv, novo_item(chave, aleatorio_ate(10000))));
+        }
+        else if(operacao < 7) {
+            Item item = { chave, 0 };
+            arv_remove_no(arv, &item);
+        }
+        else if(operacao < 8) {
+            CONFERE(arv_atualiza(arv, novo_item(chave, aleatorio_ate(10000))));
+        }
+        else if(operacao < 9) {
+            Item *item = novo_item(chave, aleatorio_ate(100));
+            No *no = arv_insere_ou_busca(arv, item);
+            CONFERE(no != NULL);
+            if(arv_busca_valor(no) != item) free(item);
+        }
+        else if(!arv_vazia(arv)) {
+            CONFERE(arv_remove_no_handle(arv, arv_seleciona(arv, aleatorio_ate(arv_nnos(arv)))));
+        }
+        if(i % 100 == 0) confere_agregados(arv);
+    }
+    confere_agregados(arv);
+
+    void *dados[500];
+    for(int i = 0; i < 500; i++) dados[i] = novo_item(aleatorio_ate(CHAVES), aleatorio_ate(1000));
+    CONFERE(arv_insere_lote(arv, dados, 500) == 500);
+    confere_agregados(arv);
+
+    Item chave = { CHAVES / 2, 0 };
+    Arvore *menores, *maiores;
+    CONFERE(arv_divide(arv, &chave, &menores, &maiores));
+    confere_agregados(menores);
+    confere_agregados(maiores);
+    CONFERE(arv_junta(menores, maiores));
+    confere_agregados(menores);
+
+    // construção ordenada, e união com ela
+    Arvore *outra = cria_arvore(false, !tamanhos);
+    void *ordenados[800];
+    for(int i = 0; i < 800; i++) ordenados[i] = novo_item(i + CHAVES - 400, i);
+    CONFERE(arv_constroi_ordenado(outra, ordenados, 800));
+    confere_agregados(outra);
+    CONFERE(arv_uniao(menores, outra));
+    confere_agregados(menores);
+
+    // os nós de uma árvore sem agregado ganham agregado ao serem juntados
+    Arvore *sem_agregado = arv_cria(compara_item, free);
+    for(int i = 0; i < 100; i++) CONFERE(arv_insere_no(sem_agregado, novo_item(2 * CHAVES + i, i)));
+    CONFERE(arv_junta(menores, sem_agregado));
+    confere_agregados(menores);
+
+    // interseção e diferença
+    Arvore *filtro = cria_arvore(pool, tamanhos);
+    for(int i = 0; i < CHAVES; i += 3) CONFERE(arv_insere_no(filtro, novo_item(i, 0)));
+    CONFERE(arv_intersecao(menores, filtro));
+    confere_agregados(menores);
+    for(int i = 0; i < CHAVES; i += 6) CONFERE(arv_insere_no(filtro, novo_item(i, 0)));
+    CONFERE(arv_diferenca(menores, filtro));
+    confere_agregados(menores);
+
+    arv_libera_arvore(filtro);
+    arv_libera_arvore(sem_agregado);
+    arv_libera_arvore(outra);
+    arv_libera_arvore(maiores);
+    arv_libera_arvore(menores);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    for(int pool = 0; pool < 2; pool++) {
+        testa_agregados(pool, false);
+        testa_agregados(pool, true);
+    }
+
+    // sem agregado não há o que responder
+    Arvore *arv = arv_cria(compara_item, free);
+    Agregado resultado;
+    CONFERE(!arv_agrega_intervalo(arv, NULL, NULL, &resultado));
+    arv_libera_arvore(arv);
+
+    printf("teste-agregados: ok\n");
+    return 0;
+}
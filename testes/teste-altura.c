@@ -0,0 +1,112 @@
+// altura-preta mantida a cada operação (inclusive junção, divisão e
+// construção ordenada), os limites de altura e arv_estima_profundidades,
+// comparados com as profundidades calculadas percorrendo a árvore
+
+#include "comum.h"
+
+#define VALORES 5000
+
+// altura e soma das profundidades dos nós da sub-árvore de `no`, que
+// está na profundidade `profundidade`
+static int mede(No *no, int profundidade, size_t *soma, size_t *histograma) {
+    if(no == NULL) return 0;
+    *soma += (size_t)profundidade;
+    histograma[profundidade]++;
+    int esq = mede(arv_busca_filho(no, false), profundidade + 1, soma, histograma);
+    int dir = mede(arv_busca_filho(no, true), profundidade + 1, soma, histograma);
+    return 1 + (esq > dir ? esq : dir);
+}
+
+static void confere_alturas(Arvore *arv) {
+    confere_arvore(arv);
+
+    size_t soma = 0;
+    size_t histograma[ARV_MAX_PROFUNDIDADE + 1] = { 0 };
+    int altura = mede(arv_busca_raiz(arv), 1, &soma, histograma);
+    CONFERE(arv_altura(arv) == altura);
+    CONFERE(arv_altura_preta(arv) <= altura);
+    CONFERE(arv_altura_maxima(arv) == 2 * arv_altura_preta(arv));
+    CONFERE(altura <= arv_altura_maxima(arv));
+
+    ArvProfundidades prof;
+    size_t n = arv_nnos(arv);
+    if(n == 0) {
+        CONFERE(!arv_estima_profundidades(arv, 10, &prof));
+        CONFERE(altura == 0 && arv_altura_preta(arv) == 0);
+        return;
+    }
+
+    // amostrando todos os nós, a estimativa é exata
+    CONFERE(arv_estima_profundidades(arv, n + 10, &prof));
+    CONFERE(prof.amostras == n);
+    CONFERE(prof.maxima == altura);
+    CONFERE(prof.minima >= 1);
+    CONFERE(memcmp(prof.histograma, histograma, sizeof(histograma)) == 0);
+    double media = (double)soma / (double)n;
+    CONFERE(prof.media > media - 1e-9 && prof.media < media + 1e-9);
+
+    // com menos amostras, fica dentro dos limites
+    CONFERE(arv_estima_profundidades(arv, 7, &prof));
+    size_t amostras = 0;
+    for(int p = 0; p <= ARV_MAX_PROFUNDIDADE; p++) amostras += prof.histograma[p];
+    CONFERE(amostras == prof.amostras && amostras == (n < 7 ? n : 7));
+    CONFERE(prof.minima >= 1 && prof.maxima <= altura);
+    CONFERE(prof.media >= prof.minima && prof.media <= prof.maxima);
+}
+
+int main(void) {
+    // com os tamanhos das sub-árvores, as estimativas descem pela árvore
+    Arvore *arv = arv_cria(compara_int, free);
+    CONFERE(arv_define_tamanhos(arv, true));
+    CONFERE(!arv_estima_profundidades(arv, 10, NULL));
+    confere_alturas(arv);
+
+    // inserções e remoções, sempre com valores novos, crescendo e diminuindo
+    static bool presente[VALORES];
+    for(int i = 0; i < 30000; i++) {
+        int v = aleatorio_ate(VALORES);
+        bool insere = aleatorio_ate(100) < (i < 15000 ? 70 : 30);
+        if(insere && !presente[v]) {
+            CONFERE(arv_insere_no(arv, novo_int(v)));
+            presente[v] = true;
+        }
+        else if(!insere && presente[v]) {
+            CONFERE(arv_remove_no(arv, &v));
+            presente[v] = false;
+        }
+        if(i % 100 == 0) confere_alturas(arv);
+    }
+    confere_alturas(arv);
+
+    // divisão e junção mudam a altura-preta sem percorrer a árvore
+    for(int rodada = 0; rodada < 50; rodada++) {
+        int chave = aleatorio_ate(VALORES);
+        Arvore *menores, *maiores;
+        CONFERE(arv_divide(arv, &chave, &menores, &maiores));
+        confere_alturas(arv);
+        confere_alturas(menores);
+        confere_alturas(maiores);
+        CONFERE(arv_junta(maiores, menores));
+        confere_alturas(maiores);
+        arv_libera_arvore(menores);
+        arv_libera_arvore(arv);
+        arv = maiores;
+    }
+    arv_libera_arvore(arv);
+
+    // construção ordenada de todos os tamanhos pequenos, com e sem os
+    // tamanhos das sub-árvores
+    for(int n = 0; n < 300; n++) {
+        arv = arv_cria(compara_int, free);
+        CONFERE(arv_define_tamanhos(arv, n % 2 == 0));
+        void **dados = (void**)malloc((n + 1) * sizeof(void*));
+        for(int i = 0; i < n; i++) dados[i] = novo_int(i);
+        CONFERE(arv_constroi_ordenado(arv, dados, n));
+        free(dados);
+        confere_alturas(arv);
+        arv_libera_arvore(arv);
+    }
+
+    printf("teste-altura: ok\n");
+    return 0;
+}
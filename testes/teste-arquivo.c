@@ -0,0 +1,201 @@
+// arv_salva e arv_carrega: ida e volta com dados de tamanhos variados,
+// arquivos truncados e corrompidos, dados fora de ordem e falhas do
+// desserializador, conferindo que a árvore continua vazia e que os dados
+// já convertidos são liberados (pelo ASan e por um liberador que conta)
+
+#include <unistd.h>
+#include "comum.h"
+#include "../arvore-rn-arquivo.h"
+
+#define VALORES 3000
+
+static char diretorio[] = "/tmp/teste-arquivo-XXXXXX";
+static char caminho[64];
+
+static int liberados;
+static int convertidos;
+// o desserializador falha depois de converter este número de dados
+static int falha_em = -1;
+
+static int compara_str(void *dado1, void *dado2) {
+    return strcmp((char*)dado1, (char*)dado2);
+}
+
+static void libera_contando(void *dado) {
+    liberados++;
+    free(dado);
+}
+
+static size_t serializa(void *dado, void *buffer, size_t tam) {
+    size_t n = strlen((char*)dado);
+    if(n <= tam) memcpy(buffer, dado, n);
+    return n;
+}
+
+static void* desserializa(const void *buffer, size_t tam) {
+    if(convertidos == falha_em) return NULL;
+    char *str = (char*)malloc(tam + 1);
+    CONFERE(str != NULL);
+    memcpy(str, buffer, tam);
+    str[tam] = '\0';
+    convertidos++;
+    return str;
+}
+
+// inverte as strings, então os dados carregados ficam fora de ordem
+static void* desserializa_invertido(const void *buffer, size_t tam) {
+    char *str = (char*)desserializa(buffer, tam);
+    for(size_t i = 0; i < tam / 2; i++) {
+        char c = str[i];
+        str[i] = str[tam - 1 - i];
+        str[tam - 1 - i] = c;
+    }
+    return str;
+}
+
+// strings de tamanhos bem diferentes, para o serializador ser chamado
+// de novo com um buffer maior
+static char* nova_str(int v) {
+    size_t tam = v % 97 == 0 ? 5000 : v % 13 == 0 ? 0 : 8;
+    char *str = (char*)malloc(tam + 16);
+    CONFERE(str != NULL);
+    int n = sprintf(str, "%05d", v);
+    memset(str + n, 'x', tam);
+    str[n + tam] = '\0';
+    return str;
+}
+
+static void confere_iguais(Arvore *a, Arvore *b) {
+    confere_arvore(b);
+    CONFERE(arv_nnos(a) == arv_nnos(b));
+    No *y = arv_iter_inicio(b);
+    for(No *x = arv_iter_inicio(a); x != NULL; x = arv_iter_proximo(x)) {
+        CONFERE(y != NULL && strcmp((char*)arv_busca_valor(x), (char*)arv_busca_valor(y)) == 0);
+        y = arv_iter_proximo(y);
+    }
+    CONFERE(y == NULL);
+}
+
+// tenta carregar o arquivo, que deve falhar sem deixar nada na árvore
+static void confere_falha(Desserializador *d, Liberador *libera_arvore, Liberador *libera) {
+    Arvore *arv = arv_cria(compara_str, libera_arvore);
+    liberados = convertidos = 0;
+    CONFERE(!arv_carrega(arv, caminho, d, libera));
+    CONFERE(arv_vazia(arv));
+    CONFERE(liberados == convertidos);
+    arv_libera_arvore(arv);
+}
+
+static size_t le_arquivo(char **conteudo) {
+    FILE *f = fopen(caminho, "rb");
+    CONFERE(f != NULL);
+    fseek(f, 0, SEEK_END);
+    long tam = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    *conteudo = (char*)malloc(tam);
+    CONFERE(fread(*conteudo, 1, tam, f) == (size_t)tam);
+    fclose(f);
+    return (size_t)tam;
+}
+
+static void escreve_arquivo(const char *conteudo, size_t tam) {
+    FILE *f = fopen(caminho, "wb");
+    CONFERE(f != NULL);
+    CONFERE(fwrite(conteudo, 1, tam, f) == tam);
+    fclose(f);
+}
+
+int main(void) {
+    CONFERE(mkdtemp(diretorio) != NULL);
+    snprintf(caminho, sizeof(caminho), "%s/arvore.bin", diretorio);
+
+    Arvore *original = arv_cria(compara_str, free);
+    for(int i = 0; i < VALORES; i++) {
+        CONFERE(arv_insere_no(original, nova_str(aleatorio_ate(VALORES))));
+    }
+
+    // ida e volta, com e sem pool
+    CONFERE(arv_salva(original, caminho, serializa));
+    for(int pool = 0; pool < 2; pool++) {
+        Arvore *carregada = pool ? arv_cria_com_pool(compara_str, free, 32) : arv_cria(compara_str, free);
+        CONFERE(arv_carrega(carregada, caminho, desserializa, NULL));
+        confere_iguais(original, carregada);
+
+        // a árvore carregada continua utilizável
+        CONFERE(arv_insere_no(carregada, nova_str(VALORES)));
+        confere_arvore(carregada);
+
+        // só carrega em árvore vazia
+        CONFERE(!arv_carrega(carregada, caminho, desserializa, NULL));
+        confere_arvore(carregada);
+        arv_libera_arvore(carregada);
+    }
+
+    // dados fora de ordem, com o liberador da árvore, com um liberador
+    // explícito e com os dois
+    confere_falha(desserializa_invertido, libera_contando, NULL);
+    CONFERE(convertidos > 0);
+    confere_falha(desserializa_invertido, NULL, libera_contando);
+    confere_falha(desserializa_invertido, free, libera_contando);
+
+    // o desserializador falha no meio
+    falha_em = VALORES / 2;
+    confere_falha(desserializa, NULL, libera_contando);
+    CONFERE(convertidos == VALORES / 2);
+    falha_em = -1;
+
+    // arquivo que não existe
+    char salvo[64];
+    memcpy(salvo, caminho, sizeof(caminho));
+    snprintf(caminho, sizeof(caminho), "%s/nao-existe.bin", diretorio);
+    confere_falha(desserializa, libera_contando, NULL);
+    memcpy(caminho, salvo, sizeof(caminho));
+
+    // truncado em vários pontos, inclusive no meio do cabeçalho e no meio
+    // de um registro
+    char *conteudo;
+    size_t tam = le_arquivo(&conteudo);
+    for(size_t corte = 0; corte < tam; corte += corte < 64 ? 1 : 997) {
+        escreve_arquivo(conteudo, corte);
+        confere_falha(desserializa, libera_contando, NULL);
+    }
+
+    // identificação errada
+    conteudo[0] ^= 0x20;
+    escreve_arquivo(conteudo, tam);
+    confere_falha(desserializa, libera_contando, NULL);
+    conteudo[0] ^= 0x20;
+
+    // número de registros maior que o arquivo
+    uint64_t registros;
+    memcpy(&registros, conteudo + 8, sizeof(registros));
+    registros++;
+    memcpy(conteudo + 8, &registros, sizeof(registros));
+    escreve_arquivo(conteudo, tam);
+    confere_falha(desserializa, libera_contando, NULL);
+    registros--;
+    memcpy(conteudo + 8, &registros, sizeof(registros));
+
+    // tamanho de um registro que passa do fim do arquivo
+    uint32_t enorme = 0x7fffffff;
+    memcpy(conteudo + 16, &enorme, sizeof(enorme));
+    escreve_arquivo(conteudo, tam);
+    confere_falha(desserializa, libera_contando, NULL);
+    free(conteudo);
+
+    // árvore vazia
+    Arvore *vazia = arv_cria(compara_str, free);
+    CONFERE(arv_salva(vazia, caminho, serializa));
+    Arvore *carregada = arv_cria(compara_str, free);
+    CONFERE(arv_carrega(carregada, caminho, desserializa, NULL));
+    CONFERE(arv_vazia(carregada));
+    arv_libera_arvore(carregada);
+    arv_libera_arvore(vazia);
+
+    arv_libera_arvore(original);
+    unlink(caminho);
+    rmdir(diretorio);
+
+    printf("teste-arquivo: ok\n");
+    return 0;
+}
@@ -0,0 +1,96 @@
+// inserções e remoções aleatórias na árvore comum, com pool e intrusiva,
+// com e sem os tamanhos das sub-árvores, conferindo as propriedades da árvore e os valores contra um conjunto de
+// referência
+
+#include "comum.h"
+
+#define VALORES 2000
+#define OPERACOES 100000
+
+// dado de uma árvore intrusiva, com o nó embutido
+typedef struct {
+    int valor;
+    No no;
+} Registro;
+
+// cria uma árvore do tipo `modo`: 0 comum, 1 com pool, 2 intrusiva, e
+// 3 e 4 como 0 e 1, mas guardando os tamanhos das sub-árvores
+static Arvore* cria_arvore(int modo) {
+    if(modo == 2) {
+        Arvore *arv = arv_cria_intrusiva(compara_int, free, offsetof(Registro, no));
+        // o nó embutido não tem espaço para o tamanho
+        CONFERE(!arv_define_tamanhos(arv, true));
+        return arv;
+    }
+
+    Arvore *arv = modo % 2 == 1 ? arv_cria_com_pool(compara_int, free, 7) : arv_cria(compara_int, free);
+    CONFERE(arv_define_tamanhos(arv, modo >= 3));
+    CONFERE(arv_guarda_tamanhos(arv) == (modo >= 3));
+    return arv;
+}
+
+// retorna um novo dado com `valor` para uma árvore do tipo `modo`
+static void* novo_dado(int modo, int valor) {
+    if(modo != 2) return novo_int(valor);
+
+    Registro *registro = (Registro*)malloc(sizeof(Registro));
+    CONFERE(registro != NULL);
+    registro->valor = valor;
+    return registro;
+}
+
+static void testa_insercao_remocao(int modo) {
+    Arvore *arv = cria_arvore(modo);
+    CONFERE(arv != NULL);
+    confere_arvore(arv);
+
+    static bool presente[VALORES];
+    memset(presente, 0, sizeof(presente));
+
+    for(int i = 0; i < OPERACOES; i++) {
+        int v = aleatorio_ate(VALORES);
+        if(aleatorio_ate(2) == 0) {
+            if(!presente[v]) {
+                void *dado = novo_dado(modo, v);
+                CONFERE(arv_insere_no(arv, dado));
+                CONFERE(arv_busca_valor(arv_busca(arv, &v)) == dado);
+                presente[v] = true;
+            }
+        }
+        else {
+            CONFERE(arv_remove_no(arv, &v) == presente[v]);
+            presente[v] = false;
+        }
+
+        if(i % 997 == 0) confere_arvore(arv);
+    }
+
+    confere_arvore(arv);
+    confere_conjunto(arv, presente, VALORES);
+    arv_libera_arvore(arv);
+}
+
+// valores repetidos são aceitos e cada remoção tira só um deles
+static void testa_repetidos(void) {
+    Arvore *arv = arv_cria(compara_int, free);
+    for(int i = 0; i < 300; i++) CONFERE(arv_insere_no(arv, novo_int(i % 10)));
+    confere_arvore(arv);
+    CONFERE(arv_nnos(arv) == 300);
+
+    for(int i = 0; i < 300; i++) {
+        int v = i % 10;
+        CONFERE(arv_remove_no(arv, &v));
+        if(i % 17 == 0) confere_arvore(arv);
+    }
+    CONFERE(arv_vazia(arv));
+    confere_arvore(arv);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    for(int modo = 0; modo < 5; modo++) testa_insercao_remocao(modo);
+    testa_repetidos();
+
+    printf("teste-arvore: ok\n");
+    return 0;
+}
@@ -0,0 +1,86 @@
+// arv_busca_multipla contra arv_busca, com lotes de vários tamanhos (em
+// volta do tamanho dos grupos), chaves repetidas, presentes e ausentes,
+// árvores com repetidos e com prefixo
+
+#include "comum.h"
+
+#define VALORES 4000
+
+static uint64_t prefixo_int(void *dado) {
+    return (uint64_t)*(int*)dado ^ (UINT64_C(1) << 63);
+}
+
+static void confere_lote(Arvore *arv, int n) {
+    int *valores = (int*)malloc((n + 1) * sizeof(int));
+    void **chaves = (void**)malloc((n + 1) * sizeof(void*));
+    No **resultados = (No**)malloc((n + 1) * sizeof(No*));
+    for(int i = 0; i < n; i++) {
+        // alguns valores fora do intervalo e algumas chaves repetidas
+        valores[i] = aleatorio_ate(VALORES + 200) - 100;
+        if(i > 0 && aleatorio_ate(8) == 0) valores[i] = valores[i - 1];
+        chaves[i] = &valores[i];
+    }
+
+    size_t encontrados = arv_busca_multipla(arv, chaves, n, resultados);
+    size_t esperados = 0;
+    for(int i = 0; i < n; i++) {
+        CONFERE(resultados[i] == arv_busca(arv, chaves[i]));
+        esperados += resultados[i] != NULL;
+    }
+    CONFERE(encontrados == esperados);
+
+    free(valores);
+    free(chaves);
+    free(resultados);
+}
+
+static void testa_busca_multipla(bool prefixo, bool pool) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_int, free, 64) : arv_cria(compara_int, free);
+    if(prefixo) CONFERE(arv_define_prefixo(arv, prefixo_int));
+
+    confere_lote(arv, 0);
+    confere_lote(arv, 40);
+
+    // valores pares, alguns repetidos
+    for(int v = 0; v < VALORES; v += 2) {
+        CONFERE(arv_insere_no(arv, novo_int(v)));
+        if(v % 10 == 0) CONFERE(arv_insere_no(arv, novo_int(v)));
+    }
+    confere_arvore(arv);
+
+    for(int n = 0; n <= 70; n++) confere_lote(arv, n);
+    confere_lote(arv, 5000);
+
+    // depois de remoções, os nós removidos não são mais encontrados
+    for(int v = 0; v < VALORES; v += 6) arv_remove_no(arv, &v);
+    confere_lote(arv, 5000);
+
+    // todas as chaves presentes, em ordem
+    int *valores = (int*)malloc(VALORES * sizeof(int));
+    void **chaves = (void**)malloc(VALORES * sizeof(void*));
+    No **resultados = (No**)malloc(VALORES * sizeof(No*));
+    int n = 0;
+    for(No *no = arv_iter_inicio(arv); no != NULL && n < VALORES; no = arv_iter_proximo(no)) {
+        valores[n] = *(int*)arv_busca_valor(no);
+        chaves[n] = &valores[n];
+        n++;
+    }
+    CONFERE(arv_busca_multipla(arv, chaves, n, resultados) == (size_t)n);
+    for(int i = 0; i < n; i++) CONFERE(*(int*)arv_busca_valor(resultados[i]) == valores[i]);
+    free(valores);
+    free(chaves);
+    free(resultados);
+
+    CONFERE(arv_busca_multipla(arv, NULL, 10, NULL) == 0);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    for(int prefixo = 0; prefixo < 2; prefixo++) {
+        testa_busca_multipla(prefixo, false);
+        testa_busca_multipla(prefixo, true);
+    }
+
+    printf("teste-busca-multipla: ok\n");
+    return 0;
+}
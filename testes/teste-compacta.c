@@ -0,0 +1,121 @@
+// árvore compacta: inserções e remoções aleatórias com repetidos,
+// conferindo depois de cada operação as cores, a altura-preta, a ordem e
+// a lista de nós livres direto nos nós (por isso inclui
+// arvore-rn-compacta.c), e o conteúdo contra uma tabela de referência
+
+#include "../arvore-rn-compacta.c"
+#include "comum.h"
+
+#define VALORES 700
+
+// confere a sub-árvore com raiz `no` e retorna a sua altura-preta
+static int confere_sub_arvore_comp(ArvoreCompacta *arvc, uint32_t no, size_t *nos) {
+    if(no == ARV_COMP_NIL) return 1;
+    CONFERE(no < arvc->usados);
+
+    uint32_t esq = arv_comp_filho(arvc, no, ESQ);
+    uint32_t dir = arv_comp_filho(arvc, no, DIR);
+    if(arv_comp_cor(arvc, no) == VERMELHO) {
+        CONFERE(arv_comp_cor(arvc, esq) == PRETO);
+        CONFERE(arv_comp_cor(arvc, dir) == PRETO);
+    }
+    if(esq != ARV_COMP_NIL) CONFERE(arvc->comp(arvc->nos[esq].dado, arvc->nos[no].dado) <= 0);
+    if(dir != ARV_COMP_NIL) CONFERE(arvc->comp(arvc->nos[dir].dado, arvc->nos[no].dado) >= 0);
+
+    int altura_esq = confere_sub_arvore_comp(arvc, esq, nos);
+    int altura_dir = confere_sub_arvore_comp(arvc, dir, nos);
+    CONFERE(altura_esq == altura_dir);
+    (*nos)++;
+    return altura_esq + (arv_comp_cor(arvc, no) == PRETO);
+}
+
+static void confere_compacta(ArvoreCompacta *arvc) {
+    CONFERE(arv_comp_cor(arvc, arvc->raiz) == PRETO);
+    size_t nos = 0;
+    confere_sub_arvore_comp(arvc, arvc->raiz, &nos);
+    CONFERE(nos == arv_comp_nnos(arvc));
+
+    // todo nó já usado está na árvore ou na lista de livres
+    size_t livres = 0;
+    for(uint32_t no = arvc->livres; no != ARV_COMP_NIL; no = arvc->nos[no].filhos[ESQ]) {
+        CONFERE(no < arvc->usados);
+        livres++;
+    }
+    CONFERE(nos + livres + 1 == arvc->usados);
+    CONFERE(arvc->usados <= arvc->capacidade || arvc->nos == NULL);
+}
+
+typedef struct {
+    const int *contagem;
+    int valor;
+    int copia;
+} Percurso;
+
+// confere que o percurso passa pelos valores em ordem, com as repetições
+static void visita_em_ordem(void *dado, void *contexto) {
+    Percurso *p = (Percurso*)contexto;
+    while(p->valor < VALORES && p->copia == p->contagem[p->valor]) {
+        p->valor++;
+        p->copia = 0;
+    }
+    CONFERE(p->valor < VALORES && *(int*)dado == p->valor);
+    p->copia++;
+}
+
+static void confere_conteudo(ArvoreCompacta *arvc, const int *contagem) {
+    Percurso p = { contagem, 0, 0 };
+    arv_comp_percorre(arvc, visita_em_ordem, &p);
+    size_t total = 0;
+    for(int v = 0; v < VALORES; v++) {
+        total += contagem[v];
+        CONFERE(arv_comp_contem(arvc, &v) == (contagem[v] > 0));
+        void *dado = arv_comp_busca(arvc, &v);
+        if(dado != NULL) CONFERE(*(int*)dado == v);
+    }
+    CONFERE(total == arv_comp_nnos(arvc));
+}
+
+int main(void) {
+    ArvoreCompacta *arvc = arv_comp_cria(compara_int, free);
+    CONFERE(arvc != NULL);
+    CONFERE(arv_comp_cria(NULL, free) == NULL);
+    static int contagem[VALORES];
+    confere_compacta(arvc);
+    confere_conteudo(arvc, contagem);
+
+    // fases que crescem e esvaziam a árvore, para o vetor crescer e os
+    // nós livres serem reaproveitados
+    for(int fase = 0; fase < 6; fase++) {
+        int insercao = fase % 2 == 0 ? 3 : 1;
+        for(int i = 0; i < 4000; i++) {
+            int v = aleatorio_ate(VALORES);
+            if(aleatorio_ate(4) < insercao) {
+                CONFERE(arv_comp_insere_no(arvc, novo_int(v)));
+                contagem[v]++;
+            }
+            else {
+                CONFERE(arv_comp_remove_no(arvc, &v) == (contagem[v] > 0));
+                if(contagem[v] > 0) contagem[v]--;
+            }
+            confere_compacta(arvc);
+        }
+        confere_conteudo(arvc, contagem);
+    }
+
+    // esvazia a árvore toda e a enche de novo com valores em ordem
+    for(int v = 0; v < VALORES; v++) {
+        for(; contagem[v] > 0; contagem[v]--) CONFERE(arv_comp_remove_no(arvc, &v));
+    }
+    confere_compacta(arvc);
+    CONFERE(arv_comp_nnos(arvc) == 0 && arvc->raiz == ARV_COMP_NIL);
+    for(int v = 0; v < VALORES; v++) {
+        CONFERE(arv_comp_insere_no(arvc, novo_int(v)));
+        contagem[v]++;
+    }
+    confere_compacta(arvc);
+    confere_conteudo(arvc, contagem);
+    arv_comp_libera(arvc);
+
+    printf("teste-compacta: ok\n");
+    return 0;
+}
@@ -0,0 +1,92 @@
+// árvore concorrente: várias threads leitoras consultam com arv_conc_contem
+// e arv_conc_busca enquanto uma escritora insere e remove. os valores
+// pares ficam na árvore o tempo todo e têm que ser sempre encontrados, e
+// os ímpares entram e saem. no fim, a árvore envolvida é conferida e tem
+// que guardar exatamente os valores que a escritora deixou
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "comum.h"
+#include "../arvore-rn-concorrente.c"
+
+#define VALORES 2000
+#define LEITORAS 4
+#define ESCRITAS 40000
+
+static ArvoreConcorrente *arvc;
+static atomic_bool fim;
+static bool presente[VALORES];
+
+// confere que o dado encontrado é o valor buscado
+static void visita_valor(void *dado, void *contexto) {
+    CONFERE(*(int*)dado == *(int*)contexto);
+}
+
+static void* leitora(void *arg) {
+    // cada leitora tem o seu próprio gerador, já que o de comum.h não é
+    // feito para ser usado por várias threads
+    uint64_t estado = (uintptr_t)arg + 1;
+    long consultas = 0;
+    while(!atomic_load(&fim) || consultas < VALORES) {
+        estado = estado * 6364136223846793005ULL + 1442695040888963407ULL;
+        int v = (int)((estado >> 33) % VALORES);
+        bool contem = arv_conc_contem(arvc, &v);
+        bool achou = arv_conc_busca(arvc, &v, visita_valor, &v);
+        if(v % 2 == 0) CONFERE(contem && achou);
+        consultas++;
+    }
+    return NULL;
+}
+
+static void testa_concorrente(bool pool) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_int, free, 64) : arv_cria(compara_int, free);
+    CONFERE(arv_define_tamanhos(arv, pool));
+    memset(presente, 0, sizeof(presente));
+    for(int v = 0; v < VALORES; v += 2) {
+        CONFERE(arv_insere_no(arv, novo_int(v)));
+        presente[v] = true;
+    }
+    arvc = arv_conc_cria(arv);
+    CONFERE(arvc != NULL);
+    atomic_store(&fim, false);
+
+    pthread_t threads[LEITORAS];
+    for(int t = 0; t < LEITORAS; t++) {
+        CONFERE(pthread_create(&threads[t], NULL, leitora, (void*)(uintptr_t)t) == 0);
+    }
+
+    // a escritora é a thread principal, e só ela mexe nos ímpares
+    size_t num_nos = VALORES / 2;
+    for(int i = 0; i < ESCRITAS; i++) {
+        int v = aleatorio_ate(VALORES / 2) * 2 + 1;
+        if(presente[v]) {
+            CONFERE(arv_conc_remove_no(arvc, &v));
+            num_nos--;
+        }
+        else {
+            CONFERE(arv_conc_insere_no(arvc, novo_int(v)));
+            num_nos++;
+        }
+        presente[v] = !presente[v];
+    }
+
+    atomic_store(&fim, true);
+    for(int t = 0; t < LEITORAS; t++) CONFERE(pthread_join(threads[t], NULL) == 0);
+
+    // com todas as threads paradas, a árvore envolvida pode ser conferida
+    confere_arvore(arvc->arv);
+    CONFERE(arv_conc_nnos(arvc) == num_nos);
+    for(int v = 0; v < VALORES; v++) {
+        CONFERE(arv_conc_contem(arvc, &v) == presente[v]);
+        CONFERE(arv_contem(arvc->arv, &v) == presente[v]);
+    }
+    arv_conc_libera(arvc);
+}
+
+int main(void) {
+    testa_concorrente(false);
+    testa_concorrente(true);
+
+    printf("teste-concorrente: ok\n");
+    return 0;
+}
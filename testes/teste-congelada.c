@@ -0,0 +1,104 @@
+// cópias congeladas de árvores de vários tamanhos (em volta das potências
+// de 2, onde o último nível do layout de Eytzinger muda), com repetidos e
+// com prefixo, comparadas com as buscas da árvore original, inclusive
+// consultadas por várias threads ao mesmo tempo
+
+#include <pthread.h>
+#include "comum.h"
+#include "../arvore-rn-congelada.h"
+
+#define THREADS 4
+
+static uint64_t prefixo_int(void *dado) {
+    return (uint64_t)*(int*)dado ^ (UINT64_C(1) << 63);
+}
+
+// confere as consultas da cópia contra a árvore original para todos os
+// valores de [lo, hi]
+static void confere_copia(ArvoreCongelada *arvc, Arvore *arv, int lo, int hi) {
+    CONFERE(arv_cong_nnos(arvc) == arv_nnos(arv));
+    for(int v = lo; v <= hi; v++) {
+        void *dado = arv_cong_busca(arvc, &v);
+        CONFERE(arv_cong_contem(arvc, &v) == arv_contem(arv, &v));
+        CONFERE((dado != NULL) == arv_contem(arv, &v));
+        if(dado != NULL) CONFERE(*(int*)dado == v);
+
+        // o limite inferior é o mesmo dado (o primeiro dos repetidos)
+        CONFERE(arv_cong_limite_inferior(arvc, &v) == arv_busca_valor(arv_limite_inferior(arv, &v)));
+    }
+}
+
+static void testa_tamanhos(bool prefixo, int copias) {
+    for(int n = 0; n <= 1100; n++) {
+        // só os tamanhos pequenos e os vizinhos das potências de 2
+        if(n > 70 && ((n + 1) & n) != 0 && (n & (n - 1)) != 0 && ((n - 1) & (n - 2)) != 0) continue;
+
+        Arvore *arv = arv_cria(compara_int, free);
+        if(prefixo) CONFERE(arv_define_prefixo(arv, prefixo_int));
+        for(int i = 0; i < n; i++) {
+            int v = 3 * (i / copias) - 100;
+            CONFERE(arv_insere_no(arv, novo_int(v)));
+        }
+
+        ArvoreCongelada *arvc = arv_congela(arv);
+        CONFERE(arvc != NULL);
+        confere_copia(arvc, arv, -105, 3 * n / copias - 95);
+
+        // mudanças na árvore original não aparecem na cópia
+        int novo = 1;
+        CONFERE(arv_insere_no(arv, novo_int(novo)));
+        CONFERE(arv_cong_nnos(arvc) == (size_t)n);
+        CONFERE(!arv_cong_contem(arvc, &novo));
+
+        arv_cong_libera(arvc);
+        arv_libera_arvore(arv);
+    }
+}
+
+typedef struct {
+    ArvoreCongelada *arvc;
+    int inicio;
+} Consulta;
+
+// cada thread consulta a cópia começando de um ponto diferente
+static void* consulta(void *arg) {
+    Consulta *c = (Consulta*)arg;
+    for(int rodada = 0; rodada < 4; rodada++) {
+        for(int i = 0; i < 20000; i++) {
+            int v = (c->inicio + i) % 20000;
+            void *dado = arv_cong_busca(c->arvc, &v);
+            CONFERE((dado != NULL) == (v % 2 == 0));
+        }
+    }
+    return NULL;
+}
+
+static void testa_threads(void) {
+    Arvore *arv = arv_cria(compara_int, free);
+    for(int v = 0; v < 20000; v += 2) CONFERE(arv_insere_no(arv, novo_int(v)));
+    ArvoreCongelada *arvc = arv_congela(arv);
+    CONFERE(arvc != NULL);
+
+    pthread_t threads[THREADS];
+    Consulta consultas[THREADS];
+    for(int i = 0; i < THREADS; i++) {
+        consultas[i] = (Consulta){ arvc, i * 5000 };
+        CONFERE(pthread_create(&threads[i], NULL, consulta, &consultas[i]) == 0);
+    }
+    for(int i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+
+    arv_cong_libera(arvc);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    CONFERE(arv_congela(NULL) == NULL);
+    for(int prefixo = 0; prefixo < 2; prefixo++) {
+        testa_tamanhos(prefixo, 1);
+        testa_tamanhos(prefixo, 3);
+    }
+    testa_threads();
+
+    printf("teste-congelada: ok\n");
+    return 0;
+}
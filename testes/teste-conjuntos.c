@@ -0,0 +1,184 @@
+// arv_junta, arv_divide e as operações de conjunto (arv_uniao,
+// arv_intersecao e arv_diferenca), entre árvores comuns e com pool (que
+// aqui guardam os tamanhos das sub-árvores), conferindo as árvores
+// resultantes, o conteúdo contra conjuntos de referência e quantos dados
+// cada operação libera
+
+#include "comum.h"
+
+#define VALORES 600
+
+static int liberados;
+
+static void libera_contando(void *dado) {
+    liberados++;
+    free(dado);
+}
+
+static Arvore* cria_arvore(bool pool) {
+    if(!pool) return arv_cria(compara_int, libera_contando);
+    Arvore *arv = arv_cria_com_pool(compara_int, libera_contando, 8);
+    CONFERE(arv_define_tamanhos(arv, true));
+    return arv;
+}
+
+// preenche `arv` com os valores de `presente`, cada um `copias` vezes
+static void preenche(Arvore *arv, const bool *presente, int copias) {
+    for(int v = 0; v < VALORES; v++) {
+        if(!presente[v]) continue;
+        for(int c = 0; c < copias; c++) CONFERE(arv_insere_no(arv, novo_int(v)));
+    }
+}
+
+static void sorteia(bool *presente, int porcentagem) {
+    for(int v = 0; v < VALORES; v++) presente[v] = aleatorio_ate(100) < porcentagem;
+}
+
+// confere que `arv` tem exatamente os valores em [lo, hi) de `presente`,
+// cada um `copias` vezes
+static void confere_faixa(Arvore *arv, const bool *presente, int lo, int hi, int copias) {
+    confere_arvore(arv);
+    No *no = arv_iter_inicio(arv);
+    for(int v = lo; v < hi; v++) {
+        if(!presente[v]) continue;
+        for(int c = 0; c < copias; c++) {
+            CONFERE(no != NULL && *(int*)arv_busca_valor(no) == v);
+            no = arv_iter_proximo(no);
+        }
+    }
+    CONFERE(no == NULL);
+}
+
+// divide e junta de volta em chaves sorteadas, nas duas ordens
+static void testa_divide_junta(bool pool, int copias) {
+    static bool presente[VALORES];
+    sorteia(presente, 50);
+    Arvore *arv = cria_arvore(pool);
+    preenche(arv, presente, copias);
+
+    for(int rodada = 0; rodada < 100; rodada++) {
+        int chave = aleatorio_ate(VALORES + 2) - 1;
+        Arvore *menores, *maiores;
+        CONFERE(arv_divide(arv, &chave, &menores, &maiores));
+        CONFERE(arv_vazia(arv));
+        confere_faixa(menores, presente, 0, chave < 0 ? 0 : chave, copias);
+        confere_faixa(maiores, presente, chave < 0 ? 0 : chave > VALORES ? VALORES : chave, VALORES, copias);
+
+        // junta nas duas ordens, e a junção de volta não libera nada
+        liberados = 0;
+        if(aleatorio_ate(2) == 0) {
+            CONFERE(arv_junta(menores, maiores));
+            CONFERE(arv_vazia(maiores));
+            arv_libera_arvore(maiores);
+            arv_libera_arvore(arv);
+            arv = menores;
+        }
+        else {
+            CONFERE(arv_junta(maiores, menores));
+            CONFERE(arv_vazia(menores));
+            arv_libera_arvore(menores);
+            arv_libera_arvore(arv);
+            arv = maiores;
+        }
+        CONFERE(liberados == 0);
+        confere_faixa(arv, presente, 0, VALORES, copias);
+    }
+
+    // dados entrelaçados não são juntados, e nenhuma árvore muda
+    static bool pares[VALORES], impares[VALORES];
+    for(int v = 0; v < VALORES; v++) {
+        pares[v] = v % 2 == 0;
+        impares[v] = v % 2 == 1;
+    }
+    Arvore *a = cria_arvore(pool), *b = cria_arvore(!pool);
+    preenche(a, pares, copias);
+    preenche(b, impares, copias);
+    CONFERE(!arv_junta(a, b));
+    CONFERE(!arv_junta(b, a));
+    confere_faixa(a, pares, 0, VALORES, copias);
+    confere_faixa(b, impares, 0, VALORES, copias);
+    arv_libera_arvore(a);
+    arv_libera_arvore(b);
+
+    // junção entre árvores que alocam de jeitos diferentes copia os nós
+    Arvore *outra = cria_arvore(!pool);
+    for(int v = 0; v < 100; v++) {
+        CONFERE(arv_insere_no(outra, novo_int(VALORES + v)));
+    }
+    CONFERE(arv_junta(arv, outra));
+    CONFERE(arv_vazia(outra));
+    confere_arvore(arv);
+    size_t total = 100;
+    for(int v = 0; v < VALORES; v++) total += presente[v] ? copias : 0;
+    CONFERE(arv_nnos(arv) == total);
+    CONFERE(*(int*)arv_busca_valor(arv_iter_fim(arv)) == VALORES + 99);
+    arv_libera_arvore(outra);
+    arv_libera_arvore(arv);
+}
+
+// as três operações de conjunto contra os conjuntos de referência
+static void testa_operacoes(bool pool_a, bool pool_b, int porcentagem_a, int porcentagem_b) {
+    static bool em_a[VALORES], em_b[VALORES], esperado[VALORES];
+
+    for(int operacao = 0; operacao < 3; operacao++) {
+        sorteia(em_a, porcentagem_a);
+        sorteia(em_b, porcentagem_b);
+        Arvore *a = cria_arvore(pool_a);
+        Arvore *b = cria_arvore(pool_b);
+        CONFERE(arv_define_unicos(a, true));
+        CONFERE(arv_define_unicos(b, true));
+        preenche(a, em_a, 1);
+        preenche(b, em_b, 1);
+
+        // quantos dados das duas árvores devem ser liberados
+        int esperados = 0;
+        for(int v = 0; v < VALORES; v++) {
+            if(operacao == 0) esperado[v] = em_a[v] || em_b[v];
+            else if(operacao == 1) esperado[v] = em_a[v] && em_b[v];
+            else esperado[v] = em_a[v] && !em_b[v];
+            esperados += em_a[v] + em_b[v] - esperado[v];
+        }
+
+        liberados = 0;
+        if(operacao == 0) CONFERE(arv_uniao(a, b));
+        else if(operacao == 1) CONFERE(arv_intersecao(a, b));
+        else CONFERE(arv_diferenca(a, b));
+        CONFERE(liberados == esperados);
+        CONFERE(arv_vazia(b));
+        confere_faixa(a, esperado, 0, VALORES, 1);
+
+        // o resultado continua utilizável
+        for(int i = 0; i < 200; i++) {
+            int v = aleatorio_ate(VALORES);
+            if(esperado[v]) CONFERE(arv_remove_no(a, &v));
+            else CONFERE(arv_insere_no(a, novo_int(v)));
+            esperado[v] = !esperado[v];
+        }
+        confere_faixa(a, esperado, 0, VALORES, 1);
+
+        arv_libera_arvore(b);
+        arv_libera_arvore(a);
+    }
+}
+
+int main(void) {
+    for(int pool = 0; pool < 2; pool++) {
+        testa_divide_junta(pool, 1);
+        testa_divide_junta(pool, 3);
+    }
+
+    // tamanhos parecidos, muito diferentes e árvores vazias
+    int porcentagens[][2] = { {50, 50}, {90, 3}, {3, 90}, {0, 50}, {50, 0}, {100, 100} };
+    for(int pool_a = 0; pool_a < 2; pool_a++) {
+        for(int pool_b = 0; pool_b < 2; pool_b++) {
+            for(size_t i = 0; i < sizeof(porcentagens) / sizeof(porcentagens[0]); i++) {
+                for(int rodada = 0; rodada < 10; rodada++) {
+                    testa_operacoes(pool_a, pool_b, porcentagens[i][0], porcentagens[i][1]);
+                }
+            }
+        }
+    }
+
+    printf("teste-conjuntos: ok\n");
+    return 0;
+}
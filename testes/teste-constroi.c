@@ -0,0 +1,101 @@
+// arv_constroi_ordenado: árvores de 0 a algumas centenas de nós, comuns,
+// com pool (e os tamanhos das sub-árvores) e intrusivas, conferidas logo
+// depois da construção e depois de inserções e remoções sobre os nós
+// construídos
+
+#include "comum.h"
+
+typedef struct {
+    int valor;
+    No no;
+} Registro;
+
+static Arvore* cria_arvore(int modo) {
+    if(modo == 1) {
+        Arvore *arv = arv_cria_com_pool(compara_int, free, 5);
+        CONFERE(arv_define_tamanhos(arv, true));
+        return arv;
+    }
+    if(modo == 2) return arv_cria_intrusiva(compara_int, free, offsetof(Registro, no));
+    return arv_cria(compara_int, free);
+}
+
+static void* novo_dado(int modo, int valor) {
+    if(modo != 2) return novo_int(valor);
+
+    Registro *registro = (Registro*)malloc(sizeof(Registro));
+    CONFERE(registro != NULL);
+    registro->valor = valor;
+    return registro;
+}
+
+static void testa_construcao(int modo, int n) {
+    Arvore *arv = cria_arvore(modo);
+    static bool presente[1024];
+    memset(presente, 0, sizeof(presente));
+
+    // valores pares, para sobrar espaço para as inserções
+    void **dados = (void**)malloc((n + 1) * sizeof(void*));
+    for(int i = 0; i < n; i++) {
+        dados[i] = novo_dado(modo, 2 * i);
+        presente[2 * i] = true;
+    }
+    CONFERE(arv_constroi_ordenado(arv, dados, n));
+    confere_arvore(arv);
+    confere_conjunto(arv, presente, 2 * n + 2);
+    for(int i = 0; i < n; i++) CONFERE(arv_busca_valor(arv_seleciona(arv, i)) == dados[i]);
+
+    // só constrói a partir de uma árvore vazia
+    if(n > 0) CONFERE(!arv_constroi_ordenado(arv, dados, n));
+    free(dados);
+
+    for(int i = 0; i < 2 * n; i++) {
+        int v = aleatorio_ate(2 * n + 2);
+        if(aleatorio_ate(2) == 0) {
+            if(!presente[v]) {
+                CONFERE(arv_insere_no(arv, novo_dado(modo, v)));
+                presente[v] = true;
+            }
+        }
+        else {
+            CONFERE(arv_remove_no(arv, &v) == presente[v]);
+            presente[v] = false;
+        }
+        confere_arvore(arv);
+    }
+    confere_conjunto(arv, presente, 2 * n + 2);
+    arv_libera_arvore(arv);
+}
+
+// dados fora de ordem ou NULL são recusados sem alterar a árvore
+static void testa_recusas(void) {
+    Arvore *arv = arv_cria(compara_int, free);
+    int a = 1, b = 3, c = 2;
+
+    void *fora_de_ordem[3] = { &a, &b, &c };
+    CONFERE(!arv_constroi_ordenado(arv, fora_de_ordem, 3));
+    CONFERE(arv_vazia(arv));
+
+    void *com_nulo[3] = { &a, NULL, &c };
+    CONFERE(!arv_constroi_ordenado(arv, com_nulo, 3));
+    CONFERE(arv_vazia(arv));
+
+    CONFERE(arv_constroi_ordenado(arv, NULL, 0));
+    CONFERE(arv_vazia(arv));
+
+    // repetidos em ordem são aceitos
+    void *repetidos[4] = { novo_int(1), novo_int(1), novo_int(1), novo_int(2) };
+    CONFERE(arv_constroi_ordenado(arv, repetidos, 4));
+    confere_arvore(arv);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    for(int modo = 0; modo < 3; modo++) {
+        for(int n = 0; n < 500; n += (n < 40 ? 1 : 37)) testa_construcao(modo, n);
+    }
+    testa_recusas();
+
+    printf("teste-constroi: ok\n");
+    return 0;
+}
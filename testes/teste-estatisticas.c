@@ -0,0 +1,134 @@
+// estatísticas da árvore (arv_estatisticas): contagem de operações,
+// histogramas, nós alocados e liberados, e os limites de rotações e de
+// comparações por operação de uma árvore rubro-negra, inclusive com
+// várias threads buscando ao mesmo tempo.
+// inclui arvore-rn.c com ARV_ESTATISTICAS definido, então roda mesmo que
+// a biblioteca tenha sido compilada sem as estatísticas.
+
+#ifndef ARV_ESTATISTICAS
+#define ARV_ESTATISTICAS
+#endif
+#include "../arvore-rn.c"
+#include <pthread.h>
+#include "comum.h"
+
+#define VALORES 3000
+#define THREADS 4
+#define BUSCAS_POR_THREAD 5000
+
+static ArvEstatisticas le(Arvore *arv) {
+    ArvEstatisticas est;
+    CONFERE(arv_estatisticas(arv, &est));
+    return est;
+}
+
+// cada histograma soma o número de operações do seu tipo
+static void confere_histogramas(const ArvEstatisticas *est) {
+    for(int op = 0; op < ARV_NUM_OPS; op++) {
+        uint64_t soma = 0;
+        for(int f = 0; f < ARV_FAIXAS_LATENCIA; f++) soma += est->latencias[op][f];
+        CONFERE(soma == est->operacoes[op]);
+    }
+}
+
+static void testa_operacoes(bool pool) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_int, free, 16) : arv_cria(compara_int, free);
+    static bool presente[VALORES];
+    memset(presente, 0, sizeof(presente));
+    uint64_t insercoes = 0, remocoes = 0, buscas = 0;
+
+    for(int i = 0; i < 20000; i++) {
+        int v = aleatorio_ate(VALORES);
+        ArvEstatisticas antes = le(arv);
+        int altura = arv_altura(arv);
+
+        if(aleatorio_ate(3) == 0) {
+            CONFERE(arv_contem(arv, &v) == presente[v]);
+            buscas++;
+
+            // uma comparação por nível, sem rotações
+            ArvEstatisticas depois = le(arv);
+            uint64_t comparacoes = depois.comparacoes - antes.comparacoes;
+            CONFERE(comparacoes <= (uint64_t)altura);
+            CONFERE(arv_vazia(arv) || comparacoes >= 1);
+            CONFERE(depois.rotacoes == antes.rotacoes);
+        }
+        else if(!presente[v]) {
+            CONFERE(arv_insere_no(arv, novo_int(v)));
+            presente[v] = true;
+            insercoes++;
+
+            // a correção da inserção faz no máximo 2 rotações
+            ArvEstatisticas depois = le(arv);
+            CONFERE(depois.rotacoes - antes.rotacoes <= 2);
+            CONFERE(depois.iteracoes_fixup_insercao - antes.iteracoes_fixup_insercao <= (uint64_t)altura);
+            CONFERE(depois.nos_alocados - antes.nos_alocados == 1);
+        }
+        else {
+            CONFERE(arv_remove_no(arv, &v));
+            presente[v] = false;
+            remocoes++;
+
+            // e a da remoção no máximo 3
+            ArvEstatisticas depois = le(arv);
+            CONFERE(depois.rotacoes - antes.rotacoes <= 3);
+            CONFERE(depois.iteracoes_fixup_remocao - antes.iteracoes_fixup_remocao <= (uint64_t)altura);
+            CONFERE(depois.nos_liberados - antes.nos_liberados == 1);
+        }
+    }
+    confere_arvore(arv);
+
+    ArvEstatisticas est = le(arv);
+    CONFERE(est.operacoes[ARV_OP_INSERE] == insercoes);
+    CONFERE(est.operacoes[ARV_OP_REMOVE] == remocoes);
+    CONFERE(est.operacoes[ARV_OP_BUSCA] == buscas);
+    CONFERE(est.nos_alocados - est.nos_liberados == arv_nnos(arv));
+    CONFERE(est.comparacoes_prefixo == 0);
+    confere_histogramas(&est);
+
+    // zerar não afeta a árvore
+    arv_zera_estatisticas(arv);
+    est = le(arv);
+    ArvEstatisticas zero;
+    memset(&zero, 0, sizeof(zero));
+    CONFERE(memcmp(&est, &zero, sizeof(zero)) == 0);
+    confere_arvore(arv);
+    arv_libera_arvore(arv);
+}
+
+static void* busca_tudo(void *arg) {
+    Arvore *arv = (Arvore*)arg;
+    for(int i = 0; i < BUSCAS_POR_THREAD; i++) {
+        int v = i % VALORES;
+        CONFERE(arv_contem(arv, &v) == (v % 2 == 0));
+    }
+    return NULL;
+}
+
+// cada thread conta nos seus próprios contadores, e a soma não perde nada
+static void testa_threads(void) {
+    Arvore *arv = arv_cria(compara_int, free);
+    for(int v = 0; v < VALORES; v += 2) CONFERE(arv_insere_no(arv, novo_int(v)));
+    arv_zera_estatisticas(arv);
+
+    pthread_t threads[THREADS];
+    for(int i = 0; i < THREADS; i++) {
+        CONFERE(pthread_create(&threads[i], NULL, busca_tudo, arv) == 0);
+    }
+    for(int i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+
+    ArvEstatisticas est = le(arv);
+    CONFERE(est.operacoes[ARV_OP_BUSCA] == THREADS * BUSCAS_POR_THREAD);
+    CONFERE(est.comparacoes >= est.operacoes[ARV_OP_BUSCA]);
+    confere_histogramas(&est);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    testa_operacoes(false);
+    testa_operacoes(true);
+    testa_threads();
+
+    printf("teste-estatisticas: ok\n");
+    return 0;
+}
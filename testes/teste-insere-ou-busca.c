@@ -0,0 +1,173 @@
+// arv_insere_ou_busca, arv_atualiza e a recusa de repetidos
+// (arv_define_unicos) nas inserções, no lote, na construção ordenada, na
+// junção e na união
+
+#include "comum.h"
+
+#define CHAVES 500
+
+// dado com uma chave (usada pelo comparador) e a versão que o inseriu
+typedef struct {
+    int chave;
+    int versao;
+} Item;
+
+static int compara_item(void *dado1, void *dado2) {
+    return compara_int(&((Item*)dado1)->chave, &((Item*)dado2)->chave);
+}
+
+static Item* novo_item(int chave, int versao) {
+    Item *item = (Item*)malloc(sizeof(Item));
+    CONFERE(item != NULL);
+    item->chave = chave;
+    item->versao = versao;
+    return item;
+}
+
+// arv_insere_ou_busca e arv_atualiza contra uma tabela com a versão
+// atual de cada chave, com e sem pool
+static void testa_insere_ou_busca(bool pool) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_item, free, 16) : arv_cria(compara_item, free);
+    static int versao[CHAVES];
+    for(int k = 0; k < CHAVES; k++) versao[k] = -1;
+
+    for(int i = 0; i < 20000; i++) {
+        int k = aleatorio_ate(CHAVES);
+        Item *item = novo_item(k, i);
+        int operacao = aleatorio_ate(3);
+
+        if(operacao == 0) {
+            No *no = arv_insere_ou_busca(arv, item);
+            CONFERE(no != NULL);
+            if(versao[k] >= 0) {
+                // já existia: devolve o nó antigo e o item continua nosso
+                CONFERE(((Item*)arv_busca_valor(no))->versao == versao[k]);
+                free(item);
+            }
+            else {
+                CONFERE(arv_busca_valor(no) == item);
+                versao[k] = i;
+            }
+        }
+        else if(operacao == 1) {
+            CONFERE(arv_atualiza(arv, item));
+            versao[k] = i;
+        }
+        else {
+            CONFERE(arv_remove_no(arv, item) == (versao[k] >= 0));
+            versao[k] = -1;
+            free(item);
+        }
+
+        if(i % 500 == 0) confere_arvore(arv);
+    }
+
+    confere_arvore(arv);
+    size_t presentes = 0;
+    for(int k = 0; k < CHAVES; k++) {
+        Item chave = { k, 0 };
+        No *no = arv_busca(arv, &chave);
+        CONFERE((no != NULL) == (versao[k] >= 0));
+        if(no != NULL) CONFERE(((Item*)arv_busca_valor(no))->versao == versao[k]);
+        presentes += no != NULL;
+    }
+    CONFERE(arv_nnos(arv) == presentes);
+    arv_libera_arvore(arv);
+}
+
+// inserções, lote e construção ordenada com repetidos recusados
+static void testa_unicos(void) {
+    Arvore *arv = arv_cria(compara_int, free);
+    CONFERE(arv_define_unicos(arv, true));
+
+    int *um = novo_int(1);
+    CONFERE(arv_insere_no(arv, um));
+    int *repetido = novo_int(1);
+    CONFERE(!arv_insere_no(arv, repetido));
+    CONFERE(arv_define_unicos(arv, false) == false);
+
+    // o lote insere os novos primeiro, em ordem, e deixa os recusados no fim
+    void *dados[6] = { novo_int(3), repetido, novo_int(2), novo_int(3), novo_int(0), novo_int(2) };
+    size_t inseridos = arv_insere_lote(arv, dados, 6);
+    CONFERE(inseridos == 3);
+    for(size_t i = 1; i < inseridos; i++) CONFERE(compara_int(dados[i - 1], dados[i]) < 0);
+    for(size_t i = inseridos; i < 6; i++) {
+        CONFERE(arv_busca_valor(arv_busca(arv, dados[i])) != dados[i]);
+        free(dados[i]);
+    }
+    CONFERE(arv_nnos(arv) == 4);
+    confere_arvore(arv);
+    arv_libera_arvore(arv);
+
+    // a construção ordenada recusa vizinhos iguais
+    Arvore *construida = arv_cria(compara_int, free);
+    arv_define_unicos(construida, true);
+    int a = 1, b = 2, c = 2;
+    void *com_repetido[3] = { &a, &b, &c };
+    CONFERE(!arv_constroi_ordenado(construida, com_repetido, 3));
+    CONFERE(arv_vazia(construida));
+    arv_libera_arvore(construida);
+}
+
+// cria uma árvore que recusa repetidos com os valores `valores`
+static Arvore* cria_unicos(const int *valores, int n, bool unicos) {
+    Arvore *arv = arv_cria(compara_int, free);
+    arv_define_unicos(arv, unicos);
+    for(int i = 0; i < n; i++) CONFERE(arv_insere_no(arv, novo_int(valores[i])));
+    return arv;
+}
+
+// a junção e a união não podem criar repetidos em uma árvore que os recusa
+static void testa_junta_unicos(void) {
+    const int menores[] = { 1, 5 };
+    const int maiores[] = { 5, 9 };
+    const int disjuntos[] = { 6, 9 };
+
+    // {1, 5} + {5, 9}: o 5 ficaria repetido, nas duas ordens
+    Arvore *arv = cria_unicos(menores, 2, true);
+    Arvore *outra = cria_unicos(maiores, 2, true);
+    CONFERE(!arv_junta(arv, outra));
+    CONFERE(!arv_junta(outra, arv));
+    CONFERE(arv_nnos(arv) == 2 && arv_nnos(outra) == 2);
+    arv_libera_arvore(outra);
+
+    // `outra` aceita repetidos: a junção não confere os dados dela
+    outra = cria_unicos(disjuntos, 2, false);
+    CONFERE(!arv_junta(arv, outra));
+    CONFERE(!arv_uniao(arv, outra));
+    arv_libera_arvore(outra);
+
+    // {1, 5} + {6, 9} junta normalmente
+    outra = cria_unicos(disjuntos, 2, true);
+    CONFERE(arv_junta(arv, outra));
+    CONFERE(arv_nnos(arv) == 4 && arv_vazia(outra));
+    confere_arvore(arv);
+    arv_libera_arvore(outra);
+
+    // a união de conjuntos guarda um só 5
+    outra = cria_unicos(maiores, 2, true);
+    CONFERE(arv_uniao(arv, outra));
+    CONFERE(arv_nnos(arv) == 4);
+    confere_arvore(arv);
+    arv_libera_arvore(outra);
+    arv_libera_arvore(arv);
+
+    // sem recusar repetidos, a junção com o limite igual continua valendo
+    arv = cria_unicos(menores, 2, false);
+    outra = cria_unicos(maiores, 2, false);
+    CONFERE(arv_junta(arv, outra));
+    CONFERE(arv_nnos(arv) == 4);
+    confere_arvore(arv);
+    arv_libera_arvore(outra);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    testa_insere_ou_busca(false);
+    testa_insere_ou_busca(true);
+    testa_unicos();
+    testa_junta_unicos();
+
+    printf("teste-insere-ou-busca: ok\n");
+    return 0;
+}
@@ -0,0 +1,143 @@
+// árvore de intervalos: busca de um sobreposto, enumeração das
+// sobreposições e perfuração comparadas com uma busca linear, depois de
+// inserções e remoções aleatórias, inclusive com os limites de int64_t
+
+#include "comum.h"
+#include "../arvore-rn-intervalos.h"
+
+#define MAXIMO 4000
+
+typedef struct {
+    Intervalo iv;
+    int id;
+} Reserva;
+
+// intervalos na árvore, para a busca linear de referência
+static Reserva *vivos[MAXIMO];
+static int num_vivos;
+
+// contexto de conta_visitado: quantos foram visitados e se vieram em
+// ordem de início
+typedef struct {
+    int visitados;
+    int64_t ultimo_inicio;
+    bool em_ordem;
+} Contagem;
+
+static void conta_visitado(void *dado, void *contexto) {
+    Reserva *r = (Reserva*)dado;
+    Contagem *c = (Contagem*)contexto;
+    if(r->iv.inicio < c->ultimo_inicio) c->em_ordem = false;
+    c->ultimo_inicio = r->iv.inicio;
+    c->visitados++;
+}
+
+static int conta_sobrepostos(int64_t inicio, int64_t fim) {
+    int total = 0;
+    for(int i = 0; i < num_vivos; i++) {
+        total += vivos[i]->iv.inicio <= fim && vivos[i]->iv.fim >= inicio;
+    }
+    return total;
+}
+
+// confere as três consultas com [inicio, fim]
+static void confere_consultas(ArvoreIntervalos *arvi, int64_t inicio, int64_t fim) {
+    int esperado = conta_sobrepostos(inicio, fim);
+
+    Contagem c = { 0, INT64_MIN, true };
+    CONFERE(arv_int_sobreposicoes(arvi, inicio, fim, conta_visitado, &c) == (size_t)esperado);
+    CONFERE(c.visitados == esperado && c.em_ordem);
+
+    Reserva *r = (Reserva*)arv_int_busca_sobreposto(arvi, inicio, fim);
+    CONFERE((r != NULL) == (esperado > 0));
+    if(r != NULL) CONFERE(r->iv.inicio <= fim && r->iv.fim >= inicio);
+
+    int no_ponto = conta_sobrepostos(inicio, inicio);
+    c = (Contagem){ 0, INT64_MIN, true };
+    CONFERE(arv_int_perfura(arvi, inicio, conta_visitado, &c) == (size_t)no_ponto);
+}
+
+static Reserva* nova_reserva(int64_t inicio, int64_t fim, int id) {
+    Reserva *r = (Reserva*)malloc(sizeof(Reserva));
+    CONFERE(r != NULL);
+    r->iv.inicio = inicio;
+    r->iv.fim = fim;
+    r->id = id;
+    return r;
+}
+
+static void testa_aleatorio(void) {
+    ArvoreIntervalos *arvi = arv_int_cria(free);
+    CONFERE(arvi != NULL);
+
+    Reserva invalida = { { 5, 3 }, 0 };
+    CONFERE(!arv_int_insere(arvi, &invalida));
+
+    for(int i = 0; i < 20000; i++) {
+        if(num_vivos < MAXIMO && aleatorio_ate(3) != 0) {
+            int64_t inicio = aleatorio_ate(10000);
+            int64_t duracao = aleatorio_ate(aleatorio_ate(4) != 0 ? 50 : 2000);
+            Reserva *r = nova_reserva(inicio, inicio + duracao, i);
+            CONFERE(arv_int_insere(arvi, r));
+            vivos[num_vivos++] = r;
+        }
+        else if(num_vivos > 0) {
+            int k = aleatorio_ate(num_vivos);
+            CONFERE(arv_int_remove(arvi, vivos[k]));
+            vivos[k] = vivos[--num_vivos];
+        }
+
+        if(i % 50 == 0) {
+            int64_t inicio = aleatorio_ate(11000) - 500;
+            confere_consultas(arvi, inicio, inicio + aleatorio_ate(aleatorio_ate(2) != 0 ? 10 : 500));
+        }
+    }
+    CONFERE(arv_int_nnos(arvi) == (size_t)num_vivos);
+
+    // só remove o próprio ponteiro, não um intervalo igual
+    if(num_vivos > 0) {
+        Reserva copia = *vivos[0];
+        CONFERE(!arv_int_remove(arvi, &copia));
+    }
+
+    arv_int_libera(arvi);
+    num_vivos = 0;
+}
+
+// consultas com os limites de int64_t, inclusive INT64_MIN, que é o maior
+// fim de uma sub-árvore vazia
+static void testa_extremos(void) {
+    ArvoreIntervalos *arvi = arv_int_cria(free);
+
+    confere_consultas(arvi, INT64_MIN, INT64_MIN);
+    confere_consultas(arvi, INT64_MIN, INT64_MAX);
+
+    vivos[num_vivos++] = nova_reserva(5, 10, 0);
+    CONFERE(arv_int_insere(arvi, vivos[0]));
+    confere_consultas(arvi, INT64_MIN, INT64_MIN);
+    confere_consultas(arvi, INT64_MIN, 4);
+    confere_consultas(arvi, INT64_MIN, 7);
+    confere_consultas(arvi, INT64_MIN, INT64_MAX);
+    confere_consultas(arvi, 11, INT64_MAX);
+    confere_consultas(arvi, INT64_MAX, INT64_MAX);
+
+    vivos[num_vivos++] = nova_reserva(INT64_MIN, INT64_MIN, 1);
+    vivos[num_vivos++] = nova_reserva(INT64_MAX, INT64_MAX, 2);
+    vivos[num_vivos++] = nova_reserva(INT64_MIN, INT64_MAX, 3);
+    for(int i = 1; i < num_vivos; i++) CONFERE(arv_int_insere(arvi, vivos[i]));
+    confere_consultas(arvi, INT64_MIN, INT64_MIN);
+    confere_consultas(arvi, INT64_MAX, INT64_MAX);
+    confere_consultas(arvi, 0, 0);
+    confere_consultas(arvi, INT64_MIN, INT64_MAX);
+
+    arv_int_libera(arvi);
+    num_vivos = 0;
+}
+
+int main(void) {
+    testa_aleatorio();
+    testa_extremos();
+
+    printf("teste-intervalos: ok\n");
+    return 0;
+}
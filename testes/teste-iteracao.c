@@ -0,0 +1,98 @@
+// iteração nos dois sentidos, remoção do nó atual durante a iteração e
+// arv_intervalo, contra uma tabela com a quantidade de cada valor
+
+#include "comum.h"
+
+#define VALORES 400
+
+// percorre a árvore nos dois sentidos conferindo contra `contagem`
+static void confere_iteracao(Arvore *arv, const int *contagem) {
+    No *no = arv_iter_inicio(arv);
+    for(int v = 0; v < VALORES; v++) {
+        for(int c = 0; c < contagem[v]; c++) {
+            CONFERE(no != NULL && *(int*)arv_busca_valor(no) == v);
+            no = arv_iter_proximo(no);
+        }
+    }
+    CONFERE(no == NULL);
+
+    no = arv_iter_fim(arv);
+    for(int v = VALORES - 1; v >= 0; v--) {
+        for(int c = 0; c < contagem[v]; c++) {
+            CONFERE(no != NULL && *(int*)arv_busca_valor(no) == v);
+            no = arv_iter_anterior(no);
+        }
+    }
+    CONFERE(no == NULL);
+}
+
+// confere arv_intervalo(lo, hi) contando os nós de cada valor
+static void confere_intervalo(Arvore *arv, const int *contagem, int lo, int hi) {
+    ArvIntervalo it = arv_intervalo(arv, &lo, &hi);
+    int anterior = -1;
+    size_t nos = 0;
+    for(No *no = it.inicio; no != it.fim; no = arv_iter_proximo(no)) {
+        CONFERE(no != NULL);
+        int v = *(int*)arv_busca_valor(no);
+        CONFERE(v >= lo && v <= hi && v >= anterior);
+        anterior = v;
+        nos++;
+    }
+
+    size_t esperados = 0;
+    for(int v = lo < 0 ? 0 : lo; v <= hi && v < VALORES; v++) esperados += contagem[v];
+    CONFERE(nos == esperados);
+
+    // `fim` é o primeiro nó depois do intervalo
+    if(it.fim != NULL) CONFERE(*(int*)arv_busca_valor(it.fim) > hi);
+    if(esperados == 0) CONFERE(it.inicio == it.fim);
+}
+
+static void testa_iteracao(bool pool) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_int, free, 16) : arv_cria(compara_int, free);
+    static int contagem[VALORES];
+    memset(contagem, 0, sizeof(contagem));
+
+    CONFERE(arv_iter_inicio(arv) == NULL);
+    CONFERE(arv_iter_fim(arv) == NULL);
+    confere_intervalo(arv, contagem, 0, VALORES);
+
+    for(int rodada = 0; rodada < 100; rodada++) {
+        for(int i = 0; i < 40; i++) {
+            int v = aleatorio_ate(VALORES);
+            CONFERE(arv_insere_no(arv, novo_int(v)));
+            contagem[v]++;
+        }
+        confere_iteracao(arv, contagem);
+        for(int i = 0; i < 30; i++) {
+            int lo = aleatorio_ate(VALORES + 20) - 10;
+            int hi = lo + aleatorio_ate(VALORES / 4) - 5;
+            confere_intervalo(arv, contagem, lo, hi);
+        }
+
+        // remove os nós de um intervalo durante a iteração,
+        // pegando o próximo antes de remover o atual
+        int lo = aleatorio_ate(VALORES);
+        int hi = lo + aleatorio_ate(20);
+        ArvIntervalo it = arv_intervalo(arv, &lo, &hi);
+        for(No *no = it.inicio; no != it.fim;) {
+            No *proximo = arv_iter_proximo(no);
+            if(aleatorio_ate(2) == 0) {
+                contagem[*(int*)arv_busca_valor(no)]--;
+                CONFERE(arv_remove_no_handle(arv, no));
+            }
+            no = proximo;
+        }
+        confere_arvore(arv);
+        confere_iteracao(arv, contagem);
+    }
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    testa_iteracao(false);
+    testa_iteracao(true);
+
+    printf("teste-iteracao: ok\n");
+    return 0;
+}
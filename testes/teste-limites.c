@@ -0,0 +1,72 @@
+// arv_limite_inferior, arv_limite_superior, arv_piso e arv_teto para
+// todos os valores, com repetidos, contra uma tabela com a quantidade de
+// cada valor
+
+#include "comum.h"
+
+#define VALORES 300
+
+// confere que `no` é o primeiro (ou o último) nó com o valor `v`
+static void confere_no(No *no, int v, bool ultimo) {
+    CONFERE(no != NULL && *(int*)arv_busca_valor(no) == v);
+    No *vizinho = ultimo ? arv_iter_proximo(no) : arv_iter_anterior(no);
+    CONFERE(vizinho == NULL || *(int*)arv_busca_valor(vizinho) != v);
+}
+
+static void confere_limites(Arvore *arv, const int *contagem) {
+    for(int v = -2; v < VALORES + 2; v++) {
+        // o menor valor presente >= v, o menor > v e o maior <= v
+        int maior_igual = -1, maior = -1, menor_igual = -1;
+        for(int w = VALORES - 1; w >= 0; w--) {
+            if(contagem[w] == 0) continue;
+            if(w >= v) maior_igual = w;
+            if(w > v) maior = w;
+            if(w <= v && menor_igual < 0) menor_igual = w;
+        }
+
+        No *inferior = arv_limite_inferior(arv, &v);
+        if(maior_igual < 0) CONFERE(inferior == NULL);
+        else confere_no(inferior, maior_igual, false);
+        CONFERE(arv_teto(arv, &v) == inferior);
+
+        No *superior = arv_limite_superior(arv, &v);
+        if(maior < 0) CONFERE(superior == NULL);
+        else confere_no(superior, maior, false);
+
+        No *piso = arv_piso(arv, &v);
+        if(menor_igual < 0) CONFERE(piso == NULL);
+        else confere_no(piso, menor_igual, true);
+    }
+}
+
+static void testa_limites(bool pool) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_int, free, 16) : arv_cria(compara_int, free);
+    static int contagem[VALORES];
+    memset(contagem, 0, sizeof(contagem));
+    confere_limites(arv, contagem);
+
+    for(int rodada = 0; rodada < 150; rodada++) {
+        for(int i = 0; i < 20; i++) {
+            int v = aleatorio_ate(VALORES);
+            if(aleatorio_ate(3) != 0) {
+                CONFERE(arv_insere_no(arv, novo_int(v)));
+                contagem[v]++;
+            }
+            else {
+                CONFERE(arv_remove_no(arv, &v) == (contagem[v] > 0));
+                if(contagem[v] > 0) contagem[v]--;
+            }
+        }
+        confere_arvore(arv);
+        confere_limites(arv, contagem);
+    }
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    testa_limites(false);
+    testa_limites(true);
+
+    printf("teste-limites: ok\n");
+    return 0;
+}
@@ -0,0 +1,88 @@
+// arv_insere_lote: lotes aleatórios em árvores vazias e não vazias,
+// com e sem repetidos, conferindo a árvore e a contagem de cada valor
+// contra uma tabela depois de cada lote
+
+#include "comum.h"
+
+#define VALORES 2000
+
+// confere a quantidade de cada valor na árvore contra `contagem`
+static void confere_contagem(Arvore *arv, const int *contagem) {
+    static int vistos[VALORES];
+    memset(vistos, 0, sizeof(vistos));
+    for(No *no = arv_iter_inicio(arv); no != NULL; no = arv_iter_proximo(no)) {
+        int v = *(int*)arv_busca_valor(no);
+        CONFERE(v >= 0 && v < VALORES);
+        vistos[v]++;
+    }
+    CONFERE(memcmp(vistos, contagem, sizeof(vistos)) == 0);
+}
+
+static void testa_lotes(bool unicos, bool pool) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_int, free, 32) : arv_cria(compara_int, free);
+    CONFERE(arv_define_unicos(arv, unicos));
+    static int contagem[VALORES];
+    memset(contagem, 0, sizeof(contagem));
+
+    for(int rodada = 0; rodada < 60; rodada++) {
+        size_t n = aleatorio_ate(rodada % 10 == 0 ? 400 : 40);
+        void **dados = (void**)malloc((n + 1) * sizeof(void*));
+        for(size_t i = 0; i < n; i++) dados[i] = novo_int(aleatorio_ate(VALORES));
+
+        size_t inseridos = arv_insere_lote(arv, dados, n);
+        CONFERE(inseridos <= n);
+        if(!unicos) CONFERE(inseridos == n);
+
+        // os inseridos ficam em ordem no começo do vetor e estão na árvore
+        for(size_t i = 0; i < inseridos; i++) {
+            if(i > 0) CONFERE(compara_int(dados[i - 1], dados[i]) <= 0);
+            contagem[*(int*)dados[i]]++;
+        }
+        // os outros continuam sendo do usuário: só podem ser repetidos
+        for(size_t i = inseridos; i < n; i++) {
+            CONFERE(unicos);
+            CONFERE(arv_busca(arv, dados[i]) != NULL);
+            CONFERE(arv_busca_valor(arv_busca(arv, dados[i])) != dados[i]);
+            free(dados[i]);
+        }
+        free(dados);
+
+        confere_arvore(arv);
+        confere_contagem(arv, contagem);
+        if(unicos) {
+            for(int v = 0; v < VALORES; v++) CONFERE(contagem[v] <= 1);
+        }
+
+        // algumas remoções entre os lotes
+        for(int i = 0; i < 20; i++) {
+            int v = aleatorio_ate(VALORES);
+            CONFERE(arv_remove_no(arv, &v) == (contagem[v] > 0));
+            if(contagem[v] > 0) contagem[v]--;
+        }
+        confere_arvore(arv);
+    }
+    confere_contagem(arv, contagem);
+    arv_libera_arvore(arv);
+}
+
+// um dado NULL faz o lote inteiro ser recusado
+static void testa_nulo(void) {
+    Arvore *arv = arv_cria(compara_int, free);
+    int a = 1, b = 2;
+    void *dados[3] = { &a, NULL, &b };
+    CONFERE(arv_insere_lote(arv, dados, 3) == 0);
+    CONFERE(arv_vazia(arv));
+    CONFERE(arv_insere_lote(arv, NULL, 0) == 0);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    testa_lotes(false, false);
+    testa_lotes(false, true);
+    testa_lotes(true, false);
+    testa_lotes(true, true);
+    testa_nulo();
+
+    printf("teste-lote: ok\n");
+    return 0;
+}
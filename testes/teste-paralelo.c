@@ -0,0 +1,158 @@
+// arv_percorre_paralelo, arv_reduz_paralelo e arv_libera_arvore_paralelo
+// (também por arv_libera_arvore, com arv_define_threads_liberacao)
+// em árvores abaixo e acima do tamanho mínimo do paralelismo, com 1, 2, 4
+// e 0 (um por processador) threads: cada dado é visitado uma vez, a
+// redução respeita a ordem da árvore e cada dado é liberado uma vez
+
+#include <stdatomic.h>
+#include "comum.h"
+
+#define MAX_NOS 60000
+#define BASE_HASH UINT64_C(1000003)
+
+typedef struct {
+    int valor;
+    int id;
+} Dado;
+
+static _Atomic int visitas[MAX_NOS];
+static _Atomic int liberados;
+
+static int compara_dado(void *dado1, void *dado2) {
+    return compara_int(&((Dado*)dado1)->valor, &((Dado*)dado2)->valor);
+}
+
+static void libera_contando(void *dado) {
+    atomic_fetch_add(&liberados, 1);
+    free(dado);
+}
+
+static void visita(void *dado, void *contexto) {
+    CONFERE(contexto == (void*)visitas);
+    atomic_fetch_add(&visitas[((Dado*)dado)->id], 1);
+}
+
+// resultado da redução: a quantidade, o hash polinomial dos ids na ordem
+// (que depende da ordem, mas é associativo) e se os valores estão em ordem
+typedef struct {
+    size_t quantidade;
+    uint64_t hash;
+    uint64_t potencia;
+    int primeiro;
+    int ultimo;
+    bool ordenado;
+} Resumo;
+
+static const Resumo RESUMO_VAZIO = { 0, 0, 1, 0, 0, true };
+
+static void acumula(void *acumulado, void *dado, void *contexto) {
+    (void)contexto;
+    Resumo *r = (Resumo*)acumulado;
+    Dado *d = (Dado*)dado;
+    if(r->quantidade == 0) r->primeiro = d->valor;
+    else if(r->ultimo > d->valor) r->ordenado = false;
+    r->ultimo = d->valor;
+    r->hash = r->hash * BASE_HASH + (uint64_t)d->id;
+    r->potencia *= BASE_HASH;
+    r->quantidade++;
+}
+
+static void combina(void *acumulado, void *outro, void *contexto) {
+    (void)contexto;
+    Resumo *r = (Resumo*)acumulado;
+    Resumo *o = (Resumo*)outro;
+    if(o->quantidade == 0) return;
+    if(r->quantidade == 0) {
+        *r = *o;
+        return;
+    }
+    r->ordenado = r->ordenado && o->ordenado && r->ultimo <= o->primeiro;
+    r->ultimo = o->ultimo;
+    r->hash = r->hash * o->potencia + o->hash;
+    r->potencia *= o->potencia;
+    r->quantidade += o->quantidade;
+}
+
+static Arvore* cria_arvore(int n, bool pool) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_dado, libera_contando, 256)
+                       : arv_cria(compara_dado, libera_contando);
+    for(int i = 0; i < n; i++) {
+        Dado *dado = (Dado*)malloc(sizeof(Dado));
+        CONFERE(dado != NULL);
+        // valores repetidos, com ids únicos
+        dado->valor = aleatorio_ate(n / 2 + 1);
+        dado->id = i;
+        CONFERE(arv_insere_no(arv, dado));
+    }
+    return arv;
+}
+
+static void testa_tamanho(int n, bool pool) {
+    Arvore *arv = cria_arvore(n, pool);
+
+    // a redução feita em ordem por uma thread só, para comparar
+    Resumo esperado = RESUMO_VAZIO;
+    for(No *no = arv_iter_inicio(arv); no != NULL; no = arv_iter_proximo(no)) {
+        acumula(&esperado, arv_busca_valor(no), NULL);
+    }
+    CONFERE(esperado.ordenado && esperado.quantidade == (size_t)n);
+
+    int threads[] = { 1, 2, 4, 0, 1000 };
+    for(size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        for(int i = 0; i < n; i++) atomic_store(&visitas[i], 0);
+        arv_percorre_paralelo(arv, threads[t], visita, (void*)visitas);
+        for(int i = 0; i < n; i++) CONFERE(atomic_load(&visitas[i]) == 1);
+
+        Resumo resumo = RESUMO_VAZIO;
+        arv_reduz_paralelo(arv, threads[t], &resumo, sizeof(Resumo), acumula, combina, NULL);
+        CONFERE(resumo.quantidade == esperado.quantidade);
+        CONFERE(resumo.ordenado);
+        CONFERE(resumo.hash == esperado.hash);
+        CONFERE(resumo.potencia == esperado.potencia);
+    }
+    confere_arvore(arv);
+
+    atomic_store(&liberados, 0);
+    if((n + pool) % 2 == 0) {
+        arv_libera_arvore_paralelo(arv, aleatorio_ate(5));
+    }
+    else {
+        // arv_libera_arvore com o número de threads definido na árvore
+        CONFERE(!arv_define_threads_liberacao(arv, -1));
+        CONFERE(arv_define_threads_liberacao(arv, aleatorio_ate(5)));
+        arv_libera_arvore(arv);
+    }
+    CONFERE(atomic_load(&liberados) == n);
+}
+
+// com o pool compartilhado depois de uma divisão, a liberação é feita
+// só pela thread que chamou, e cada árvore libera só os seus dados
+static void testa_pool_compartilhado(void) {
+    Arvore *arv = cria_arvore(40000, true);
+    CONFERE(arv_define_threads_liberacao(arv, 4));
+    Dado chave = { 10000, 0 };
+    Arvore *menores, *maiores;
+    CONFERE(arv_divide(arv, &chave, &menores, &maiores));
+    size_t n_menores = arv_nnos(menores);
+    size_t n_maiores = arv_nnos(maiores);
+
+    atomic_store(&liberados, 0);
+    arv_libera_arvore_paralelo(menores, 4);
+    CONFERE((size_t)atomic_load(&liberados) == n_menores);
+    confere_arvore(maiores);
+    arv_libera_arvore(maiores);
+    CONFERE((size_t)atomic_load(&liberados) == n_menores + n_maiores);
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    int tamanhos[] = { 0, 1, 100, 16383, 16384, 16385, MAX_NOS };
+    for(size_t i = 0; i < sizeof(tamanhos) / sizeof(tamanhos[0]); i++) {
+        testa_tamanho(tamanhos[i], false);
+        testa_tamanho(tamanhos[i], true);
+    }
+    testa_pool_compartilhado();
+
+    printf("teste-paralelo: ok\n");
+    return 0;
+}
@@ -0,0 +1,228 @@
+// árvore persistente: versões guardadas no meio de inserções e remoções
+// continuam iguais aos conjuntos de referência da época, com as cores e a
+// altura-preta conferidas direto nos nós (por isso inclui
+// arvore-rn-persistente.c); os dados só são liberados quando nenhuma
+// versão viva os contém; e leitores em outras threads sempre veem uma
+// versão completa
+
+#include "../arvore-rn-persistente.c"
+#include "comum.h"
+
+#define VALORES 800
+#define VERSOES 24
+#define LEITORES 3
+#define ESCRITAS 6000
+
+typedef struct {
+    int valor;
+} Dado;
+
+// dados liberados pela árvore e dados criados pelo teste
+static _Atomic int liberados;
+static int ids;
+
+static int compara_dado(void *dado1, void *dado2) {
+    return compara_int(&((Dado*)dado1)->valor, &((Dado*)dado2)->valor);
+}
+
+static void libera_dado(void *dado) {
+    atomic_fetch_add(&liberados, 1);
+    free(dado);
+}
+
+static Dado* novo_dado(int valor) {
+    Dado *dado = (Dado*)malloc(sizeof(Dado));
+    CONFERE(dado != NULL);
+    dado->valor = valor;
+    ids++;
+    return dado;
+}
+
+// confere a sub-árvore com raiz `no` e retorna a sua altura-preta
+static int confere_sub_arvore_pers(VersaoPersistente *versao, NoPersistente *no, size_t *nos) {
+    if(no == NULL) return 1;
+    CONFERE(atomic_load(&no->refs) >= 1);
+    CONFERE(atomic_load(no->refs_dado) >= 1);
+
+    NoPersistente *esq = no->filhos[ESQ];
+    NoPersistente *dir = no->filhos[DIR];
+    if(no->cor == VERMELHO) {
+        CONFERE(arv_pers_cor(esq) == PRETO);
+        CONFERE(arv_pers_cor(dir) == PRETO);
+    }
+    if(esq != NULL) CONFERE(versao->comp(esq->dado, no->dado) < 0);
+    if(dir != NULL) CONFERE(versao->comp(dir->dado, no->dado) > 0);
+
+    int altura_esq = confere_sub_arvore_pers(versao, esq, nos);
+    int altura_dir = confere_sub_arvore_pers(versao, dir, nos);
+    CONFERE(altura_esq == altura_dir);
+    (*nos)++;
+    return altura_esq + (no->cor == PRETO);
+}
+
+typedef struct {
+    const bool *presente;
+    int proximo;
+    size_t vistos;
+} Percurso;
+
+static void visita_presente(void *dado, void *contexto) {
+    Percurso *p = (Percurso*)contexto;
+    int v = ((Dado*)dado)->valor;
+    CONFERE(v >= p->proximo && p->presente[v]);
+    p->proximo = v + 1;
+    p->vistos++;
+}
+
+// confere a versão contra o conjunto `presente`
+static void confere_versao(VersaoPersistente *versao, const bool *presente) {
+    CONFERE(arv_pers_cor(versao->raiz) == PRETO);
+    size_t nos = 0;
+    confere_sub_arvore_pers(versao, versao->raiz, &nos);
+    CONFERE(nos == arv_pers_nnos(versao));
+
+    Percurso p = { presente, 0, 0 };
+    arv_pers_percorre(versao, visita_presente, &p);
+    CONFERE(p.vistos == nos);
+
+    for(int v = 0; v < VALORES; v++) {
+        Dado chave = { v };
+        CONFERE(arv_pers_contem(versao, &chave) == presente[v]);
+        Dado *dado = (Dado*)arv_pers_busca(versao, &chave);
+        if(dado != NULL) CONFERE(dado->valor == v);
+    }
+}
+
+static void testa_versoes(void) {
+    ArvorePersistente *arvp = arv_pers_cria(compara_dado, libera_dado);
+    CONFERE(arvp != NULL);
+    atomic_store(&liberados, 0);
+    ids = 0;
+
+    static bool presente[VALORES];
+    static bool guardado[VERSOES][VALORES];
+    VersaoPersistente *versoes[VERSOES] = { NULL };
+    memset(presente, 0, sizeof(presente));
+
+    for(int i = 0; i < ESCRITAS; i++) {
+        int v = aleatorio_ate(VALORES);
+        Dado chave = { v };
+        if(presente[v]) {
+            CONFERE(arv_pers_remove_no(arvp, &chave));
+        }
+        else {
+            CONFERE(arv_pers_insere_no(arvp, novo_dado(v)));
+        }
+        presente[v] = !presente[v];
+
+        // guarda a versão atual no lugar de uma antiga, que é solta
+        if(i % 50 == 0) {
+            int k = aleatorio_ate(VERSOES);
+            arv_pers_solta(versoes[k]);
+            versoes[k] = arv_pers_versao(arvp);
+            memcpy(guardado[k], presente, sizeof(presente));
+
+            VersaoPersistente *atual = arv_pers_versao(arvp);
+            confere_versao(atual, presente);
+            arv_pers_solta(atual);
+        }
+
+        // as versões guardadas não mudaram
+        if(i % 500 == 0) {
+            for(int k = 0; k < VERSOES; k++) {
+                if(versoes[k] != NULL) confere_versao(versoes[k], guardado[k]);
+            }
+        }
+    }
+
+    // nenhum dado de uma versão viva foi liberado: os que estão em alguma
+    // versão guardada ou na atual continuam acessíveis (conferido pelo ASan)
+    for(int k = 0; k < VERSOES; k++) {
+        if(versoes[k] != NULL) confere_versao(versoes[k], guardado[k]);
+    }
+    int vivos = 0;
+    for(int v = 0; v < VALORES; v++) vivos += presente[v];
+    CONFERE(atomic_load(&liberados) <= ids - vivos);
+
+    // soltas as versões guardadas, as próximas escritas soltam as antigas
+    // e só ficam os dados da versão atual: os `vivos` e o último valor
+    // inserido (o primeiro valor extra já foi removido)
+    for(int k = 0; k < VERSOES; k++) arv_pers_solta(versoes[k]);
+    CONFERE(arv_pers_insere_no(arvp, novo_dado(VALORES)));
+    Dado chave_extra = { VALORES };
+    CONFERE(arv_pers_remove_no(arvp, &chave_extra));
+    CONFERE(arv_pers_insere_no(arvp, novo_dado(VALORES)));
+    CONFERE(atomic_load(&liberados) == ids - vivos - 1);
+
+    // uma versão pega antes da liberação da árvore continua válida
+    VersaoPersistente *ultima = arv_pers_versao(arvp);
+    arv_pers_libera(arvp);
+    CONFERE(arv_pers_nnos(ultima) == (size_t)vivos + 1);
+    arv_pers_solta(ultima);
+    CONFERE(atomic_load(&liberados) == ids);
+}
+
+// o escritor insere os valores 0, 1, 2, ... em ordem e depois os remove
+// na mesma ordem, então toda versão tem os valores de um intervalo
+// [inicio, fim), que os leitores conferem
+typedef struct {
+    ArvorePersistente *arvp;
+    _Atomic bool terminou;
+} Compartilhado;
+
+static void visita_intervalo(void *dado, void *contexto) {
+    int *esperado = (int*)contexto;
+    CONFERE(((Dado*)dado)->valor == *esperado);
+    (*esperado)++;
+}
+
+static void* le_versoes(void *arg) {
+    Compartilhado *c = (Compartilhado*)arg;
+    while(!atomic_load(&c->terminou)) {
+        VersaoPersistente *versao = arv_pers_versao(c->arvp);
+        size_t n = arv_pers_nnos(versao);
+        if(n > 0) {
+            NoPersistente *no = versao->raiz;
+            while(no->filhos[ESQ] != NULL) no = no->filhos[ESQ];
+            int inicio = ((Dado*)no->dado)->valor;
+            int esperado = inicio;
+            arv_pers_percorre(versao, visita_intervalo, &esperado);
+            CONFERE((size_t)(esperado - inicio) == n);
+        }
+        arv_pers_solta(versao);
+    }
+    return NULL;
+}
+
+static void testa_leitores(void) {
+    Compartilhado c;
+    c.arvp = arv_pers_cria(compara_dado, libera_dado);
+    CONFERE(c.arvp != NULL);
+    atomic_init(&c.terminou, false);
+    atomic_store(&liberados, 0);
+
+    pthread_t leitores[LEITORES];
+    for(int i = 0; i < LEITORES; i++) {
+        CONFERE(pthread_create(&leitores[i], NULL, le_versoes, &c) == 0);
+    }
+
+    for(int v = 0; v < 3000; v++) CONFERE(arv_pers_insere_no(c.arvp, novo_dado(v)));
+    for(int v = 0; v < 3000; v++) {
+        Dado chave = { v };
+        CONFERE(arv_pers_remove_no(c.arvp, &chave));
+    }
+    atomic_store(&c.terminou, true);
+    for(int i = 0; i < LEITORES; i++) pthread_join(leitores[i], NULL);
+
+    arv_pers_libera(c.arvp);
+    CONFERE(atomic_load(&liberados) == 3000);
+}
+
+int main(void) {
+    CONFERE(arv_pers_versao(NULL) == NULL);
+    testa_versoes();
+    testa_leitores();
+
+    printf("teste-persistente: ok\n");
+    return 0;
+}
@@ -0,0 +1,92 @@
+// arv_seleciona e arv_posto contra um vetor ordenado de referência, com
+// valores repetidos, depois de inserções, remoções, divisões e junções
+
+#include "comum.h"
+
+#define VALORES 300
+
+// confere seleciona e posto de todos os valores contra `contagem`
+static void confere_posto(Arvore *arv, const int *contagem) {
+    size_t k = 0;
+    for(int v = 0; v < VALORES; v++) {
+        // k é o número de dados menores que v
+        CONFERE(arv_posto(arv, &v) == k);
+        if(contagem[v] > 0) {
+            No *primeiro = arv_seleciona(arv, k);
+            CONFERE(*(int*)arv_busca_valor(primeiro) == v);
+            No *anterior = arv_iter_anterior(primeiro);
+            CONFERE(anterior == NULL || *(int*)arv_busca_valor(anterior) < v);
+        }
+        for(int c = 0; c < contagem[v]; c++) {
+            CONFERE(*(int*)arv_busca_valor(arv_seleciona(arv, k)) == v);
+            k++;
+        }
+    }
+    CONFERE(k == arv_nnos(arv));
+    CONFERE(arv_seleciona(arv, k) == NULL);
+    CONFERE(arv_seleciona(arv, k + 1000) == NULL);
+
+    int fora = -1;
+    CONFERE(arv_posto(arv, &fora) == 0);
+    fora = VALORES;
+    CONFERE(arv_posto(arv, &fora) == k);
+}
+
+// sem os tamanhos das sub-árvores, seleciona e posto percorrem a árvore
+static void testa_posto(bool pool, bool tamanhos) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_int, free, 16) : arv_cria(compara_int, free);
+    CONFERE(arv_define_tamanhos(arv, tamanhos));
+    static int contagem[VALORES];
+    memset(contagem, 0, sizeof(contagem));
+    confere_posto(arv, contagem);
+
+    for(int rodada = 0; rodada < 200; rodada++) {
+        for(int i = 0; i < 30; i++) {
+            int v = aleatorio_ate(VALORES);
+            if(aleatorio_ate(3) != 0) {
+                CONFERE(arv_insere_no(arv, novo_int(v)));
+                contagem[v]++;
+            }
+            else {
+                CONFERE(arv_remove_no(arv, &v) == (contagem[v] > 0));
+                if(contagem[v] > 0) contagem[v]--;
+            }
+        }
+        confere_arvore(arv);
+        confere_posto(arv, contagem);
+
+        // seleciona e posto continuam certos nas duas partes de uma
+        // divisão e na junção delas
+        if(rodada % 20 == 0) {
+            int chave = aleatorio_ate(VALORES);
+            Arvore *menores, *maiores;
+            CONFERE(arv_divide(arv, &chave, &menores, &maiores));
+            static int parte[VALORES];
+            memset(parte, 0, sizeof(parte));
+            memcpy(parte, contagem, chave * sizeof(int));
+            confere_arvore(menores);
+            confere_posto(menores, parte);
+            memset(parte, 0, sizeof(parte));
+            memcpy(parte + chave, contagem + chave, (VALORES - chave) * sizeof(int));
+            confere_arvore(maiores);
+            confere_posto(maiores, parte);
+
+            CONFERE(arv_junta(menores, maiores));
+            arv_libera_arvore(maiores);
+            arv_libera_arvore(arv);
+            arv = menores;
+            confere_posto(arv, contagem);
+        }
+    }
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    for(int pool = 0; pool < 2; pool++) {
+        testa_posto(pool, false);
+        testa_posto(pool, true);
+    }
+
+    printf("teste-posto: ok\n");
+    return 0;
+}
@@ -0,0 +1,145 @@
+// prefixo das chaves (arv_define_prefixo) com strings que empatam e que
+// não empatam nos primeiros 8 bytes, com e sem pool e junto com um
+// agregado: confere a árvore, o prefixo guardado em cada nó e as buscas
+// contra uma tabela de referência. inclui arvore-rn.c para ler o prefixo
+// guardado nos nós.
+
+#include "../arvore-rn.c"
+#include "comum.h"
+
+#define VALORES 600
+
+static int compara_str(void *dado1, void *dado2) {
+    return strcmp((char*)dado1, (char*)dado2);
+}
+
+// strings curtas, que terminam antes do fim do prefixo, e longas, que
+// só se diferenciam depois dos 8 primeiros bytes
+static void escreve_str(char *str, int v) {
+    if(v % 2 == 0) sprintf(str, "%d", v);
+    else sprintf(str, "abcdefgh%05d", v);
+}
+
+static char* nova_str(int v) {
+    char *str = (char*)malloc(16);
+    CONFERE(str != NULL);
+    escreve_str(str, v);
+    return str;
+}
+
+static void conta(void *acumulado, void *dado, void *contexto) {
+    (void)dado;
+    (void)contexto;
+    (*(size_t*)acumulado)++;
+}
+
+static void soma(void *acumulado, void *outro, void *contexto) {
+    (void)contexto;
+    *(size_t*)acumulado += *(size_t*)outro;
+}
+
+static void confere_prefixos(Arvore *arv, const bool *presente) {
+    confere_arvore(arv);
+    for(No *no = arv_iter_inicio(arv); no != NULL; no = arv_iter_proximo(no)) {
+        CONFERE(*arv_prefixo_no(arv, no) == arv_prefixo_str(arv_busca_valor(no)));
+    }
+
+    char str[16];
+    for(int v = 0; v < VALORES; v++) {
+        escreve_str(str, v);
+        No *no = arv_busca(arv, str);
+        CONFERE((no != NULL) == presente[v]);
+        if(no != NULL) CONFERE(strcmp((char*)arv_busca_valor(no), str) == 0);
+
+        // a busca por limite também usa o prefixo
+        No *teto = arv_teto(arv, str);
+        CONFERE(teto == NULL || strcmp((char*)arv_busca_valor(teto), str) >= 0);
+        No *anterior = teto == NULL ? arv_iter_fim(arv) : arv_iter_anterior(teto);
+        CONFERE(anterior == NULL || strcmp((char*)arv_busca_valor(anterior), str) < 0);
+    }
+}
+
+static void testa_prefixo(bool pool, bool agregado) {
+    Arvore *arv = pool ? arv_cria_com_pool(compara_str, free, 16) : arv_cria(compara_str, free);
+    CONFERE(arv_define_prefixo(arv, arv_prefixo_str));
+    CONFERE(arv_extrator_prefixo(arv) == arv_prefixo_str);
+    size_t zero = 0;
+    if(agregado) CONFERE(arv_define_agregado(arv, sizeof(size_t), &zero, conta, soma, NULL));
+
+    static bool presente[VALORES];
+    memset(presente, 0, sizeof(presente));
+    char str[16];
+    for(int i = 0; i < 6000; i++) {
+        int v = aleatorio_ate(VALORES);
+        if(presente[v]) {
+            escreve_str(str, v);
+            CONFERE(arv_remove_no(arv, str));
+        }
+        else {
+            CONFERE(arv_insere_no(arv, nova_str(v)));
+        }
+        presente[v] = !presente[v];
+        if(i % 500 == 0) confere_prefixos(arv, presente);
+    }
+    confere_prefixos(arv, presente);
+
+    // o agregado, guardado antes do prefixo, continua certo
+    if(agregado) {
+        size_t nos;
+        CONFERE(arv_agrega_intervalo(arv, NULL, NULL, &nos));
+        CONFERE(nos == arv_nnos(arv));
+    }
+
+    // a união com uma árvore sem prefixo copia os nós calculando o prefixo
+    Arvore *outra = arv_cria(compara_str, free);
+    for(int v = 0; v < VALORES; v++) {
+        if(aleatorio_ate(4) == 0) {
+            CONFERE(arv_insere_no(outra, nova_str(v)));
+            presente[v] = true;
+        }
+    }
+    CONFERE(arv_uniao(arv, outra));
+    confere_prefixos(arv, presente);
+    arv_libera_arvore(outra);
+
+    // com a árvore não vazia, o prefixo não pode mais mudar
+    CONFERE(!arv_define_prefixo(arv, NULL));
+    arv_libera_arvore(arv);
+}
+
+// árvores em que o prefixo não pode ser definido
+static void testa_recusas(void) {
+    typedef struct {
+        char str[16];
+        No no;
+    } Registro;
+    Arvore *intrusiva = arv_cria_intrusiva(compara_str, free, offsetof(Registro, no));
+    CONFERE(!arv_define_prefixo(intrusiva, arv_prefixo_str));
+    CONFERE(arv_define_prefixo(intrusiva, NULL));
+    arv_libera_arvore(intrusiva);
+
+    // o pool já alocou nós do tamanho antigo
+    Arvore *pool = arv_cria_com_pool(compara_str, free, 16);
+    char *str = nova_str(1);
+    CONFERE(arv_insere_no(pool, str));
+    CONFERE(arv_remove_no(pool, str));
+    CONFERE(!arv_define_prefixo(pool, arv_prefixo_str));
+    arv_libera_arvore(pool);
+
+    // o extrator para strings respeita a ordem do strcmp
+    const char *ordem[] = { "", "a", "a\x01", "ab", "abcdefgh", "abcdefghz", "b", "\xff" };
+    for(size_t i = 1; i < sizeof(ordem) / sizeof(ordem[0]); i++) {
+        CONFERE(arv_prefixo_str((void*)ordem[i - 1]) <= arv_prefixo_str((void*)ordem[i]));
+    }
+}
+
+int main(void) {
+    for(int pool = 0; pool < 2; pool++) {
+        testa_prefixo(pool, false);
+        testa_prefixo(pool, true);
+    }
+    testa_recusas();
+
+    printf("teste-prefixo: ok\n");
+    return 0;
+}
@@ -0,0 +1,109 @@
+// arv_remove_no_handle: remove nós guardados (inclusive um entre vários
+// repetidos, com 0, 1 ou 2 filhos) e confere que a árvore continua
+// válida, que os outros nós guardados continuam com os mesmos dados e que
+// o agregado dos ancestrais é atualizado, nos modos comum, com pool,
+// intrusivo (sem nada a atualizar até a raiz) e com só os tamanhos
+
+#include "comum.h"
+
+#define VALORES 100
+#define MAX_NOS 3000
+
+typedef struct {
+    int valor;
+    No no;
+} Registro;
+
+static void soma(void *acumulado, void *dado, void *contexto) {
+    (void)contexto;
+    *(long*)acumulado += *(int*)dado;
+}
+
+static void combina(void *acumulado, void *outro, void *contexto) {
+    (void)contexto;
+    *(long*)acumulado += *(long*)outro;
+}
+
+// acha o nó de `arv` que guarda exatamente o dado `dado`
+static No* acha_no(Arvore *arv, void *dado) {
+    ArvIntervalo it = arv_intervalo(arv, dado, dado);
+    for(No *no = it.inicio; no != it.fim; no = arv_iter_proximo(no)) {
+        if(arv_busca_valor(no) == dado) return no;
+    }
+    return NULL;
+}
+
+static void testa_handles(int modo) {
+    Arvore *arv;
+    if(modo == 1) arv = arv_cria_com_pool(compara_int, free, 16);
+    else if(modo == 2) arv = arv_cria_intrusiva(compara_int, free, offsetof(Registro, no));
+    else arv = arv_cria(compara_int, free);
+    if(modo == 3) CONFERE(arv_define_tamanhos(arv, true));
+    long zero = 0;
+    if(modo < 2) CONFERE(arv_define_agregado(arv, sizeof(long), &zero, soma, combina, NULL));
+
+    // nós guardados e os dados que eles devem continuar guardando
+    static No *nos[MAX_NOS];
+    static void *dados[MAX_NOS];
+    int n = 0;
+    long total = 0;
+
+    CONFERE(!arv_remove_no_handle(arv, NULL));
+
+    for(int rodada = 0; rodada < 40; rodada++) {
+        while(n < MAX_NOS / 2 + rodada * 30) {
+            int v = aleatorio_ate(VALORES);
+            void *dado;
+            if(modo == 2) {
+                Registro *registro = (Registro*)malloc(sizeof(Registro));
+                CONFERE(registro != NULL);
+                registro->valor = v;
+                dado = registro;
+            }
+            else {
+                dado = novo_int(v);
+            }
+            CONFERE(arv_insere_no(arv, dado));
+            dados[n] = dado;
+            nos[n] = modo == 2 ? &((Registro*)dado)->no : acha_no(arv, dado);
+            CONFERE(nos[n] != NULL);
+            total += v;
+            n++;
+        }
+
+        // remove nós sorteados, cada um pelo seu próprio ponteiro
+        for(int i = 0; i < 300; i++) {
+            int k = aleatorio_ate(n);
+            total -= *(int*)dados[k];
+            CONFERE(arv_remove_no_handle(arv, nos[k]));
+            nos[k] = nos[n - 1];
+            dados[k] = dados[n - 1];
+            n--;
+            if(i % 25 == 0) confere_arvore(arv);
+        }
+        confere_arvore(arv);
+        CONFERE(arv_nnos(arv) == (size_t)n);
+
+        // os nós que sobraram guardam os mesmos dados
+        for(int k = 0; k < n; k++) CONFERE(arv_busca_valor(nos[k]) == dados[k]);
+
+        if(modo < 2) {
+            long resultado;
+            CONFERE(arv_agrega_intervalo(arv, NULL, NULL, &resultado));
+            CONFERE(resultado == total);
+        }
+    }
+
+    // remove tudo pelos nós guardados
+    while(n > 0) CONFERE(arv_remove_no_handle(arv, nos[--n]));
+    confere_arvore(arv);
+    CONFERE(arv_vazia(arv));
+    arv_libera_arvore(arv);
+}
+
+int main(void) {
+    for(int modo = 0; modo < 4; modo++) testa_handles(modo);
+
+    printf("teste-remove-handle: ok\n");
+    return 0;
+}
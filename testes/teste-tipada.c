@@ -0,0 +1,150 @@
+// árvores geradas por ARV_DEFINE, com chave inteira e com chave struct,
+// conferindo cores, altura-preta, ponteiros para os pais e a ordem depois
+// de cada operação, e o conteúdo contra uma tabela de referência
+
+#include "comum.h"
+#include "../arvore-rn-tipada.h"
+
+#define VALORES 500
+
+#define COMPARA_INT(a, b) ARV_COMPARA_NUM(a, b)
+ARV_DEFINE(ArvInt, int, COMPARA_INT)
+
+typedef struct {
+    short maior;
+    short menor;
+} Par;
+
+#define COMPARA_PAR(a, b) ((a).maior != (b).maior ? ARV_COMPARA_NUM((a).maior, (b).maior) \
+                                                  : ARV_COMPARA_NUM((a).menor, (b).menor))
+ARV_DEFINE(ArvPar, Par, COMPARA_PAR)
+
+// gera um conferidor das invariantes para a árvore tipada `nome`
+#define DEFINE_CONFERE(nome, cmp)                                                      \
+static int nome##_confere_sub_arvore(nome##_no *no, nome##_no *pai, size_t *nos) {     \
+    if(no == NULL) return 1;                                                           \
+    CONFERE(no->pai == pai);                                                           \
+    if(no->cor == VERMELHO) {                                                          \
+        CONFERE(nome##_busca_cor(no->esq) == PRETO);                                   \
+        CONFERE(nome##_busca_cor(no->dir) == PRETO);                                   \
+    }                                                                                  \
+    if(no->esq != NULL) CONFERE(cmp(no->esq->chave, no->chave) <= 0);                  \
+    if(no->dir != NULL) CONFERE(cmp(no->dir->chave, no->chave) >= 0);                  \
+    int esq = nome##_confere_sub_arvore(no->esq, no, nos);                             \
+    int dir = nome##_confere_sub_arvore(no->dir, no, nos);                             \
+    CONFERE(esq == dir);                                                               \
+    (*nos)++;                                                                          \
+    return esq + (no->cor == PRETO);                                                   \
+}                                                                                      \
+                                                                                       \
+static void nome##_confere(nome *arv) {                                                \
+    CONFERE(nome##_busca_cor(arv->raiz) == PRETO);                                     \
+    if(arv->raiz != NULL) CONFERE(arv->raiz->pai == NULL);                             \
+    size_t nos = 0;                                                                    \
+    nome##_confere_sub_arvore(arv->raiz, NULL, &nos);                                  \
+    CONFERE(nos == nome##_nnos(arv));                                                  \
+    CONFERE(nome##_vazia(arv) == (nos == 0));                                          \
+    nome##_no *anterior = NULL;                                                        \
+    nos = 0;                                                                           \
+    for(nome##_no *no = nome##_iter_inicio(arv); no != NULL;                           \
+        no = nome##_iter_proximo(no)) {                                                \
+        if(anterior != NULL) CONFERE(cmp(anterior->chave, no->chave) <= 0);            \
+        anterior = no;                                                                 \
+        nos++;                                                                         \
+    }                                                                                  \
+    CONFERE(nos == nome##_nnos(arv));                                                  \
+}
+
+DEFINE_CONFERE(ArvInt, COMPARA_INT)
+DEFINE_CONFERE(ArvPar, COMPARA_PAR)
+
+static Par par_de(int v) {
+    Par par = { (short)(v / 23 - 10), (short)(v % 23 - 11) };
+    return par;
+}
+
+static void testa_int(void) {
+    ArvInt *arv = ArvInt_cria();
+    static int contagem[VALORES];
+    memset(contagem, 0, sizeof(contagem));
+
+    for(int i = 0; i < 20000; i++) {
+        int v = aleatorio_ate(VALORES);
+        if(aleatorio_ate(2) == 0) {
+            CONFERE(ArvInt_insere_no(arv, v));
+            contagem[v]++;
+        }
+        else {
+            CONFERE(ArvInt_remove_no(arv, v) == (contagem[v] > 0));
+            if(contagem[v] > 0) contagem[v]--;
+        }
+        if(i % 50 == 0) ArvInt_confere(arv);
+        CONFERE(ArvInt_contem(arv, v) == (contagem[v] > 0));
+        ArvInt_no *no = ArvInt_busca_no(arv, v);
+        if(no != NULL) CONFERE(*ArvInt_busca_valor(no) == v);
+    }
+    ArvInt_confere(arv);
+
+    // a iteração passa por cada valor tantas vezes quanto foi inserido
+    ArvInt_no *no = ArvInt_iter_inicio(arv);
+    for(int v = 0; v < VALORES; v++) {
+        for(int c = 0; c < contagem[v]; c++) {
+            CONFERE(no != NULL && *ArvInt_busca_valor(no) == v);
+            no = ArvInt_iter_proximo(no);
+        }
+    }
+    CONFERE(no == NULL);
+
+    // esvazia a árvore
+    for(int v = 0; v < VALORES; v++) {
+        while(contagem[v] > 0) {
+            CONFERE(ArvInt_remove_no(arv, v));
+            contagem[v]--;
+        }
+    }
+    ArvInt_confere(arv);
+    CONFERE(ArvInt_vazia(arv));
+    CONFERE(ArvInt_iter_inicio(arv) == NULL);
+    ArvInt_libera_arvore(arv);
+}
+
+static void testa_par(void) {
+    ArvPar *arv = ArvPar_cria();
+    static bool presente[VALORES];
+    memset(presente, 0, sizeof(presente));
+
+    for(int i = 0; i < 20000; i++) {
+        int v = aleatorio_ate(VALORES);
+        if(!presente[v]) {
+            CONFERE(ArvPar_insere_no(arv, par_de(v)));
+        }
+        else {
+            CONFERE(ArvPar_remove_no(arv, par_de(v)));
+        }
+        presente[v] = !presente[v];
+        if(i % 50 == 0) ArvPar_confere(arv);
+    }
+    ArvPar_confere(arv);
+
+    // par_de preserva a ordem, então a iteração segue a ordem dos valores
+    ArvPar_no *no = ArvPar_iter_inicio(arv);
+    for(int v = 0; v < VALORES; v++) {
+        CONFERE(ArvPar_contem(arv, par_de(v)) == presente[v]);
+        if(!presente[v]) continue;
+        Par *par = ArvPar_busca_valor(no);
+        CONFERE(par != NULL && COMPARA_PAR(*par, par_de(v)) == 0);
+        no = ArvPar_iter_proximo(no);
+    }
+    CONFERE(no == NULL);
+
+    // a liberação sem recursão solta todos os nós (conferido pelo ASan)
+    ArvPar_libera_arvore(arv);
+}
+
+int main(void) {
+    testa_int();
+    testa_par();
+
+    printf("teste-tipada: ok\n");
+    return 0;
+}